@@ -0,0 +1,71 @@
+# Build type, target architecture, LTO and PGO settings shared by robot_common and spa, whether
+# they are configured from the top-level project or on their own.
+include_guard(GLOBAL)
+
+if(NOT CMAKE_BUILD_TYPE AND NOT CMAKE_CONFIGURATION_TYPES)
+  set(CMAKE_BUILD_TYPE Release CACHE STRING "Build type" FORCE)
+endif()
+# Profile is Release code with symbols and frame pointers, so sampling profilers such as perf
+# see whole call stacks. project() caches empty flags for an unknown build type, hence FORCE.
+if(NOT CMAKE_CXX_FLAGS_PROFILE)
+  set(CMAKE_CXX_FLAGS_PROFILE "-O2 -g -DNDEBUG -fno-omit-frame-pointer" CACHE STRING
+      "Flags used by the C++ compiler during Profile builds" FORCE)
+endif()
+set_property(CACHE CMAKE_BUILD_TYPE PROPERTY STRINGS Debug Release RelWithDebInfo Profile)
+
+# Applied by robot_common as a public compile option: Eigen's fixed-size types change alignment
+# with the instruction set, so everything linking robot_common must be built for the same one.
+set(ROBOT_ARCH "" CACHE STRING
+    "Target passed to -march, e.g. native or x86-64-v3; empty keeps the compiler default")
+
+option(ROBOT_ENABLE_LTO "Build with link-time optimization" OFF)
+if(ROBOT_ENABLE_LTO)
+  include(CheckIPOSupported)
+  check_ipo_supported(RESULT ROBOT_LTO_SUPPORTED OUTPUT ROBOT_LTO_ERROR LANGUAGES CXX)
+  if(ROBOT_LTO_SUPPORTED)
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+  else()
+    message(WARNING "Link-time optimization is not supported: ${ROBOT_LTO_ERROR}")
+  endif()
+endif()
+
+# Profile-guided optimization in two configures of the same build directory, which keeps the
+# object paths that GCC names its profiles after:
+#   cmake --preset pgo-generate && cmake --build --preset pgo-generate --target pgo_profile
+#   cmake --preset pgo-use && cmake --build --preset pgo-use
+# pgo_profile runs the benchmark suites on the instrumented build. Delete ROBOT_PGO_DIR before
+# profiling again after code changes.
+set(ROBOT_PGO OFF CACHE STRING "Profile-guided optimization stage: OFF, GENERATE or USE")
+set_property(CACHE ROBOT_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(ROBOT_PGO_DIR ${CMAKE_BINARY_DIR}/pgo_profiles CACHE PATH
+    "Directory that GENERATE builds write profiles to and USE builds read them from")
+if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+  # Clang's raw per-process profiles are merged into one file for the USE build.
+  set(ROBOT_PGO_USE_PATH ${ROBOT_PGO_DIR}/merged.profdata)
+else()
+  set(ROBOT_PGO_USE_PATH ${ROBOT_PGO_DIR})
+endif()
+if(ROBOT_PGO STREQUAL "GENERATE")
+  if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    # The benchmarks run multithreaded code; plain counter updates would race.
+    add_compile_options(-fprofile-generate=${ROBOT_PGO_DIR} -fprofile-update=atomic)
+  else()
+    add_compile_options(-fprofile-generate=${ROBOT_PGO_DIR})
+  endif()
+  add_link_options(-fprofile-generate=${ROBOT_PGO_DIR})
+elseif(ROBOT_PGO STREQUAL "USE")
+  if(NOT EXISTS ${ROBOT_PGO_USE_PATH})
+    message(FATAL_ERROR "No profiles at ${ROBOT_PGO_USE_PATH}; build pgo_profile with "
+                        "ROBOT_PGO=GENERATE first")
+  endif()
+  if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    # Code the benchmarks never reach is optimized as usual rather than for size.
+    add_compile_options(-fprofile-use=${ROBOT_PGO_USE_PATH} -fprofile-partial-training
+                        -fprofile-correction -Wno-missing-profile)
+  else()
+    add_compile_options(-fprofile-use=${ROBOT_PGO_USE_PATH})
+  endif()
+  add_link_options(-fprofile-use=${ROBOT_PGO_USE_PATH})
+elseif(ROBOT_PGO)
+  message(FATAL_ERROR "ROBOT_PGO must be OFF, GENERATE or USE, not ${ROBOT_PGO}")
+endif()
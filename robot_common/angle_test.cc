@@ -0,0 +1,67 @@
+#include "angle.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using robot::common::NormalizeAngle;
+using robot::common::NormalizeAngles;
+
+namespace {
+
+template <typename T>
+class AngleTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(AngleTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(AngleTest, WrapsIntoHalfOpenRange) {
+  using T = TypeParam;
+  const T pi = T(M_PI);
+  const T eps = std::numeric_limits<T>::epsilon();
+  // pi itself maps to -pi; -pi stays.
+  EXPECT_EQ(NormalizeAngle(pi), -pi);
+  EXPECT_EQ(NormalizeAngle(-pi), -pi);
+  EXPECT_EQ(NormalizeAngle(T(0)), T(0));
+  // Just inside the range, angles are unchanged, even where (angle + pi) / (2 pi) rounds to 1.
+  const T below_pi = std::nextafter(pi, T(0));
+  const T above_minus_pi = std::nextafter(-pi, T(0));
+  EXPECT_EQ(NormalizeAngle(below_pi), below_pi);
+  EXPECT_EQ(NormalizeAngle(above_minus_pi), above_minus_pi);
+  // Just outside, they wrap to the other end.
+  EXPECT_NEAR(NormalizeAngle(pi + 4 * eps), -pi + 4 * eps, 8 * eps);
+  EXPECT_NEAR(NormalizeAngle(-pi - 4 * eps), pi - 4 * eps, 8 * eps);
+  EXPECT_NEAR(NormalizeAngle(T(3) * pi / T(2)), -pi / T(2), 8 * eps);
+  EXPECT_NEAR(NormalizeAngle(T(-7.5) * pi), pi / T(2), 32 * eps);
+  EXPECT_NEAR(NormalizeAngle(T(100)), T(100 - 32 * M_PI), 256 * eps);
+}
+
+TYPED_TEST(AngleTest, BatchMatchesScalar) {
+  using T = TypeParam;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> uniform(-1000., 1000.);
+  const T pi = T(M_PI);
+  std::vector<T> angles = {pi,
+                           -pi,
+                           T(0),
+                           T(3 * M_PI),
+                           T(-3 * M_PI),
+                           std::nextafter(pi, T(0)),
+                           std::nextafter(-pi, T(0)),
+                           std::nextafter(T(3 * M_PI), T(0))};
+  for (int i = 0; i < 1000; ++i) angles.push_back(T(uniform(rng)));
+  std::vector<T> out(angles.size());
+  NormalizeAngles(angles.data(), angles.size(), out.data());
+  for (size_t i = 0; i < angles.size(); ++i) {
+    EXPECT_EQ(out[i], NormalizeAngle(angles[i])) << angles[i];
+    EXPECT_GE(out[i], -pi);
+    EXPECT_LT(out[i], pi);
+  }
+  // In place.
+  NormalizeAngles(angles.data(), angles.size(), angles.data());
+  EXPECT_EQ(angles, out);
+}
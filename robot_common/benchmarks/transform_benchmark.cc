@@ -0,0 +1,400 @@
+#include <benchmark/benchmark.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "euler_batch.h"
+#include "point_cloud.h"
+#include "pose_array.h"
+#include "pose_buffer.h"
+#include "se3_chain.h"
+#include "thread_pool.h"
+#include "transform.h"
+
+namespace {
+
+using robot::common::SE3Array;
+using robot::common::SE3d;
+
+std::vector<SE3d> RandomPoses(size_t size, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  std::vector<SE3d> poses;
+  poses.reserve(size);
+  for (size_t i = 0; i < size; ++i) {
+    const SE3d::Translation translation(uniform(rng), uniform(rng), uniform(rng));
+    const SE3d::Rotation rotation = SE3d::Rotation(Eigen::Vector4d(
+        uniform(rng), uniform(rng), uniform(rng), uniform(rng)).normalized());
+    poses.emplace_back(translation, rotation);
+  }
+  return poses;
+}
+
+SE3Array<double> ToArray(const std::vector<SE3d>& poses) {
+  SE3Array<double> array;
+  array.reserve(poses.size());
+  for (const SE3d& pose : poses) array.push_back(pose);
+  return array;
+}
+
+template <typename Pose>
+std::vector<Pose> RandomPosesOf(size_t size, unsigned seed);
+
+template <>
+std::vector<SE3d> RandomPosesOf<SE3d>(size_t size, unsigned seed) {
+  return RandomPoses(size, seed);
+}
+
+template <>
+std::vector<robot::common::SE3f> RandomPosesOf<robot::common::SE3f>(size_t size,
+                                                                   unsigned seed) {
+  std::vector<robot::common::SE3f> poses;
+  for (const SE3d& pose : RandomPoses(size, seed)) poses.push_back(pose.cast<float>());
+  return poses;
+}
+
+template <>
+std::vector<robot::common::SE2d> RandomPosesOf<robot::common::SE2d>(size_t size,
+                                                                   unsigned seed) {
+  std::vector<robot::common::SE2d> poses;
+  for (const SE3d& pose : RandomPoses(size, seed)) poses.push_back(pose.ToSE2());
+  return poses;
+}
+
+template <>
+std::vector<robot::common::SE2f> RandomPosesOf<robot::common::SE2f>(size_t size,
+                                                                   unsigned seed) {
+  std::vector<robot::common::SE2f> poses;
+  for (const SE3d& pose : RandomPoses(size, seed)) poses.push_back(pose.ToSE2().cast<float>());
+  return poses;
+}
+
+// Per-operation costs over 1024 poses, so the loop overhead and cache misses stay small.
+constexpr size_t kNumPoses = 1024;
+
+template <typename Pose>
+void BM_Compose(benchmark::State& state) {
+  const std::vector<Pose> lhs = RandomPosesOf<Pose>(kNumPoses, 1);
+  const std::vector<Pose> rhs = RandomPosesOf<Pose>(kNumPoses, 2);
+  std::vector<Pose> out(kNumPoses);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kNumPoses; ++i) out[i] = lhs[i] * rhs[i];
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPoses);
+}
+BENCHMARK_TEMPLATE(BM_Compose, robot::common::SE3d);
+BENCHMARK_TEMPLATE(BM_Compose, robot::common::SE3f);
+BENCHMARK_TEMPLATE(BM_Compose, robot::common::SE2d);
+BENCHMARK_TEMPLATE(BM_Compose, robot::common::SE2f);
+
+template <typename Pose>
+void BM_Inverse(benchmark::State& state) {
+  const std::vector<Pose> poses = RandomPosesOf<Pose>(kNumPoses, 1);
+  std::vector<Pose> out(kNumPoses);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kNumPoses; ++i) out[i] = poses[i].inverse();
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPoses);
+}
+BENCHMARK_TEMPLATE(BM_Inverse, robot::common::SE3d);
+BENCHMARK_TEMPLATE(BM_Inverse, robot::common::SE3f);
+BENCHMARK_TEMPLATE(BM_Inverse, robot::common::SE2d);
+BENCHMARK_TEMPLATE(BM_Inverse, robot::common::SE2f);
+
+// Casts double poses to Target.
+template <typename Target, typename Source>
+void BM_Cast(benchmark::State& state) {
+  const std::vector<Source> poses = RandomPosesOf<Source>(kNumPoses, 1);
+  std::vector<Target> out(kNumPoses);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kNumPoses; ++i) {
+      out[i] = poses[i].template cast<typename Target::Scalar>();
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPoses);
+}
+BENCHMARK_TEMPLATE(BM_Cast, robot::common::SE3f, robot::common::SE3d);
+BENCHMARK_TEMPLATE(BM_Cast, robot::common::SE2f, robot::common::SE2d);
+
+template <typename Pose>
+void BM_ExpLog(benchmark::State& state) {
+  const std::vector<Pose> poses = RandomPosesOf<Pose>(kNumPoses, 1);
+  std::vector<Pose> out(kNumPoses);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kNumPoses; ++i) out[i] = Pose::Exp(poses[i].Log());
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumPoses);
+}
+BENCHMARK_TEMPLATE(BM_ExpLog, robot::common::SE3d);
+BENCHMARK_TEMPLATE(BM_ExpLog, robot::common::SE2d);
+
+void BM_ComposeScalarLoop(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const std::vector<SE3d> lhs = RandomPoses(size, 1);
+  const std::vector<SE3d> rhs = RandomPoses(size, 2);
+  std::vector<SE3d> out(size);
+  for (auto _ : state) {
+    for (size_t i = 0; i < size; ++i) out[i] = lhs[i] * rhs[i];
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_ComposeScalarLoop)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+void BM_ComposeBatchSoA(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const SE3Array<double> lhs = ToArray(RandomPoses(size, 1));
+  const SE3Array<double> rhs = ToArray(RandomPoses(size, 2));
+  SE3Array<double> out(size);
+  for (auto _ : state) {
+    robot::common::ComposeBatch(lhs, rhs, &out);
+    benchmark::DoNotOptimize(out.tx());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_ComposeBatchSoA)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+void BM_TransformPointsScalarLoop(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const SE3d pose = RandomPoses(1, 3).front();
+  const Eigen::Matrix3Xd points = Eigen::Matrix3Xd::Random(3, size);
+  Eigen::Matrix3Xd out(3, size);
+  for (auto _ : state) {
+    for (size_t i = 0; i < size; ++i) {
+      out.col(i) = pose.translation() + pose.rotation() * points.col(i);
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_TransformPointsScalarLoop)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+void BM_TransformPoints(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const SE3d pose = RandomPoses(1, 3).front();
+  const Eigen::Matrix3Xd points = Eigen::Matrix3Xd::Random(3, size);
+  Eigen::Matrix3Xd out(3, size);
+  for (auto _ : state) {
+    out = robot::common::TransformPoints(pose, points);
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_TransformPoints)->RangeMultiplier(8)->Range(1 << 10, 1 << 20);
+
+std::vector<Eigen::Quaterniond> RandomQuaternions(size_t size) {
+  std::vector<Eigen::Quaterniond> quats;
+  quats.reserve(size);
+  for (const SE3d& pose : RandomPoses(size, 4)) quats.push_back(pose.rotation());
+  return quats;
+}
+
+void BM_GetYawScalarLoop(benchmark::State& state) {
+  const std::vector<Eigen::Quaterniond> quats = RandomQuaternions(state.range(0));
+  std::vector<double> yaws(quats.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < quats.size(); ++i) yaws[i] = robot::common::GetYaw(quats[i]);
+    benchmark::DoNotOptimize(yaws.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * quats.size());
+}
+BENCHMARK(BM_GetYawScalarLoop)->Arg(50000);
+
+void BM_EulerFromQuaternionScalarLoop(benchmark::State& state) {
+  const std::vector<Eigen::Quaterniond> quats = RandomQuaternions(state.range(0));
+  Eigen::Matrix3Xd euler(3, quats.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < quats.size(); ++i) {
+      euler.col(i) = robot::common::EulerFromQuaternion(quats[i]);
+    }
+    benchmark::DoNotOptimize(euler.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * quats.size());
+}
+BENCHMARK(BM_EulerFromQuaternionScalarLoop)->Arg(50000);
+
+void BM_GetYawBatch(benchmark::State& state) {
+  const std::vector<Eigen::Quaterniond> quats = RandomQuaternions(state.range(0));
+  const auto accuracy = static_cast<robot::common::AngleAccuracy>(state.range(1));
+  std::vector<double> yaws(quats.size());
+  for (auto _ : state) {
+    robot::common::GetYawBatch(quats.data(), quats.size(), yaws.data(), accuracy);
+    benchmark::DoNotOptimize(yaws.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * quats.size());
+}
+BENCHMARK(BM_GetYawBatch)
+    ->Args({50000, static_cast<int>(robot::common::AngleAccuracy::kExact)})
+    ->Args({50000, static_cast<int>(robot::common::AngleAccuracy::kFast)});
+
+void BM_EulerFromQuaternionBatch(benchmark::State& state) {
+  const std::vector<Eigen::Quaterniond> quats = RandomQuaternions(state.range(0));
+  const auto accuracy = static_cast<robot::common::AngleAccuracy>(state.range(1));
+  Eigen::Matrix3Xd euler;
+  for (auto _ : state) {
+    robot::common::EulerFromQuaternionBatch(quats.data(), quats.size(), &euler, accuracy);
+    benchmark::DoNotOptimize(euler.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * quats.size());
+}
+BENCHMARK(BM_EulerFromQuaternionBatch)
+    ->Args({50000, static_cast<int>(robot::common::AngleAccuracy::kExact)})
+    ->Args({50000, static_cast<int>(robot::common::AngleAccuracy::kFast)});
+
+constexpr size_t kChainLength = 20;
+
+template <size_t... I>
+SE3d ComposeEager(const std::vector<SE3d>& links, std::index_sequence<I...>) {
+  return (links[I] * ...);
+}
+
+template <size_t... I>
+auto ComposeLazy(const std::vector<SE3d>& links, std::index_sequence<I...>) {
+  return (robot::common::Chain(links[0]) * ... * links[I + 1]);
+}
+
+void BM_ChainComposeEager(benchmark::State& state) {
+  const std::vector<SE3d> links = RandomPoses(kChainLength, 5);
+  for (auto _ : state) {
+    SE3d pose = ComposeEager(links, std::make_index_sequence<kChainLength>());
+    benchmark::DoNotOptimize(pose);
+  }
+}
+BENCHMARK(BM_ChainComposeEager);
+
+void BM_ChainComposeLazy(benchmark::State& state) {
+  const std::vector<SE3d> links = RandomPoses(kChainLength, 5);
+  for (auto _ : state) {
+    SE3d pose = ComposeLazy(links, std::make_index_sequence<kChainLength - 1>()).Evaluate();
+    benchmark::DoNotOptimize(pose);
+  }
+}
+BENCHMARK(BM_ChainComposeLazy);
+
+void BM_ChainApplyEager(benchmark::State& state) {
+  const std::vector<SE3d> links = RandomPoses(kChainLength, 5);
+  const Eigen::Vector3d point(0.1, 0.2, 0.3);
+  for (auto _ : state) {
+    const SE3d pose = ComposeEager(links, std::make_index_sequence<kChainLength>());
+    Eigen::Vector3d result = pose.translation() + pose.rotation() * point;
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_ChainApplyEager);
+
+void BM_ChainApplyLazy(benchmark::State& state) {
+  const std::vector<SE3d> links = RandomPoses(kChainLength, 5);
+  const Eigen::Vector3d point(0.1, 0.2, 0.3);
+  for (auto _ : state) {
+    Eigen::Vector3d result =
+        ComposeLazy(links, std::make_index_sequence<kChainLength - 1>()) * point;
+    benchmark::DoNotOptimize(result);
+  }
+}
+BENCHMARK(BM_ChainApplyLazy);
+
+// Transforms a cloud of range(0) points, as a 3xN matrix or, if range(1), SoA, on range(2)
+// threads.
+void BM_TransformCloud(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const SE3d pose = RandomPoses(1, 3).front();
+  const Eigen::Matrix3Xd points = Eigen::Matrix3Xd::Random(3, size);
+  robot::common::PointArray<double> soa_points;
+  for (size_t i = 0; i < size; ++i) soa_points.push_back(points.col(i));
+  robot::common::ThreadPool thread_pool(std::max<int>(1, state.range(2) - 1));
+  robot::common::TransformCloudOptions options;
+  if (state.range(2) > 1) options.thread_pool = &thread_pool;
+  Eigen::Matrix3Xd out;
+  robot::common::PointArray<double> soa_out;
+  for (auto _ : state) {
+    if (state.range(1)) {
+      robot::common::TransformCloud(pose, soa_points, &soa_out, options);
+      benchmark::DoNotOptimize(soa_out.x());
+    } else {
+      robot::common::TransformCloud(pose, points, &out, options);
+      benchmark::DoNotOptimize(out.data());
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_TransformCloud)
+    ->ArgNames({"points", "soa", "threads"})
+    ->ArgsProduct({{100000, 1000000}, {0, 1}, {1, 4}})
+    ->UseRealTime();
+
+// Deskews range(0) SoA points against 200 poses, one per point in capture order, on range(1)
+// threads.
+void BM_DeskewCloud(benchmark::State& state) {
+  const size_t size = state.range(0);
+  const std::vector<SE3d> poses = RandomPoses(200, 8);
+  std::vector<uint32_t> pose_indices(size);
+  for (size_t i = 0; i < size; ++i) pose_indices[i] = i * poses.size() / size;
+  const Eigen::Matrix3Xd points = Eigen::Matrix3Xd::Random(3, size);
+  robot::common::PointArray<double> soa_points;
+  for (size_t i = 0; i < size; ++i) soa_points.push_back(points.col(i));
+  robot::common::ThreadPool thread_pool(std::max<int>(1, state.range(1) - 1));
+  robot::common::TransformCloudOptions options;
+  if (state.range(1) > 1) options.thread_pool = &thread_pool;
+  robot::common::PointArray<double> out;
+  for (auto _ : state) {
+    robot::common::TransformCloud(poses, pose_indices, soa_points, &out, options);
+    benchmark::DoNotOptimize(out.x());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_DeskewCloud)
+    ->ArgNames({"points", "threads"})
+    ->ArgsProduct({{1000000}, {1, 4}})
+    ->UseRealTime();
+
+// A 1000-pose buffer sampled at 100 Hz, queried at random times if range(0), else within the
+// newest interval, with interpolation range(1).
+void BM_PoseBufferLookup(benchmark::State& state) {
+  constexpr size_t kSize = 1000;
+  const std::vector<SE3d> poses = RandomPoses(kSize, 6);
+  const auto interpolation = static_cast<robot::common::RotationInterpolation>(state.range(1));
+  robot::common::PoseBuffer<SE3d> buffer(kSize, interpolation);
+  for (size_t i = 0; i < kSize; ++i) buffer.Push(0.01 * i, poses[i]);
+  std::mt19937 rng(7);
+  const double begin = state.range(0) ? 0. : 0.01 * (kSize - 2);
+  std::uniform_real_distribution<double> uniform(begin, 0.01 * (kSize - 1));
+  std::vector<double> times(1024);
+  for (double& time : times) time = uniform(rng);
+  size_t i = 0;
+  for (auto _ : state) {
+    SE3d pose;
+    buffer.Lookup(times[i++ % times.size()], &pose);
+    benchmark::DoNotOptimize(pose);
+  }
+}
+BENCHMARK(BM_PoseBufferLookup)
+    ->ArgNames({"random", "interpolation"})
+    ->ArgsProduct({{0, 1},
+                   {static_cast<int>(robot::common::RotationInterpolation::kSlerp),
+                    static_cast<int>(robot::common::RotationInterpolation::kNlerp)}});
+
+}  // namespace
+
+BENCHMARK_MAIN();
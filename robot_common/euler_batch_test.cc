@@ -0,0 +1,103 @@
+#include "euler_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "transform.h"
+
+using robot::common::AngleAccuracy;
+using robot::common::EulerFromQuaternionBatch;
+using robot::common::GetYawBatch;
+using robot::common::SE3;
+using robot::common::SE3Array;
+
+namespace {
+
+// More than one chunk of the array-of-structures entry points, and not a multiple of it.
+constexpr size_t kNumQuaternions = 1003;
+
+template <typename T>
+std::vector<Eigen::Quaternion<T>> RandomQuaternions() {
+  std::mt19937 rng(1);
+  std::normal_distribution<double> normal;
+  std::vector<Eigen::Quaternion<T>> quats;
+  for (size_t i = 0; i < kNumQuaternions; ++i) {
+    const Eigen::Vector4d coeffs(normal(rng), normal(rng), normal(rng), normal(rng));
+    quats.push_back(Eigen::Quaterniond(coeffs.normalized()).cast<T>());
+  }
+  return quats;
+}
+
+// The batch code may contract multiply-adds differently from the scalar code it is compared to.
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 1e-5 : 1e-12;
+}
+
+template <typename T>
+class EulerBatchTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(EulerBatchTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(EulerBatchTest, ExactMatchesScalar) {
+  using T = TypeParam;
+  const std::vector<Eigen::Quaternion<T>> quats = RandomQuaternions<T>();
+  std::vector<T> yaws(quats.size());
+  GetYawBatch(quats.data(), quats.size(), yaws.data(), AngleAccuracy::kExact);
+  Eigen::Matrix<T, 3, Eigen::Dynamic> euler;
+  EulerFromQuaternionBatch(quats.data(), quats.size(), &euler, AngleAccuracy::kExact);
+  ASSERT_EQ(euler.cols(), static_cast<Eigen::Index>(quats.size()));
+  for (size_t i = 0; i < quats.size(); ++i) {
+    const Eigen::Matrix<T, 3, 1> expected = robot::common::EulerFromQuaternion(quats[i]);
+    EXPECT_NEAR(yaws[i], robot::common::GetYaw(quats[i]), Tolerance<T>());
+    for (int k = 0; k < 3; ++k) EXPECT_NEAR(euler(k, i), expected(k), Tolerance<T>()) << i;
+  }
+}
+
+// FastAtan2 is within 1.2e-5 rad of atan2 and FastAsin closer still to asin.
+TYPED_TEST(EulerBatchTest, FastWithinBoundOfScalar) {
+  using T = TypeParam;
+  const double tolerance = 1.2e-5 + Tolerance<T>();
+  const std::vector<Eigen::Quaternion<T>> quats = RandomQuaternions<T>();
+  std::vector<T> yaws(quats.size());
+  GetYawBatch(quats.data(), quats.size(), yaws.data(), AngleAccuracy::kFast);
+  Eigen::Matrix<T, 3, Eigen::Dynamic> euler;
+  EulerFromQuaternionBatch(quats.data(), quats.size(), &euler, AngleAccuracy::kFast);
+  for (size_t i = 0; i < quats.size(); ++i) {
+    const Eigen::Matrix<T, 3, 1> expected = robot::common::EulerFromQuaternion(quats[i]);
+    EXPECT_NEAR(yaws[i], expected.z(), tolerance);
+    for (int k = 0; k < 3; ++k) EXPECT_NEAR(euler(k, i), expected(k), tolerance) << i;
+  }
+
+  // The pose-array overload reads the same kernel from separate component buffers.
+  SE3Array<T> poses;
+  for (const Eigen::Quaternion<T>& quat : quats) {
+    poses.push_back(SE3<T>(Eigen::Matrix<T, 3, 1>::Zero(), quat));
+  }
+  std::vector<T> pose_yaws(quats.size());
+  GetYawBatch(poses, pose_yaws.data(), AngleAccuracy::kFast);
+  EXPECT_EQ(pose_yaws, yaws);
+}
+
+// Quaternions off unit length by rounding can put the asin argument past +/-1 at gimbal lock;
+// pitch saturates at +/-pi/2 there.
+TYPED_TEST(EulerBatchTest, PitchSaturatesAtGimbalLock) {
+  using T = TypeParam;
+  const T c = T(std::sqrt(0.5)) * (T(1) + 4 * std::numeric_limits<T>::epsilon());
+  const std::vector<Eigen::Quaternion<T>> quats = {Eigen::Quaternion<T>(c, T(0), c, T(0)),
+                                                    Eigen::Quaternion<T>(c, T(0), -c, T(0))};
+  const T expected[] = {T(M_PI / 2), T(-M_PI / 2)};
+  for (AngleAccuracy accuracy : {AngleAccuracy::kExact, AngleAccuracy::kFast}) {
+    Eigen::Matrix<T, 3, Eigen::Dynamic> euler;
+    EulerFromQuaternionBatch(quats.data(), quats.size(), &euler, accuracy);
+    for (size_t i = 0; i < quats.size(); ++i) EXPECT_NEAR(euler(1, i), expected[i], 1e-6) << i;
+  }
+}
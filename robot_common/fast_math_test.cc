@@ -0,0 +1,97 @@
+#include "fast_math.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+using robot::common::BranchFreeAtan2;
+using robot::common::BranchFreeSinCos;
+using robot::common::FastAsin;
+using robot::common::FastAtan2;
+
+namespace {
+
+// The documented maximum errors, checked against double-precision libm on the rounded inputs.
+template <typename T>
+struct Bounds;
+
+template <>
+struct Bounds<float> {
+  static constexpr double kFastAtan2 = 1.2e-5;
+  static constexpr double kFastAsin = 3.0e-7;
+  static constexpr double kAtan2 = 2.7e-7;
+  static constexpr double kSinCos = 1.0e-7;
+};
+
+template <>
+struct Bounds<double> {
+  static constexpr double kFastAtan2 = 1.2e-5;
+  static constexpr double kFastAsin = 2.2e-8;
+  static constexpr double kAtan2 = 4.5e-16;
+  static constexpr double kSinCos = 2.3e-16;
+};
+
+// Maximum error of `atan2` over points on circles of several radii, so every octant and both
+// axes are covered.
+template <typename T, typename Atan2>
+double MaxAtan2Error(Atan2 atan2) {
+  double max_error = 0.;
+  for (int i = 0; i <= 100000; ++i) {
+    const double angle = -M_PI + 2. * M_PI * i / 100000.;
+    for (double radius : {1e-3, 1., 7., 1e3}) {
+      const T y = T(radius * std::sin(angle));
+      const T x = T(radius * std::cos(angle));
+      const double error = std::abs(double(atan2(y, x)) - std::atan2(double(y), double(x)));
+      max_error = std::max(max_error, error);
+    }
+  }
+  return max_error;
+}
+
+template <typename T>
+class FastMathTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(FastMathTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(FastMathTest, FastAtan2WithinBound) {
+  using T = TypeParam;
+  EXPECT_LE(MaxAtan2Error<T>([](T y, T x) { return FastAtan2(y, x); }), Bounds<T>::kFastAtan2);
+  EXPECT_EQ(FastAtan2(T(0), T(0)), T(0));
+  EXPECT_NEAR(FastAtan2(T(0), T(-1)), M_PI, Bounds<T>::kFastAtan2);
+  EXPECT_NEAR(FastAtan2(T(-1), T(0)), -M_PI / 2, Bounds<T>::kFastAtan2);
+}
+
+TYPED_TEST(FastMathTest, FastAsinWithinBound) {
+  using T = TypeParam;
+  double max_error = 0.;
+  for (int i = 0; i <= 1000000; ++i) {
+    const T x = T(-1. + 2. * i / 1000000.);
+    max_error = std::max(max_error, std::abs(double(FastAsin(x)) - std::asin(double(x))));
+  }
+  EXPECT_LE(max_error, Bounds<T>::kFastAsin);
+  // Outside [-1, 1] the result saturates.
+  EXPECT_NEAR(FastAsin(T(1.5)), M_PI / 2, Bounds<T>::kFastAsin);
+  EXPECT_NEAR(FastAsin(T(-1.5)), -M_PI / 2, Bounds<T>::kFastAsin);
+}
+
+TYPED_TEST(FastMathTest, BranchFreeAtan2WithinBound) {
+  using T = TypeParam;
+  EXPECT_LE(MaxAtan2Error<T>([](T y, T x) { return BranchFreeAtan2(y, x); }), Bounds<T>::kAtan2);
+  EXPECT_EQ(BranchFreeAtan2(T(0), T(0)), T(0));
+}
+
+TYPED_TEST(FastMathTest, BranchFreeSinCosWithinBound) {
+  using T = TypeParam;
+  double max_error = 0.;
+  for (int i = 0; i <= 1000000; ++i) {
+    const T x = T(-1000. + 2000. * i / 1000000.);
+    T sin_x, cos_x;
+    BranchFreeSinCos(x, &sin_x, &cos_x);
+    max_error = std::max(max_error, std::abs(double(sin_x) - std::sin(double(x))));
+    max_error = std::max(max_error, std::abs(double(cos_x) - std::cos(double(x))));
+  }
+  EXPECT_LE(max_error, Bounds<T>::kSinCos);
+}
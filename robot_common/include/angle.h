@@ -0,0 +1,52 @@
+#ifndef ROBOT_COMMON_ANGLE_H_
+#define ROBOT_COMMON_ANGLE_H_
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "simd.h"
+
+namespace robot {
+namespace common {
+
+// Wraps `angle` into [-pi, pi) as angle - 2 pi floor((angle + pi) / (2 pi)). Unlike
+// add/subtract loops it is branch-free and takes the same time for any input. (angle + pi) / (2 pi)
+// can round onto an integer for angles just below pi (or just below any odd multiple), which would
+// land the result just below -pi, so results outside the range are moved back by one turn. floor
+// is found through ADL, so this works for ceres::Jet too; its derivative is exactly 1.
+template <typename T>
+inline T NormalizeAngle(const T& angle) {
+  using std::floor;
+  const T pi = T(M_PI);
+  const T two_pi = T(2. * M_PI);
+  const T wrapped = angle - two_pi * floor((angle + pi) / two_pi);
+  const T above = wrapped < -pi ? wrapped + two_pi : wrapped;
+  return above < pi ? above : above - two_pi;
+}
+
+// NormalizeAngle over `size` values, with identical results for |angle| < 1e15 (double) or 2e7
+// (float); `out` may alias `angles`. floor is found by rounding to the nearest integer, adding and
+// subtracting 1.5 * 2^(mantissa bits), then stepping down where that rounded up, so the loop
+// vectorizes even for targets without a vector floor instruction, such as baseline x86-64.
+template <typename T>
+inline void NormalizeAngles(const T* angles, size_t size, T* out) {
+  static_assert(std::is_floating_point<T>::value, "NormalizeAngles needs float or double");
+  const T pi = T(M_PI);
+  const T two_pi = T(2. * M_PI);
+  const T magic = std::is_same<T, float>::value ? T(12582912.0f) : T(6755399441055744.0);
+  ROBOT_SIMD_LOOP
+  for (size_t i = 0; i < size; ++i) {
+    const T turns = (angles[i] + pi) / two_pi;
+    const T rounded = (turns + magic) - magic;
+    const T floored = rounded > turns ? rounded - T(1) : rounded;
+    const T wrapped = angles[i] - two_pi * floored;
+    const T above = wrapped < -pi ? wrapped + two_pi : wrapped;
+    out[i] = above < pi ? above : above - two_pi;
+  }
+}
+
+}  // namespace common
+}  // namespace robot
+
+#endif
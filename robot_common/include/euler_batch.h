@@ -0,0 +1,36 @@
+#ifndef ROBOT_COMMON_EULER_BATCH_H_
+#define ROBOT_COMMON_EULER_BATCH_H_
+
+#include <cstddef>
+
+#include <Eigen/Dense>
+
+#include "pose_array.h"
+
+namespace robot {
+namespace common {
+
+// kExact calls std::atan2/std::asin per element. kFast uses the polynomials from fast_math.h
+// (at most 1.2e-5 rad of error), which vectorize.
+enum class AngleAccuracy { kExact, kFast };
+
+// Batched GetYaw over `size` contiguous quaternions.
+template <typename T>
+void GetYawBatch(const Eigen::Quaternion<T>* quats, size_t size, T* yaws,
+                 AngleAccuracy accuracy = AngleAccuracy::kExact);
+
+// Batched GetYaw over the rotations of a pose array; `yaws` must hold poses.size() values.
+template <typename T>
+void GetYawBatch(const SE3Array<T>& poses, T* yaws,
+                 AngleAccuracy accuracy = AngleAccuracy::kExact);
+
+// Batched EulerFromQuaternion. Column i of `euler` receives (roll, pitch, yaw) of quats[i].
+template <typename T>
+void EulerFromQuaternionBatch(const Eigen::Quaternion<T>* quats, size_t size,
+                              Eigen::Matrix<T, 3, Eigen::Dynamic>* euler,
+                              AngleAccuracy accuracy = AngleAccuracy::kExact);
+
+}  // namespace common
+}  // namespace robot
+
+#endif
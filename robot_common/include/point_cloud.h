@@ -0,0 +1,245 @@
+#ifndef ROBOT_COMMON_POINT_CLOUD_H_
+#define ROBOT_COMMON_POINT_CLOUD_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "simd.h"
+#include "thread_pool.h"
+#include "transform.h"
+
+namespace robot {
+namespace common {
+
+// Structure-of-arrays point cloud: x, y and z each in their own contiguous buffer, so the
+// transform kernels below vectorize over plain arrays.
+template <typename T>
+class PointArray {
+ public:
+  using Point = Eigen::Matrix<T, 3, 1>;
+
+  PointArray() = default;
+  explicit PointArray(size_t size) { resize(size); }
+
+  size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+
+  void reserve(size_t size) {
+    x_.reserve(size);
+    y_.reserve(size);
+    z_.reserve(size);
+  }
+  void resize(size_t size) {
+    x_.resize(size);
+    y_.resize(size);
+    z_.resize(size);
+  }
+  void clear() {
+    x_.clear();
+    y_.clear();
+    z_.clear();
+  }
+
+  void push_back(const Point& point) {
+    x_.push_back(point.x());
+    y_.push_back(point.y());
+    z_.push_back(point.z());
+  }
+
+  Point point(size_t i) const { return Point(x_[i], y_[i], z_[i]); }
+  void set_point(size_t i, const Point& point) {
+    x_[i] = point.x();
+    y_[i] = point.y();
+    z_[i] = point.z();
+  }
+
+  T* x() { return x_.data(); }
+  T* y() { return y_.data(); }
+  T* z() { return z_.data(); }
+  const T* x() const { return x_.data(); }
+  const T* y() const { return y_.data(); }
+  const T* z() const { return z_.data(); }
+
+ private:
+  std::vector<T> x_, y_, z_;
+};
+
+struct TransformCloudOptions {
+  // Splits the cloud across this pool, if set; otherwise runs on the calling thread.
+  ThreadPool* thread_pool = nullptr;
+  // Clouds are only split into chunks of at least this many points, below which handing a
+  // chunk to another thread costs more than transforming it.
+  size_t min_points_per_chunk = 32768;
+};
+
+namespace internal {
+
+// A pose as a row-major rotation matrix and a translation, unpacked once per transform.
+template <typename T>
+struct RigidTransform {
+  explicit RigidTransform(const SE3<T>& pose) {
+    Eigen::Map<Eigen::Matrix<T, 3, 3, Eigen::RowMajor>> rotation(r);
+    rotation = pose.rotation().toRotationMatrix();
+    t[0] = pose.translation().x();
+    t[1] = pose.translation().y();
+    t[2] = pose.translation().z();
+  }
+  T r[9];
+  T t[3];
+};
+
+// Transforms points [begin, end) whose coordinates are x[kStride * i], y[kStride * i] and
+// z[kStride * i]: the SoA arrays with kStride 1, the interleaved columns of a Matrix3X with 3.
+// The pose is copied into locals first, so that the compiler need not reload it after every
+// store to the outputs, which may equal the inputs.
+template <typename T, size_t kStride>
+void TransformChunk(const RigidTransform<T>& transform, const T* x, const T* y, const T* z,
+                    T* out_x, T* out_y, T* out_z, size_t begin, size_t end) {
+  const T r0 = transform.r[0], r1 = transform.r[1], r2 = transform.r[2];
+  const T r3 = transform.r[3], r4 = transform.r[4], r5 = transform.r[5];
+  const T r6 = transform.r[6], r7 = transform.r[7], r8 = transform.r[8];
+  const T t0 = transform.t[0], t1 = transform.t[1], t2 = transform.t[2];
+  ROBOT_SIMD_LOOP
+  for (size_t i = begin; i < end; ++i) {
+    const size_t j = kStride * i;
+    const T px = x[j], py = y[j], pz = z[j];
+    out_x[j] = r0 * px + r1 * py + r2 * pz + t0;
+    out_y[j] = r3 * px + r4 * py + r5 * pz + t1;
+    out_z[j] = r6 * px + r7 * py + r8 * pz + t2;
+  }
+}
+
+// Poses as twelve arrays of `poses.size()` components: the row-major rotation, then the
+// translation. The deskew loop below reads each component of a point's pose with one vector
+// gather from one of these arrays.
+template <typename T>
+std::vector<T> ComponentTable(const std::vector<SE3<T>>& poses) {
+  const size_t size = poses.size();
+  std::vector<T> table(12 * size);
+  for (size_t p = 0; p < size; ++p) {
+    const RigidTransform<T> transform(poses[p]);
+    for (size_t k = 0; k < 9; ++k) table[k * size + p] = transform.r[k];
+    for (size_t k = 0; k < 3; ++k) table[(9 + k) * size + p] = transform.t[k];
+  }
+  return table;
+}
+
+// As TransformChunk, with point i transformed by pose pose_indices[i] of a ComponentTable of
+// `num_poses` poses.
+template <typename T, size_t kStride>
+void DeskewChunk(const T* table, size_t num_poses, const uint32_t* pose_indices, const T* x,
+                 const T* y, const T* z, T* out_x, T* out_y, T* out_z, size_t begin,
+                 size_t end) {
+  const T* r0 = table;
+  const T* r1 = r0 + num_poses;
+  const T* r2 = r1 + num_poses;
+  const T* r3 = r2 + num_poses;
+  const T* r4 = r3 + num_poses;
+  const T* r5 = r4 + num_poses;
+  const T* r6 = r5 + num_poses;
+  const T* r7 = r6 + num_poses;
+  const T* r8 = r7 + num_poses;
+  const T* t0 = r8 + num_poses;
+  const T* t1 = t0 + num_poses;
+  const T* t2 = t1 + num_poses;
+  ROBOT_SIMD_LOOP
+  for (size_t i = begin; i < end; ++i) {
+    const size_t p = pose_indices[i];
+    const size_t j = kStride * i;
+    const T px = x[j], py = y[j], pz = z[j];
+    out_x[j] = r0[p] * px + r1[p] * py + r2[p] * pz + t0[p];
+    out_y[j] = r3[p] * px + r4[p] * py + r5[p] * pz + t1[p];
+    out_z[j] = r6[p] * px + r7[p] * py + r8[p] * pz + t2[p];
+  }
+}
+
+template <typename Function>
+void ForEachChunk(size_t size, const TransformCloudOptions& options, const Function& function) {
+  if (options.thread_pool) {
+    options.thread_pool->ParallelFor(size, options.min_points_per_chunk, function);
+  } else {
+    function(size_t(0), size);
+  }
+}
+
+}  // namespace internal
+
+// Applies `pose` to every column of `points`. The quaternion becomes a rotation matrix once;
+// each point then costs nine multiply-adds. `out` may be `points`.
+template <typename T>
+void TransformCloud(const SE3<T>& pose, const Eigen::Matrix<T, 3, Eigen::Dynamic>& points,
+                    Eigen::Matrix<T, 3, Eigen::Dynamic>* out,
+                    const TransformCloudOptions& options = TransformCloudOptions()) {
+  const internal::RigidTransform<T> transform(pose);
+  out->resize(3, points.cols());
+  const T* in = points.data();
+  T* result = out->data();
+  internal::ForEachChunk(points.cols(), options, [&](size_t begin, size_t end) {
+    internal::TransformChunk<T, 3>(transform, in, in + 1, in + 2, result, result + 1, result + 2,
+                                   begin, end);
+  });
+}
+
+// SoA overload, which the compiler vectorizes across points. `out` may be `points`.
+template <typename T>
+void TransformCloud(const SE3<T>& pose, const PointArray<T>& points, PointArray<T>* out,
+                    const TransformCloudOptions& options = TransformCloudOptions()) {
+  const internal::RigidTransform<T> transform(pose);
+  out->resize(points.size());
+  const T* x = points.x();
+  const T* y = points.y();
+  const T* z = points.z();
+  T* out_x = out->x();
+  T* out_y = out->y();
+  T* out_z = out->z();
+  internal::ForEachChunk(points.size(), options, [&](size_t begin, size_t end) {
+    internal::TransformChunk<T, 1>(transform, x, y, z, out_x, out_y, out_z, begin, end);
+  });
+}
+
+// Deskewing: applies poses[pose_indices[i]] to point i, e.g. the sensor pose at each point's
+// capture time, sampled at a few hundred timestamps over a sweep. Every pose becomes a
+// rotation matrix once, not once per point. `out` may be `points`.
+template <typename T>
+void TransformCloud(const std::vector<SE3<T>>& poses, const std::vector<uint32_t>& pose_indices,
+                    const Eigen::Matrix<T, 3, Eigen::Dynamic>& points,
+                    Eigen::Matrix<T, 3, Eigen::Dynamic>* out,
+                    const TransformCloudOptions& options = TransformCloudOptions()) {
+  assert(pose_indices.size() == static_cast<size_t>(points.cols()));
+  const std::vector<T> table = internal::ComponentTable(poses);
+  out->resize(3, points.cols());
+  const T* in = points.data();
+  T* result = out->data();
+  internal::ForEachChunk(points.cols(), options, [&](size_t begin, size_t end) {
+    internal::DeskewChunk<T, 3>(table.data(), poses.size(), pose_indices.data(), in, in + 1,
+                                in + 2, result, result + 1, result + 2, begin, end);
+  });
+}
+
+template <typename T>
+void TransformCloud(const std::vector<SE3<T>>& poses, const std::vector<uint32_t>& pose_indices,
+                    const PointArray<T>& points, PointArray<T>* out,
+                    const TransformCloudOptions& options = TransformCloudOptions()) {
+  assert(pose_indices.size() == points.size());
+  const std::vector<T> table = internal::ComponentTable(poses);
+  out->resize(points.size());
+  const T* x = points.x();
+  const T* y = points.y();
+  const T* z = points.z();
+  T* out_x = out->x();
+  T* out_y = out->y();
+  T* out_z = out->z();
+  internal::ForEachChunk(points.size(), options, [&](size_t begin, size_t end) {
+    internal::DeskewChunk<T, 1>(table.data(), poses.size(), pose_indices.data(), x, y, z,
+                                out_x, out_y, out_z, begin, end);
+  });
+}
+
+}  // namespace common
+}  // namespace robot
+
+#endif
@@ -0,0 +1,312 @@
+#ifndef ROBOT_COMMON_POSE_ARRAY_H_
+#define ROBOT_COMMON_POSE_ARRAY_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "fast_math.h"
+#include "simd.h"
+#include "transform.h"
+
+namespace robot {
+namespace common {
+
+// Structure-of-arrays container for SE3 poses. Every component is kept in its own contiguous
+// buffer, so the batch kernels below run over plain arrays the compiler can vectorize.
+template <typename T>
+class SE3Array {
+ public:
+  SE3Array() = default;
+  explicit SE3Array(size_t size) { resize(size); }
+
+  size_t size() const { return tx_.size(); }
+  bool empty() const { return tx_.empty(); }
+
+  void reserve(size_t size) {
+    for (std::vector<T>* component : components()) component->reserve(size);
+  }
+  void resize(size_t size) {
+    for (std::vector<T>* component : components()) component->resize(size);
+  }
+  void clear() {
+    for (std::vector<T>* component : components()) component->clear();
+  }
+
+  void push_back(const SE3<T>& pose) {
+    tx_.push_back(pose.translation().x());
+    ty_.push_back(pose.translation().y());
+    tz_.push_back(pose.translation().z());
+    qw_.push_back(pose.rotation().w());
+    qx_.push_back(pose.rotation().x());
+    qy_.push_back(pose.rotation().y());
+    qz_.push_back(pose.rotation().z());
+  }
+
+  SE3<T> pose(size_t i) const {
+    return SE3<T>(typename SE3<T>::Translation(tx_[i], ty_[i], tz_[i]),
+                  typename SE3<T>::Rotation(qw_[i], qx_[i], qy_[i], qz_[i]));
+  }
+  void set_pose(size_t i, const SE3<T>& pose) {
+    tx_[i] = pose.translation().x();
+    ty_[i] = pose.translation().y();
+    tz_[i] = pose.translation().z();
+    qw_[i] = pose.rotation().w();
+    qx_[i] = pose.rotation().x();
+    qy_[i] = pose.rotation().y();
+    qz_[i] = pose.rotation().z();
+  }
+
+  T* tx() { return tx_.data(); }
+  T* ty() { return ty_.data(); }
+  T* tz() { return tz_.data(); }
+  T* qw() { return qw_.data(); }
+  T* qx() { return qx_.data(); }
+  T* qy() { return qy_.data(); }
+  T* qz() { return qz_.data(); }
+  const T* tx() const { return tx_.data(); }
+  const T* ty() const { return ty_.data(); }
+  const T* tz() const { return tz_.data(); }
+  const T* qw() const { return qw_.data(); }
+  const T* qx() const { return qx_.data(); }
+  const T* qy() const { return qy_.data(); }
+  const T* qz() const { return qz_.data(); }
+
+ private:
+  std::vector<std::vector<T>*> components() {
+    return {&tx_, &ty_, &tz_, &qw_, &qx_, &qy_, &qz_};
+  }
+
+  std::vector<T> tx_, ty_, tz_;
+  std::vector<T> qw_, qx_, qy_, qz_;
+};
+
+// Structure-of-arrays container for SE2 poses, stored as x, y and heading angle.
+template <typename T>
+class SE2Array {
+ public:
+  SE2Array() = default;
+  explicit SE2Array(size_t size) { resize(size); }
+
+  size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+
+  void reserve(size_t size) {
+    x_.reserve(size);
+    y_.reserve(size);
+    theta_.reserve(size);
+  }
+  void resize(size_t size) {
+    x_.resize(size);
+    y_.resize(size);
+    theta_.resize(size);
+  }
+  void clear() {
+    x_.clear();
+    y_.clear();
+    theta_.clear();
+  }
+
+  void push_back(const SE2<T>& pose) {
+    x_.push_back(pose.translation().x());
+    y_.push_back(pose.translation().y());
+    theta_.push_back(pose.rotation().angle());
+  }
+
+  SE2<T> pose(size_t i) const {
+    return SE2<T>(typename SE2<T>::Translation(x_[i], y_[i]),
+                  typename SE2<T>::Rotation(theta_[i]));
+  }
+  void set_pose(size_t i, const SE2<T>& pose) {
+    x_[i] = pose.translation().x();
+    y_[i] = pose.translation().y();
+    theta_[i] = pose.rotation().angle();
+  }
+
+  T* x() { return x_.data(); }
+  T* y() { return y_.data(); }
+  T* theta() { return theta_.data(); }
+  const T* x() const { return x_.data(); }
+  const T* y() const { return y_.data(); }
+  const T* theta() const { return theta_.data(); }
+
+ private:
+  std::vector<T> x_, y_, theta_;
+};
+
+// Computes out[i] = lhs[i] * rhs[i]. Returns false, leaving `out` unchanged, if the arrays
+// differ in size. `out` may alias either input; every element reads all of its inputs before
+// writing.
+template <typename T>
+bool ComposeBatch(const SE3Array<T>& lhs, const SE3Array<T>& rhs, SE3Array<T>* out) {
+  if (lhs.size() != rhs.size()) return false;
+  const size_t size = lhs.size();
+  out->resize(size);
+
+  const T* ltx = lhs.tx();
+  const T* lty = lhs.ty();
+  const T* ltz = lhs.tz();
+  const T* lqw = lhs.qw();
+  const T* lqx = lhs.qx();
+  const T* lqy = lhs.qy();
+  const T* lqz = lhs.qz();
+  const T* rtx = rhs.tx();
+  const T* rty = rhs.ty();
+  const T* rtz = rhs.tz();
+  const T* rqw = rhs.qw();
+  const T* rqx = rhs.qx();
+  const T* rqy = rhs.qy();
+  const T* rqz = rhs.qz();
+  T* otx = out->tx();
+  T* oty = out->ty();
+  T* otz = out->tz();
+  T* oqw = out->qw();
+  T* oqx = out->qx();
+  T* oqy = out->qy();
+  T* oqz = out->qz();
+
+  ROBOT_SIMD_LOOP
+  for (size_t i = 0; i < size; ++i) {
+    const T w1 = lqw[i], x1 = lqx[i], y1 = lqy[i], z1 = lqz[i];
+    const T w2 = rqw[i], x2 = rqx[i], y2 = rqy[i], z2 = rqz[i];
+    const T vx = rtx[i], vy = rty[i], vz = rtz[i];
+
+    // Rotates the rhs translation the same way Eigen does: v + w * u + q.vec() x u, with
+    // u = 2 * q.vec() x v.
+    const T ux = T(2) * (y1 * vz - z1 * vy);
+    const T uy = T(2) * (z1 * vx - x1 * vz);
+    const T uz = T(2) * (x1 * vy - y1 * vx);
+    const T tx = ltx[i] + vx + w1 * ux + (y1 * uz - z1 * uy);
+    const T ty = lty[i] + vy + w1 * uy + (z1 * ux - x1 * uz);
+    const T tz = ltz[i] + vz + w1 * uz + (x1 * uy - y1 * ux);
+
+    const T qw = w1 * w2 - x1 * x2 - y1 * y2 - z1 * z2;
+    const T qx = w1 * x2 + x1 * w2 + y1 * z2 - z1 * y2;
+    const T qy = w1 * y2 - x1 * z2 + y1 * w2 + z1 * x2;
+    const T qz = w1 * z2 + x1 * y2 - y1 * x2 + z1 * w2;
+
+    otx[i] = tx;
+    oty[i] = ty;
+    otz[i] = tz;
+    oqw[i] = qw;
+    oqx[i] = qx;
+    oqy[i] = qy;
+    oqz[i] = qz;
+  }
+  return true;
+}
+
+template <typename T>
+bool ComposeBatch(const SE2Array<T>& lhs, const SE2Array<T>& rhs, SE2Array<T>* out) {
+  if (lhs.size() != rhs.size()) return false;
+  const size_t size = lhs.size();
+  out->resize(size);
+
+  const T* lx = lhs.x();
+  const T* ly = lhs.y();
+  const T* ltheta = lhs.theta();
+  const T* rx = rhs.x();
+  const T* ry = rhs.y();
+  const T* rtheta = rhs.theta();
+  T* ox = out->x();
+  T* oy = out->y();
+  T* otheta = out->theta();
+
+  ROBOT_SIMD_LOOP
+  for (size_t i = 0; i < size; ++i) {
+    T s, c;
+    BranchFreeSinCos(ltheta[i], &s, &c);
+    const T x = lx[i] + c * rx[i] - s * ry[i];
+    const T y = ly[i] + s * rx[i] + c * ry[i];
+    const T theta = ltheta[i] + rtheta[i];
+    ox[i] = x;
+    oy[i] = y;
+    otheta[i] = theta;
+  }
+  return true;
+}
+
+// Array-of-structures overloads for callers that already hold contiguous SE3/SE2 buffers.
+template <typename T>
+void ComposeBatch(const SE3<T>* lhs, const SE3<T>* rhs, SE3<T>* out, size_t size) {
+  for (size_t i = 0; i < size; ++i) out[i] = lhs[i] * rhs[i];
+}
+
+template <typename T>
+void ComposeBatch(const SE2<T>* lhs, const SE2<T>* rhs, SE2<T>* out, size_t size) {
+  for (size_t i = 0; i < size; ++i) out[i] = lhs[i] * rhs[i];
+}
+
+// Batched SE3::ToSE2. `out` receives the same headings to within 5e-16 rad in double.
+template <typename T>
+void ToSE2(const SE3Array<T>& poses, SE2Array<T>* out) {
+  const size_t size = poses.size();
+  out->resize(size);
+  const T* tx = poses.tx();
+  const T* ty = poses.ty();
+  const T* qw = poses.qw();
+  const T* qx = poses.qx();
+  const T* qy = poses.qy();
+  const T* qz = poses.qz();
+  T* x = out->x();
+  T* y = out->y();
+  T* theta = out->theta();
+  ROBOT_SIMD_LOOP
+  for (size_t i = 0; i < size; ++i) {
+    x[i] = tx[i];
+    y[i] = ty[i];
+    theta[i] = BranchFreeAtan2(T(2) * (qw[i] * qz[i] + qx[i] * qy[i]),
+                     T(1) - T(2) * (qy[i] * qy[i] + qz[i] * qz[i]));
+  }
+}
+
+// Batched SE2::ToSE3.
+template <typename T>
+void ToSE3(const SE2Array<T>& poses, SE3Array<T>* out) {
+  const size_t size = poses.size();
+  out->resize(size);
+  const T* x = poses.x();
+  const T* y = poses.y();
+  const T* theta = poses.theta();
+  T* tx = out->tx();
+  T* ty = out->ty();
+  T* tz = out->tz();
+  T* qw = out->qw();
+  T* qx = out->qx();
+  T* qy = out->qy();
+  T* qz = out->qz();
+  ROBOT_SIMD_LOOP
+  for (size_t i = 0; i < size; ++i) {
+    T sin_half_theta, cos_half_theta;
+    BranchFreeSinCos(theta[i] / T(2), &sin_half_theta, &cos_half_theta);
+    tx[i] = x[i];
+    ty[i] = y[i];
+    tz[i] = T(0);
+    qw[i] = cos_half_theta;
+    qx[i] = T(0);
+    qy[i] = T(0);
+    qz[i] = sin_half_theta;
+  }
+}
+
+// Applies `pose` to every column of `points`. The quaternion is converted to a rotation matrix
+// once, so the per-point work is a single 3x3 multiply-add.
+template <typename T>
+Eigen::Matrix<T, 3, Eigen::Dynamic> TransformPoints(
+    const SE3<T>& pose, const Eigen::Matrix<T, 3, Eigen::Dynamic>& points) {
+  const Eigen::Matrix<T, 3, 3> rotation = pose.rotation().toRotationMatrix();
+  return (rotation * points).colwise() + pose.translation();
+}
+
+template <typename T>
+Eigen::Matrix<T, 2, Eigen::Dynamic> TransformPoints(
+    const SE2<T>& pose, const Eigen::Matrix<T, 2, Eigen::Dynamic>& points) {
+  const Eigen::Matrix<T, 2, 2> rotation = pose.rotation().toRotationMatrix();
+  return (rotation * points).colwise() + pose.translation();
+}
+
+}  // namespace common
+}  // namespace robot
+
+#endif
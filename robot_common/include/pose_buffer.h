@@ -0,0 +1,152 @@
+#ifndef ROBOT_COMMON_POSE_BUFFER_H_
+#define ROBOT_COMMON_POSE_BUFFER_H_
+
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "transform.h"
+
+namespace robot {
+namespace common {
+
+// kSlerp moves the rotation at constant angular velocity. kNlerp blends the quaternions
+// linearly and normalizes: no trigonometry, and between samples less than 30 degrees apart its
+// angle deviates from slerp's by under 0.1 degrees.
+enum class RotationInterpolation { kSlerp, kNlerp };
+
+// Pose `alpha` of the way from `from` to `to`, alpha in [0, 1]: the translation linearly, the
+// rotation along the shorter arc.
+template <typename T>
+SE3<T> Interpolate(const SE3<T>& from, const SE3<T>& to, T alpha,
+                   RotationInterpolation interpolation = RotationInterpolation::kSlerp) {
+  const typename SE3<T>::Translation translation =
+      from.translation() + alpha * (to.translation() - from.translation());
+  if (interpolation == RotationInterpolation::kSlerp) {
+    return SE3<T>(translation, from.rotation().slerp(alpha, to.rotation()));
+  }
+  const T to_weight = from.rotation().dot(to.rotation()) < T(0) ? -alpha : alpha;
+  typename SE3<T>::Rotation rotation;
+  rotation.coeffs() =
+      (T(1) - alpha) * from.rotation().coeffs() + to_weight * to.rotation().coeffs();
+  rotation.normalize();
+  return SE3<T>(translation, rotation);
+}
+
+template <typename Pose>
+class PoseBuffer;
+
+// Ring buffer of timestamped poses that interpolates between them. Pushing past the capacity
+// drops the oldest pose. Timestamps are SoA, apart from the poses, so a lookup's binary search
+// walks a plain array of doubles; lookups at or after the second newest pose, the usual case
+// when syncing sensors to the latest odometry, skip the search altogether.
+//
+// One writer and any number of readers may use the buffer concurrently: readers share a lock
+// that the writer takes exclusively for the few stores of a Push().
+template <typename T>
+class PoseBuffer<SE3<T>> {
+ public:
+  explicit PoseBuffer(size_t capacity,
+                      RotationInterpolation interpolation = RotationInterpolation::kSlerp)
+      : interpolation_(interpolation), times_(capacity), poses_(capacity) {}
+
+  PoseBuffer(const PoseBuffer&) = delete;
+  PoseBuffer& operator=(const PoseBuffer&) = delete;
+
+  // Appends the pose at `timestamp`, in seconds. Returns false, leaving the buffer unchanged,
+  // unless `timestamp` is after the newest one.
+  bool Push(double timestamp, const SE3<T>& pose) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (times_.empty() || (size_ > 0 && timestamp <= times_[Physical(size_ - 1)])) return false;
+    size_t slot;
+    if (size_ < times_.size()) {
+      slot = Physical(size_++);
+    } else {
+      slot = begin_;
+      begin_ = Physical(1);
+    }
+    times_[slot] = timestamp;
+    poses_[slot] = pose;
+    return true;
+  }
+
+  // Sets `pose` to the pose at `timestamp`, interpolated between the poses around it. Returns
+  // false if `timestamp` is outside the buffered span.
+  bool Lookup(double timestamp, SE3<T>* pose) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (size_ == 0 || timestamp < times_[begin_]) return false;
+    const size_t last = size_ - 1;
+    if (timestamp >= times_[Physical(last)]) {
+      if (timestamp > times_[Physical(last)]) return false;
+      *pose = poses_[Physical(last)];
+      return true;
+    }
+    // Index of the first pose after `timestamp`, in [1, last].
+    size_t after;
+    if (timestamp >= times_[Physical(last - 1)]) {
+      after = last;
+    } else {
+      size_t low = 1;
+      size_t high = last - 1;
+      while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (times_[Physical(middle)] > timestamp) {
+          high = middle;
+        } else {
+          low = middle + 1;
+        }
+      }
+      after = low;
+    }
+    const size_t from = Physical(after - 1);
+    const size_t to = Physical(after);
+    const T alpha = static_cast<T>((timestamp - times_[from]) / (times_[to] - times_[from]));
+    *pose = Interpolate(poses_[from], poses_[to], alpha, interpolation_);
+    return true;
+  }
+
+  // Sets `begin` and `end` to the timestamps of the oldest and the newest pose. Returns false
+  // if the buffer is empty.
+  bool TimeSpan(double* begin, double* end) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (size_ == 0) return false;
+    *begin = times_[begin_];
+    *end = times_[Physical(size_ - 1)];
+    return true;
+  }
+
+  void Clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    begin_ = 0;
+    size_ = 0;
+  }
+
+  size_t size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return size_;
+  }
+  size_t capacity() const { return times_.size(); }
+
+ private:
+  // Slot of the pose `index` places after the oldest one.
+  size_t Physical(size_t index) const {
+    const size_t slot = begin_ + index;
+    return slot < times_.size() ? slot : slot - times_.size();
+  }
+
+  const RotationInterpolation interpolation_;
+  mutable std::shared_mutex mutex_;
+  std::vector<double> times_;
+  std::vector<SE3<T>> poses_;
+  // Slot of the oldest pose.
+  size_t begin_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace common
+}  // namespace robot
+
+#endif
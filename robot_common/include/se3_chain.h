@@ -0,0 +1,75 @@
+#ifndef ROBOT_COMMON_SE3_CHAIN_H_
+#define ROBOT_COMMON_SE3_CHAIN_H_
+
+#include <algorithm>
+#include <array>
+
+#include <Eigen/Dense>
+
+#include "transform.h"
+
+namespace robot {
+namespace common {
+
+// Lazily composed product of N poses, spelled Chain(a) * b * c * ... . Multiplying only
+// records the operand; the product is formed when the chain is converted to an SE3 or applied
+// to a point. Only a product started with Chain() is lazy: a plain a * b * c of SE3 values
+// stays eager and composes left to right, one intermediate SE3 per operator*. Operands are
+// held by pointer, so a chain must not outlive the poses it refers to (as with Eigen
+// expressions, prefer evaluating it in the full-expression that builds it).
+template <typename T, int N>
+class SE3Chain {
+ public:
+  using Translation = typename SE3<T>::Translation;
+  using Rotation = typename SE3<T>::Rotation;
+
+  explicit SE3Chain(const std::array<const SE3<T>*, N>& links) : links_(links) {}
+
+  SE3Chain<T, N + 1> operator*(const SE3<T>& rhs) const {
+    std::array<const SE3<T>*, N + 1> links;
+    std::copy(links_.begin(), links_.end(), links.begin());
+    links[N] = &rhs;
+    return SE3Chain<T, N + 1>(links);
+  }
+
+  // Composes all links in one fused pass. Links are combined pairwise, (0 1)(2 3)..., then
+  // pairs of pairs, so the dependency depth is log2(N) instead of the N - 1 of a left-to-right
+  // fold, and no intermediate SE3 objects are materialized.
+  SE3<T> Evaluate() const {
+    std::array<Translation, N> translations;
+    std::array<Rotation, N> rotations;
+    for (int i = 0; i < N; ++i) {
+      translations[i] = links_[i]->translation();
+      rotations[i] = links_[i]->rotation();
+    }
+    for (int width = 1; width < N; width *= 2) {
+      for (int i = 0; i + width < N; i += 2 * width) {
+        translations[i] += rotations[i] * translations[i + width];
+        rotations[i] *= rotations[i + width];
+      }
+    }
+    return SE3<T>(translations[0], rotations[0]);
+  }
+  operator SE3<T>() const { return Evaluate(); }
+
+  // Applies the chain to a point. Rotating the point link by link, right to left, is a serial
+  // dependency chain and measures slower than the pairwise reduction above followed by a
+  // single rotation, so the latter is used.
+  Translation operator*(const Translation& point) const {
+    const SE3<T> pose = Evaluate();
+    return pose.translation() + pose.rotation() * point;
+  }
+
+ private:
+  std::array<const SE3<T>*, N> links_;
+};
+
+template <typename T>
+SE3Chain<T, 1> Chain(const SE3<T>& pose) {
+  return SE3Chain<T, 1>({&pose});
+}
+
+}  // namespace common
+}  // namespace robot
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef ROBOT_COMMON_SE3_MAP_H_
+#define ROBOT_COMMON_SE3_MAP_H_
+
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+#include "transform.h"
+
+namespace robot {
+namespace common {
+
+enum class SE3Layout {
+  // [tx, ty, tz, qx, qy, qz, qw]: the layout of ROS pose messages and of a ceres parameter
+  // block used with a quaternion manifold.
+  kPacked,
+  // [tx, ty, tz, pad, qx, qy, qz, qw] on a 32-byte boundary, so translation and rotation each
+  // start on a vector register boundary. See SE3PaddedStorage.
+  kPadded,
+};
+
+// Eigen::Map-style view of an SE3 stored in an external buffer. Use SE3Map<const T> for
+// read-only buffers. Nothing is copied: writes through the view land in the buffer.
+template <typename T, SE3Layout Layout = SE3Layout::kPacked>
+class SE3Map {
+ public:
+  using Scalar = typename std::remove_const<T>::type;
+  static constexpr bool kIsConst = std::is_const<T>::value;
+  static constexpr int kRotationOffset = Layout == SE3Layout::kPacked ? 3 : 4;
+  static constexpr int kSize = Layout == SE3Layout::kPacked ? 7 : 8;
+  static constexpr int kMapOptions =
+      Layout == SE3Layout::kPacked ? Eigen::Unaligned : Eigen::Aligned16;
+
+  using Translation = Eigen::Map<
+      typename std::conditional<kIsConst, const typename SE3<Scalar>::Translation,
+                                typename SE3<Scalar>::Translation>::type,
+      kMapOptions>;
+  using Rotation =
+      Eigen::Map<typename std::conditional<kIsConst, const typename SE3<Scalar>::Rotation,
+                                           typename SE3<Scalar>::Rotation>::type,
+                 kMapOptions>;
+
+  explicit SE3Map(T* data) : translation_(data), rotation_(data + kRotationOffset) {}
+
+  SE3Map& operator=(const SE3<Scalar>& pose) {
+    translation_ = pose.translation();
+    rotation_ = pose.rotation();
+    return *this;
+  }
+
+  const Translation& translation() const { return translation_; }
+  const Rotation& rotation() const { return rotation_; }
+  Translation& translation() { return translation_; }
+  Rotation& rotation() { return rotation_; }
+
+  SE3<Scalar> ToSE3() const { return SE3<Scalar>(translation_, rotation_); }
+  operator SE3<Scalar>() const { return ToSE3(); }
+
+  SE3<Scalar> inverse() const {
+    const typename SE3<Scalar>::Rotation rotation_inverse = rotation_.conjugate();
+    return SE3<Scalar>(rotation_inverse * (-translation_), rotation_inverse);
+  }
+
+ private:
+  Translation translation_;
+  Rotation rotation_;
+};
+
+// 32-byte aligned backing store for SE3Layout::kPadded, initialized to the identity.
+// std::vector<SE3PaddedStorage<T>> keeps every element aligned.
+template <typename T>
+struct alignas(32) SE3PaddedStorage {
+  T data[8] = {T(0), T(0), T(0), T(0), T(0), T(0), T(0), T(1)};
+
+  SE3Map<T, SE3Layout::kPadded> map() { return SE3Map<T, SE3Layout::kPadded>(data); }
+  SE3Map<const T, SE3Layout::kPadded> map() const {
+    return SE3Map<const T, SE3Layout::kPadded>(data);
+  }
+};
+
+template <typename L, SE3Layout LL, typename R, SE3Layout RL>
+SE3<typename SE3Map<L, LL>::Scalar> operator*(const SE3Map<L, LL>& lhs,
+                                              const SE3Map<R, RL>& rhs) {
+  return SE3<typename SE3Map<L, LL>::Scalar>(
+      lhs.translation() + lhs.rotation() * rhs.translation(), lhs.rotation() * rhs.rotation());
+}
+
+template <typename T, typename R, SE3Layout RL>
+SE3<T> operator*(const SE3<T>& lhs, const SE3Map<R, RL>& rhs) {
+  return SE3<T>(lhs.translation() + lhs.rotation() * rhs.translation(),
+                lhs.rotation() * rhs.rotation());
+}
+
+template <typename L, SE3Layout LL, typename T>
+SE3<T> operator*(const SE3Map<L, LL>& lhs, const SE3<T>& rhs) {
+  return SE3<T>(lhs.translation() + lhs.rotation() * rhs.translation(),
+                lhs.rotation() * rhs.rotation());
+}
+
+}  // namespace common
+}  // namespace robot
+
+#endif
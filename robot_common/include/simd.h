@@ -0,0 +1,12 @@
+#ifndef ROBOT_COMMON_SIMD_H_
+#define ROBOT_COMMON_SIMD_H_
+
+// Precedes a loop whose iteration i touches element i of its arrays alone, reading all of its
+// inputs before writing. The iterations are then independent, so the compiler vectorizes the
+// loop without the run-time alias checks it gives up on past ten arrays, and outputs may still
+// alias inputs. Takes effect with -fopenmp-simd, a public compile option of robot_common; GCC
+// also needs that target's -fno-trapping-math to vectorize loops whose bodies contain selects,
+// and -fno-math-errno for loops calling sqrt.
+#define ROBOT_SIMD_LOOP _Pragma("omp simd")
+
+#endif
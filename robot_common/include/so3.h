@@ -0,0 +1,112 @@
+#ifndef ROBOT_COMMON_SO3_H_
+#define ROBOT_COMMON_SO3_H_
+
+#include <cmath>
+#include <type_traits>
+
+#include <Eigen/Dense>
+
+namespace robot {
+namespace common {
+
+// Below this angle the closed-form Lie group expressions lose precision to cancellation and
+// their Taylor expansions are used instead.
+template <typename T>
+T SmallAngleThreshold() {
+  return std::is_same<T, float>::value ? T(3e-2) : T(1e-3);
+}
+
+// Skew-symmetric matrix such that Hat(a) * b == a.cross(b).
+template <typename T>
+Eigen::Matrix<T, 3, 3> Hat(const Eigen::Matrix<T, 3, 1>& v) {
+  Eigen::Matrix<T, 3, 3> hat;
+  hat << T(0), -v.z(), v.y(), v.z(), T(0), -v.x(), -v.y(), v.x(), T(0);
+  return hat;
+}
+
+// Rotation by the angle-axis vector `phi`.
+template <typename T>
+Eigen::Quaternion<T> SO3Exp(const Eigen::Matrix<T, 3, 1>& phi) {
+  using std::cos;
+  using std::sin;
+  const T theta_sq = phi.squaredNorm();
+  const T theta = std::sqrt(theta_sq);
+  T w, s;
+  if (theta < SmallAngleThreshold<T>()) {
+    w = T(1) - theta_sq / T(8);
+    s = T(0.5) - theta_sq / T(48);
+  } else {
+    w = cos(theta / T(2));
+    s = sin(theta / T(2)) / theta;
+  }
+  return Eigen::Quaternion<T>(w, s * phi.x(), s * phi.y(), s * phi.z());
+}
+
+// Angle-axis vector of a unit quaternion, with the angle in [0, pi].
+template <typename T>
+Eigen::Matrix<T, 3, 1> SO3Log(const Eigen::Quaternion<T>& quat) {
+  using std::atan2;
+  // q and -q are the same rotation; pick the one with the shorter angle.
+  const T sign = quat.w() < T(0) ? T(-1) : T(1);
+  const T w = sign * quat.w();
+  const Eigen::Matrix<T, 3, 1> vec = sign * quat.vec();
+  const T n_sq = vec.squaredNorm();
+  const T n = std::sqrt(n_sq);
+  if (n < SmallAngleThreshold<T>()) {
+    return (T(2) / w - T(2) * n_sq / (T(3) * w * w * w)) * vec;
+  }
+  return (T(2) * atan2(n, w) / n) * vec;
+}
+
+// Left Jacobian of SO3: Exp(phi + d) ~= Exp(J_l(phi) * d) * Exp(phi).
+template <typename T>
+Eigen::Matrix<T, 3, 3> SO3LeftJacobian(const Eigen::Matrix<T, 3, 1>& phi) {
+  using std::cos;
+  using std::sin;
+  const T theta_sq = phi.squaredNorm();
+  const T theta = std::sqrt(theta_sq);
+  T a, b;
+  if (theta < SmallAngleThreshold<T>()) {
+    a = T(0.5) - theta_sq / T(24);
+    b = T(1) / T(6) - theta_sq / T(120);
+  } else {
+    a = (T(1) - cos(theta)) / theta_sq;
+    b = (theta - sin(theta)) / (theta_sq * theta);
+  }
+  const Eigen::Matrix<T, 3, 3> hat = Hat(phi);
+  return Eigen::Matrix<T, 3, 3>::Identity() + a * hat + b * hat * hat;
+}
+
+template <typename T>
+Eigen::Matrix<T, 3, 3> SO3LeftJacobianInverse(const Eigen::Matrix<T, 3, 1>& phi) {
+  using std::cos;
+  using std::sin;
+  const T theta_sq = phi.squaredNorm();
+  const T theta = std::sqrt(theta_sq);
+  T b;
+  if (theta < SmallAngleThreshold<T>()) {
+    b = T(1) / T(12) + theta_sq / T(720);
+  } else {
+    // (1 - (theta / 2) * cot(theta / 2)) / theta^2, which stays finite at theta = pi.
+    const T half_theta = theta / T(2);
+    b = (T(1) - half_theta * cos(half_theta) / sin(half_theta)) / theta_sq;
+  }
+  const Eigen::Matrix<T, 3, 3> hat = Hat(phi);
+  return Eigen::Matrix<T, 3, 3>::Identity() - T(0.5) * hat + b * hat * hat;
+}
+
+// Right Jacobian of SO3: Exp(phi + d) ~= Exp(phi) * Exp(J_r(phi) * d).
+template <typename T>
+Eigen::Matrix<T, 3, 3> SO3RightJacobian(const Eigen::Matrix<T, 3, 1>& phi) {
+  return SO3LeftJacobian<T>(-phi);
+}
+
+template <typename T>
+Eigen::Matrix<T, 3, 3> SO3RightJacobianInverse(const Eigen::Matrix<T, 3, 1>& phi) {
+  return SO3LeftJacobianInverse<T>(-phi);
+}
+
+}  // namespace common
+}  // namespace robot
+
+#endif
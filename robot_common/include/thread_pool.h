@@ -0,0 +1,50 @@
+#ifndef ROBOT_COMMON_THREAD_POOL_H_
+#define ROBOT_COMMON_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace robot {
+namespace common {
+
+// Fixed set of worker threads for data-parallel loops. Create one and reuse it across frames;
+// starting threads per call would cost more than most loops it splits.
+class ThreadPool {
+ public:
+  // 0 starts one thread per hardware thread, less the caller's.
+  explicit ThreadPool(int num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int num_threads() const { return threads_.size(); }
+
+  // Calls function(begin, end) on consecutive chunks covering [0, size), each at least
+  // `min_chunk_size` long but the last, on the workers and the calling thread. Returns when
+  // every chunk is done. While it waits the caller runs queued chunks itself, so a chunk may
+  // call ParallelFor again.
+  void ParallelFor(size_t size, size_t min_chunk_size,
+                   const std::function<void(size_t, size_t)>& function);
+
+ private:
+  void Work();
+  // Pops and runs one task, if any is queued.
+  bool RunOneTask();
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+};
+
+}  // namespace common
+}  // namespace robot
+
+#endif
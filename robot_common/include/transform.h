@@ -1,16 +1,29 @@
 #ifndef ROBOT_COMMON_TRANSFORM_H_
 #define ROBOT_COMMON_TRANSFORM_H_
 
+#include <cmath>
+#include <type_traits>
+
 #include <Eigen/Dense>
 
+#include "angle.h"
+#include "so3.h"
+
 namespace robot {
 namespace common {
 
+template <typename T>
+class SE2;
+
 template <typename T>
 class SE3 {
  public:
+  using Scalar = T;
   using Translation = Eigen::Matrix<T, 3, 1>;
   using Rotation = Eigen::Quaternion<T>;
+  // Tangent vectors are ordered [translation rho; rotation phi].
+  using Tangent = Eigen::Matrix<T, 6, 1>;
+  using Jacobian = Eigen::Matrix<T, 6, 6>;
   SE3() : translation_(Translation::Zero()), rotation_(Rotation::Identity()) {}
   SE3(const Translation& translation, const Rotation& rotation)
       : translation_(translation), rotation_(rotation) {}
@@ -23,10 +36,34 @@ class SE3 {
     return SE3<F>(translation_.template cast<F>(), rotation_.template cast<F>());
   }
 
-  Translation translation() const { return translation_; }
-  Rotation rotation() const { return rotation_; }
+  const Translation& translation() const { return translation_; }
+  const Rotation& rotation() const { return rotation_; }
+  Translation& translation() { return translation_; }
+  Rotation& rotation() { return rotation_; }
+
+  // Projects onto the ground plane: keeps x, y and the yaw, drops z, roll and pitch.
+  SE2<T> ToSE2() const;
+
+  static SE3 Exp(const Tangent& tangent);
+  Tangent Log() const;
+  // Maps tangent vectors at the identity through this pose: Exp(Adjoint() * xi) equals
+  // (*this) * Exp(xi) * inverse().
+  Jacobian Adjoint() const;
+
+  // Exp(xi + d) ~= Exp(LeftJacobian(xi) * d) * Exp(xi).
+  static Jacobian LeftJacobian(const Tangent& tangent);
+  static Jacobian LeftJacobianInverse(const Tangent& tangent);
+  // Exp(xi + d) ~= Exp(xi) * Exp(RightJacobian(xi) * d).
+  static Jacobian RightJacobian(const Tangent& tangent) { return LeftJacobian(-tangent); }
+  static Jacobian RightJacobianInverse(const Tangent& tangent) {
+    return LeftJacobianInverse(-tangent);
+  }
 
  private:
+  // Off-diagonal block of the SE3 left Jacobian (Barfoot, "State Estimation for Robotics").
+  static Eigen::Matrix<T, 3, 3> LeftJacobianQ(const Translation& rho,
+                                              const Eigen::Matrix<T, 3, 1>& phi);
+
   Translation translation_;
   Rotation rotation_;
 };
@@ -34,8 +71,12 @@ class SE3 {
 template <typename T>
 class SE2 {
  public:
+  using Scalar = T;
   using Translation = Eigen::Matrix<T, 2, 1>;
   using Rotation = Eigen::Rotation2D<T>;
+  // Tangent vectors are ordered [translation rho; rotation theta].
+  using Tangent = Eigen::Matrix<T, 3, 1>;
+  using Jacobian = Eigen::Matrix<T, 3, 3>;
   SE2() : translation_(Translation::Zero()), rotation_(Rotation::Identity()) {}
   SE2(const Translation& translation, const Rotation& rotation)
       : translation_(translation), rotation_(rotation) {}
@@ -44,8 +85,33 @@ class SE2 {
   static SE2 Identity() { return SE2(); }
 
   template <typename F>
-  SE3<F> cast() const {
-    return SE3<F>(translation_.template cast<F>(), rotation_.template cast<F>());
+  SE2<F> cast() const {
+    return SE2<F>(translation_.template cast<F>(), rotation_.template cast<F>());
+  }
+
+  const Translation& translation() const { return translation_; }
+  const Rotation& rotation() const { return rotation_; }
+  Translation& translation() { return translation_; }
+  Rotation& rotation() { return rotation_; }
+
+  // Lifts into 3D at z = 0, building the yaw quaternion directly from the half angle.
+  SE3<T> ToSE3() const {
+    using std::cos;
+    using std::sin;
+    const T half_theta = rotation_.angle() / T(2);
+    return SE3<T>(typename SE3<T>::Translation(translation_.x(), translation_.y(), T(0)),
+                  typename SE3<T>::Rotation(cos(half_theta), T(0), T(0), sin(half_theta)));
+  }
+
+  static SE2 Exp(const Tangent& tangent);
+  Tangent Log() const;
+  Jacobian Adjoint() const;
+
+  static Jacobian LeftJacobian(const Tangent& tangent);
+  static Jacobian LeftJacobianInverse(const Tangent& tangent);
+  static Jacobian RightJacobian(const Tangent& tangent) { return LeftJacobian(-tangent); }
+  static Jacobian RightJacobianInverse(const Tangent& tangent) {
+    return LeftJacobianInverse(-tangent);
   }
 
  private:
@@ -65,16 +131,231 @@ SE2<T> operator*(const SE2<T>& lhs, const SE2<T>& rhs) {
                 lhs.rotation() * rhs.rotation());
 }
 
+template <typename T>
+SE2<T> SE3<T>::ToSE2() const {
+  using std::atan2;
+  const Rotation& q = rotation_;
+  const T yaw = atan2(T(2) * (q.w() * q.z() + q.x() * q.y()),
+                      T(1) - T(2) * (q.y() * q.y() + q.z() * q.z()));
+  return SE2<T>(typename SE2<T>::Translation(translation_.x(), translation_.y()),
+                typename SE2<T>::Rotation(yaw));
+}
+
+template <typename T>
+SE3<T> SE3<T>::Exp(const Tangent& tangent) {
+  const Translation rho = tangent.template head<3>();
+  const Eigen::Matrix<T, 3, 1> phi = tangent.template tail<3>();
+  return SE3(SO3LeftJacobian(phi) * rho, SO3Exp(phi));
+}
+
+template <typename T>
+typename SE3<T>::Tangent SE3<T>::Log() const {
+  const Eigen::Matrix<T, 3, 1> phi = SO3Log(rotation_);
+  const Eigen::Matrix<T, 3, 1> rho = SO3LeftJacobianInverse(phi) * translation_;
+  // Fixed-size halves rather than the comma initializer, whose dynamic-size blocks get a 4-wide
+  // packet path for float that GCC 12 flags with a spurious -Warray-bounds.
+  Tangent tangent;
+  tangent.template head<3>() = rho;
+  tangent.template tail<3>() = phi;
+  return tangent;
+}
+
+template <typename T>
+typename SE3<T>::Jacobian SE3<T>::Adjoint() const {
+  const Eigen::Matrix<T, 3, 3> rotation = rotation_.toRotationMatrix();
+  Jacobian adjoint;
+  adjoint << rotation, Hat(translation_) * rotation, Eigen::Matrix<T, 3, 3>::Zero(), rotation;
+  return adjoint;
+}
+
+template <typename T>
+Eigen::Matrix<T, 3, 3> SE3<T>::LeftJacobianQ(const Translation& rho,
+                                             const Eigen::Matrix<T, 3, 1>& phi) {
+  using std::cos;
+  using std::sin;
+  const T theta_sq = phi.squaredNorm();
+  const T theta = std::sqrt(theta_sq);
+  // The numerators of b and c cancel down to O(theta^4) and O(theta^5), far past the point where
+  // SmallAngleThreshold() suffices for the rotation, so these coefficients switch to their series
+  // later and carry one more term.
+  const T threshold = std::is_same<T, float>::value ? T(0.25) : T(1e-2);
+  T a, b, c;
+  if (theta < threshold) {
+    const T theta_4 = theta_sq * theta_sq;
+    a = T(1) / T(6) - theta_sq / T(120) + theta_4 / T(5040);
+    b = T(1) / T(24) - theta_sq / T(720) + theta_4 / T(40320);
+    c = T(1) / T(120) - theta_sq / T(2520) + theta_4 / T(120960);
+  } else {
+    const T sin_theta = sin(theta);
+    const T cos_theta = cos(theta);
+    a = (theta - sin_theta) / (theta_sq * theta);
+    b = (theta_sq + T(2) * cos_theta - T(2)) / (T(2) * theta_sq * theta_sq);
+    c = (T(2) * theta - T(3) * sin_theta + theta * cos_theta) /
+        (T(2) * theta_sq * theta_sq * theta);
+  }
+  const Eigen::Matrix<T, 3, 3> p = Hat(phi);
+  const Eigen::Matrix<T, 3, 3> r = Hat(rho);
+  const Eigen::Matrix<T, 3, 3> pr = p * r;
+  const Eigen::Matrix<T, 3, 3> rp = r * p;
+  const Eigen::Matrix<T, 3, 3> prp = pr * p;
+  return T(0.5) * r + a * (pr + rp + prp) + b * (p * pr + rp * p - T(3) * prp) +
+         c * (prp * p + p * prp);
+}
+
+template <typename T>
+typename SE3<T>::Jacobian SE3<T>::LeftJacobian(const Tangent& tangent) {
+  const Translation rho = tangent.template head<3>();
+  const Eigen::Matrix<T, 3, 1> phi = tangent.template tail<3>();
+  const Eigen::Matrix<T, 3, 3> so3_jacobian = SO3LeftJacobian(phi);
+  Jacobian jacobian;
+  jacobian << so3_jacobian, LeftJacobianQ(rho, phi), Eigen::Matrix<T, 3, 3>::Zero(),
+      so3_jacobian;
+  return jacobian;
+}
+
+template <typename T>
+typename SE3<T>::Jacobian SE3<T>::LeftJacobianInverse(const Tangent& tangent) {
+  const Translation rho = tangent.template head<3>();
+  const Eigen::Matrix<T, 3, 1> phi = tangent.template tail<3>();
+  const Eigen::Matrix<T, 3, 3> so3_jacobian_inverse = SO3LeftJacobianInverse(phi);
+  Jacobian jacobian;
+  jacobian << so3_jacobian_inverse,
+      -so3_jacobian_inverse * LeftJacobianQ(rho, phi) * so3_jacobian_inverse,
+      Eigen::Matrix<T, 3, 3>::Zero(), so3_jacobian_inverse;
+  return jacobian;
+}
+
+namespace internal {
+
+// Coefficients of the SE2 exponential: sin(theta) / theta, (1 - cos(theta)) / theta,
+// (theta - sin(theta)) / theta^2 and (1 - cos(theta)) / theta^2.
+template <typename T>
+void SE2Coefficients(const T& theta, T* a, T* b, T* c, T* d) {
+  using std::abs;
+  using std::cos;
+  using std::sin;
+  const T theta_sq = theta * theta;
+  if (abs(theta) < SmallAngleThreshold<T>()) {
+    *a = T(1) - theta_sq / T(6);
+    *b = theta * (T(0.5) - theta_sq / T(24));
+    *c = theta * (T(1) / T(6) - theta_sq / T(120));
+    *d = T(0.5) - theta_sq / T(24);
+  } else {
+    const T sin_theta = sin(theta);
+    const T one_minus_cos_theta = T(1) - cos(theta);
+    *a = sin_theta / theta;
+    *b = one_minus_cos_theta / theta;
+    *c = (theta - sin_theta) / theta_sq;
+    *d = one_minus_cos_theta / theta_sq;
+  }
+}
+
+}  // namespace internal
+
+template <typename T>
+SE2<T> SE2<T>::Exp(const Tangent& tangent) {
+  const T theta = tangent.z();
+  T a, b, c, d;
+  internal::SE2Coefficients(theta, &a, &b, &c, &d);
+  return SE2(Translation(a * tangent.x() - b * tangent.y(), b * tangent.x() + a * tangent.y()),
+             Rotation(theta));
+}
+
+template <typename T>
+typename SE2<T>::Tangent SE2<T>::Log() const {
+  using std::abs;
+  using std::cos;
+  using std::sin;
+  const T theta = NormalizeAngle(rotation_.angle());
+  const T half_theta = theta / T(2);
+  // (theta / 2) * cot(theta / 2), the diagonal of the inverse of the exponential's V matrix.
+  const T a = abs(theta) < SmallAngleThreshold<T>()
+                  ? T(1) - theta * theta / T(12)
+                  : half_theta * cos(half_theta) / sin(half_theta);
+  return Tangent(a * translation_.x() + half_theta * translation_.y(),
+                 -half_theta * translation_.x() + a * translation_.y(), theta);
+}
+
+template <typename T>
+typename SE2<T>::Jacobian SE2<T>::Adjoint() const {
+  Jacobian adjoint;
+  adjoint.template topLeftCorner<2, 2>() = rotation_.toRotationMatrix();
+  adjoint(0, 2) = translation_.y();
+  adjoint(1, 2) = -translation_.x();
+  adjoint.template bottomRows<1>() << T(0), T(0), T(1);
+  return adjoint;
+}
+
+template <typename T>
+typename SE2<T>::Jacobian SE2<T>::LeftJacobian(const Tangent& tangent) {
+  const T x = tangent.x();
+  const T y = tangent.y();
+  T a, b, c, d;
+  internal::SE2Coefficients(tangent.z(), &a, &b, &c, &d);
+  Jacobian jacobian;
+  jacobian << a, -b, c * x + d * y, b, a, -d * x + c * y, T(0), T(0), T(1);
+  return jacobian;
+}
+
+template <typename T>
+typename SE2<T>::Jacobian SE2<T>::LeftJacobianInverse(const Tangent& tangent) {
+  const Jacobian jacobian = LeftJacobian(tangent);
+  const Eigen::Matrix<T, 2, 2> v_inverse = jacobian.template topLeftCorner<2, 2>().inverse();
+  Jacobian inverse;
+  inverse.template topLeftCorner<2, 2>() = v_inverse;
+  inverse.template topRightCorner<2, 1>() = -v_inverse * jacobian.template topRightCorner<2, 1>();
+  inverse.template bottomRows<1>() << T(0), T(0), T(1);
+  return inverse;
+}
+
 typedef SE3<double> SE3d;
 typedef SE3<float> SE3f;
 typedef SE2<double> SE2d;
 typedef SE2<float> SE2f;
 
+// The definitions below are inline so hot loops can inline them; the float and double
+// instantiations are also exported from the library (see transform.cc).
+
+// Returns (roll, pitch, yaw) of the ZYX Euler decomposition of `quat`.
 template <typename T>
-Eigen::Matrix<T, 3, 1> EulerFromQuaternion(const Eigen::Quaternion<T>& quat);
+inline Eigen::Matrix<T, 3, 1> EulerFromQuaternion(const Eigen::Quaternion<T>& quat) {
+  using std::abs;
+  using std::asin;
+  using std::atan2;
+  T roll, pitch, yaw;
+
+  T sinr_cosp = T(2) * (quat.w() * quat.x() + quat.y() * quat.z());
+  T cosr_cosp = T(1) - T(2) * (quat.x() * quat.x() + quat.y() * quat.y());
+  roll = atan2(sinr_cosp, cosr_cosp);
+
+  T sinp = T(2) * (quat.w() * quat.y() - quat.z() * quat.x());
+  if (abs(sinp) >= T(1))
+    pitch = sinp < T(0) ? T(-M_PI / 2) : T(M_PI / 2);
+  else
+    pitch = asin(sinp);
+
+  T siny_cosp = T(2) * (quat.w() * quat.z() + quat.x() * quat.y());
+  T cosy_cosp = T(1) - T(2) * (quat.y() * quat.y() + quat.z() * quat.z());
+  yaw = atan2(siny_cosp, cosy_cosp);
 
+  return Eigen::Matrix<T, 3, 1>(roll, pitch, yaw);
+}
+
+// Heading of the rotated x axis. Reads the first column of the rotation matrix straight from
+// the quaternion components instead of rotating UnitX.
 template <typename T>
-T GetYaw(const Eigen::Quaternion<T>& quat);
+inline T GetYaw(const Eigen::Quaternion<T>& quat) {
+  using std::atan2;
+  return atan2(T(2) * (quat.w() * quat.z() + quat.x() * quat.y()),
+               T(1) - T(2) * (quat.y() * quat.y() + quat.z() * quat.z()));
+}
+
+extern template Eigen::Matrix<float, 3, 1> EulerFromQuaternion<float>(
+    const Eigen::Quaternion<float>& quat);
+extern template Eigen::Matrix<double, 3, 1> EulerFromQuaternion<double>(
+    const Eigen::Quaternion<double>& quat);
+extern template float GetYaw<float>(const Eigen::Quaternion<float>& quat);
+extern template double GetYaw<double>(const Eigen::Quaternion<double>& quat);
 
 }  // namespace common
 }  // namespace robot
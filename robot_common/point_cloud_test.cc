@@ -0,0 +1,125 @@
+#include "point_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "thread_pool.h"
+#include "transform.h"
+
+using robot::common::PointArray;
+using robot::common::SE3;
+using robot::common::ThreadPool;
+using robot::common::TransformCloud;
+using robot::common::TransformCloudOptions;
+
+namespace {
+
+// Not a multiple of any vector width or chunk count.
+constexpr size_t kNumPoints = 10007;
+
+template <typename T>
+SE3<T> RandomPose(std::mt19937* rng) {
+  std::uniform_real_distribution<double> uniform(-5., 5.);
+  const Eigen::Vector3d translation(uniform(*rng), uniform(*rng), uniform(*rng));
+  const Eigen::Quaterniond rotation(
+      Eigen::Vector4d(uniform(*rng), uniform(*rng), uniform(*rng), uniform(*rng)).normalized());
+  return SE3<double>(translation, rotation).cast<T>();
+}
+
+template <typename T>
+Eigen::Matrix<T, 3, Eigen::Dynamic> RandomPoints(std::mt19937* rng) {
+  std::uniform_real_distribution<double> uniform(-50., 50.);
+  Eigen::Matrix<T, 3, Eigen::Dynamic> points(3, kNumPoints);
+  for (size_t i = 0; i < kNumPoints; ++i) {
+    points.col(i) = Eigen::Vector3d(uniform(*rng), uniform(*rng), uniform(*rng)).cast<T>();
+  }
+  return points;
+}
+
+template <typename T>
+PointArray<T> ToArray(const Eigen::Matrix<T, 3, Eigen::Dynamic>& points) {
+  PointArray<T> array;
+  for (Eigen::Index i = 0; i < points.cols(); ++i) array.push_back(points.col(i));
+  return array;
+}
+
+// Points are up to ~100 away from the origin.
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 1e-4 : 1e-12;
+}
+
+template <typename T>
+class PointCloudTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(PointCloudTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(PointCloudTest, MatchesPerPointTransform) {
+  using T = TypeParam;
+  std::mt19937 rng(1);
+  const SE3<T> pose = RandomPose<T>(&rng);
+  const Eigen::Matrix<T, 3, Eigen::Dynamic> points = RandomPoints<T>(&rng);
+  ThreadPool thread_pool(3);
+  TransformCloudOptions threaded;
+  threaded.thread_pool = &thread_pool;
+  threaded.min_points_per_chunk = 100;
+
+  for (const TransformCloudOptions& options : {TransformCloudOptions(), threaded}) {
+    Eigen::Matrix<T, 3, Eigen::Dynamic> out;
+    TransformCloud(pose, points, &out, options);
+    PointArray<T> array_out;
+    TransformCloud(pose, ToArray(points), &array_out, options);
+    Eigen::Matrix<T, 3, Eigen::Dynamic> in_place = points;
+    TransformCloud(pose, in_place, &in_place, options);
+    PointArray<T> array_in_place = ToArray(points);
+    TransformCloud(pose, array_in_place, &array_in_place, options);
+
+    ASSERT_EQ(static_cast<size_t>(out.cols()), kNumPoints);
+    ASSERT_EQ(array_out.size(), kNumPoints);
+    for (size_t i = 0; i < kNumPoints; ++i) {
+      const Eigen::Matrix<T, 3, 1> expected =
+          pose.rotation() * points.col(i) + pose.translation();
+      ASSERT_LT((out.col(i) - expected).norm(), Tolerance<T>()) << i;
+      ASSERT_LT((array_out.point(i) - expected).norm(), Tolerance<T>()) << i;
+      ASSERT_LT((in_place.col(i) - expected).norm(), Tolerance<T>()) << i;
+      ASSERT_LT((array_in_place.point(i) - expected).norm(), Tolerance<T>()) << i;
+    }
+  }
+}
+
+TYPED_TEST(PointCloudTest, DeskewMatchesPerPointTransform) {
+  using T = TypeParam;
+  std::mt19937 rng(2);
+  std::vector<SE3<T>> poses;
+  for (int i = 0; i < 37; ++i) poses.push_back(RandomPose<T>(&rng));
+  std::vector<uint32_t> pose_indices(kNumPoints);
+  std::uniform_int_distribution<uint32_t> index(0, poses.size() - 1);
+  for (uint32_t& pose_index : pose_indices) pose_index = index(rng);
+  const Eigen::Matrix<T, 3, Eigen::Dynamic> points = RandomPoints<T>(&rng);
+  ThreadPool thread_pool(3);
+  TransformCloudOptions threaded;
+  threaded.thread_pool = &thread_pool;
+  threaded.min_points_per_chunk = 100;
+
+  for (const TransformCloudOptions& options : {TransformCloudOptions(), threaded}) {
+    Eigen::Matrix<T, 3, Eigen::Dynamic> out = points;
+    TransformCloud(poses, pose_indices, out, &out, options);
+    PointArray<T> array_out;
+    TransformCloud(poses, pose_indices, ToArray(points), &array_out, options);
+
+    ASSERT_EQ(array_out.size(), kNumPoints);
+    for (size_t i = 0; i < kNumPoints; ++i) {
+      const SE3<T>& pose = poses[pose_indices[i]];
+      const Eigen::Matrix<T, 3, 1> expected =
+          pose.rotation() * points.col(i) + pose.translation();
+      ASSERT_LT((out.col(i) - expected).norm(), Tolerance<T>()) << i;
+      ASSERT_LT((array_out.point(i) - expected).norm(), Tolerance<T>()) << i;
+    }
+  }
+}
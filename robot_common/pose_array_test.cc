@@ -0,0 +1,141 @@
+#include "pose_array.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "angle.h"
+#include "transform.h"
+
+using robot::common::SE2;
+using robot::common::SE2Array;
+using robot::common::SE3;
+using robot::common::SE3Array;
+
+namespace {
+
+// 1003 poses, so the batch kernels also run their scalar remainder loops.
+constexpr size_t kNumPoses = 1003;
+
+template <typename T>
+std::vector<SE3<T>> RandomSE3(unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(-10., 10.);
+  std::vector<SE3<T>> poses;
+  for (size_t i = 0; i < kNumPoses; ++i) {
+    const Eigen::Vector3d translation(uniform(rng), uniform(rng), uniform(rng));
+    const Eigen::Quaterniond rotation(
+        Eigen::Vector4d(uniform(rng), uniform(rng), uniform(rng), uniform(rng)).normalized());
+    poses.push_back(SE3<double>(translation, rotation).cast<T>());
+  }
+  return poses;
+}
+
+// Headings span several turns, to exercise the range reduction of the batch sine and cosine.
+template <typename T>
+std::vector<SE2<T>> RandomSE2(unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(-10., 10.);
+  std::vector<SE2<T>> poses;
+  for (size_t i = 0; i < kNumPoses; ++i) {
+    const Eigen::Vector2d translation(uniform(rng), uniform(rng));
+    poses.push_back(SE2<double>(translation, Eigen::Rotation2Dd(uniform(rng))).cast<T>());
+  }
+  return poses;
+}
+
+template <typename Array, typename Pose>
+Array ToArray(const std::vector<Pose>& poses) {
+  Array array;
+  for (const Pose& pose : poses) array.push_back(pose);
+  return array;
+}
+
+// Quaternions q and -q are the same rotation.
+template <typename T>
+void ExpectNear(const SE3<T>& expected, const SE3<T>& actual, double tolerance) {
+  EXPECT_LT((expected.translation() - actual.translation()).norm(), tolerance);
+  EXPECT_LT(expected.rotation().angularDistance(actual.rotation()), tolerance);
+}
+
+template <typename T>
+void ExpectNear(const SE2<T>& expected, const SE2<T>& actual, double tolerance) {
+  EXPECT_LT((expected.translation() - actual.translation()).norm(), tolerance);
+  EXPECT_NEAR(robot::common::NormalizeAngle(double(expected.rotation().angle()) -
+                                            double(actual.rotation().angle())),
+              0., tolerance);
+}
+
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 2e-5 : 1e-12;
+}
+
+template <typename T>
+class PoseArrayTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(PoseArrayTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(PoseArrayTest, ComposeBatchMatchesScalarSE3) {
+  using T = TypeParam;
+  const std::vector<SE3<T>> lhs = RandomSE3<T>(1);
+  const std::vector<SE3<T>> rhs = RandomSE3<T>(2);
+  const SE3Array<T> lhs_array = ToArray<SE3Array<T>>(lhs);
+  SE3Array<T> out;
+  ASSERT_TRUE(ComposeBatch(lhs_array, ToArray<SE3Array<T>>(rhs), &out));
+  ASSERT_EQ(out.size(), kNumPoses);
+  for (size_t i = 0; i < kNumPoses; ++i) ExpectNear(lhs[i] * rhs[i], out.pose(i), Tolerance<T>());
+
+  // In place: out[i] = out[i] * out[i].
+  ASSERT_TRUE(ComposeBatch(lhs_array, lhs_array, &out));
+  ASSERT_TRUE(ComposeBatch(out, out, &out));
+  for (size_t i = 0; i < kNumPoses; ++i) {
+    ExpectNear(lhs[i] * lhs[i] * lhs[i] * lhs[i], out.pose(i), 4 * Tolerance<T>());
+  }
+}
+
+TYPED_TEST(PoseArrayTest, ComposeBatchMatchesScalarSE2) {
+  using T = TypeParam;
+  const std::vector<SE2<T>> lhs = RandomSE2<T>(1);
+  const std::vector<SE2<T>> rhs = RandomSE2<T>(2);
+  SE2Array<T> out = ToArray<SE2Array<T>>(rhs);
+  ASSERT_TRUE(ComposeBatch(ToArray<SE2Array<T>>(lhs), out, &out));
+  ASSERT_EQ(out.size(), kNumPoses);
+  for (size_t i = 0; i < kNumPoses; ++i) ExpectNear(lhs[i] * rhs[i], out.pose(i), Tolerance<T>());
+}
+
+TYPED_TEST(PoseArrayTest, ComposeBatchRejectsMismatchedSizes) {
+  using T = TypeParam;
+  const SE3Array<T> lhs(3);
+  const SE3Array<T> rhs(4);
+  SE3Array<T> out(5);
+  EXPECT_FALSE(ComposeBatch(lhs, rhs, &out));
+  EXPECT_EQ(out.size(), 5u);
+  SE2Array<T> out_2d(5);
+  EXPECT_FALSE(ComposeBatch(SE2Array<T>(3), SE2Array<T>(4), &out_2d));
+  EXPECT_EQ(out_2d.size(), 5u);
+}
+
+TYPED_TEST(PoseArrayTest, ConvertsBetweenSE2AndSE3LikeScalarCode) {
+  using T = TypeParam;
+  const std::vector<SE3<T>> poses_3d = RandomSE3<T>(3);
+  SE2Array<T> projected;
+  ToSE2(ToArray<SE3Array<T>>(poses_3d), &projected);
+  ASSERT_EQ(projected.size(), kNumPoses);
+  for (size_t i = 0; i < kNumPoses; ++i) {
+    ExpectNear(poses_3d[i].ToSE2(), projected.pose(i), Tolerance<T>());
+  }
+
+  const std::vector<SE2<T>> poses_2d = RandomSE2<T>(4);
+  SE3Array<T> lifted;
+  ToSE3(ToArray<SE2Array<T>>(poses_2d), &lifted);
+  ASSERT_EQ(lifted.size(), kNumPoses);
+  for (size_t i = 0; i < kNumPoses; ++i) {
+    ExpectNear(poses_2d[i].ToSE3(), lifted.pose(i), Tolerance<T>());
+  }
+}
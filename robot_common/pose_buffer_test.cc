@@ -0,0 +1,168 @@
+#include "pose_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <type_traits>
+
+using robot::common::PoseBuffer;
+using robot::common::RotationInterpolation;
+using robot::common::SE3;
+
+namespace {
+
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 1e-5 : 1e-12;
+}
+
+// Pose i of a trajectory sampled at t = i: moving along x and yawing 0.2 rad per second, about
+// 11 degrees between samples.
+template <typename T>
+SE3<T> Sample(double t) {
+  return SE3<T>(Eigen::Vector3d(t, 0.5 * t, 0.).cast<T>(),
+                Eigen::Quaterniond(Eigen::AngleAxisd(0.2 * t, Eigen::Vector3d::UnitZ()))
+                    .cast<T>());
+}
+
+template <typename T>
+void PushSamples(int begin, int end, PoseBuffer<SE3<T>>* buffer) {
+  for (int i = begin; i < end; ++i) ASSERT_TRUE(buffer->Push(i, Sample<T>(i)));
+}
+
+template <typename T>
+double Distance(const SE3<T>& a, const SE3<T>& b) {
+  return (a.translation() - b.translation()).norm() + a.rotation().angularDistance(b.rotation());
+}
+
+template <typename T>
+class PoseBufferTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(PoseBufferTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(PoseBufferTest, ExactTimestampsReturnTheStoredPose) {
+  using T = TypeParam;
+  PoseBuffer<SE3<T>> buffer(16);
+  PushSamples<T>(0, 10, &buffer);
+  // The oldest, the binary-searched middle, the second newest and the newest.
+  for (int i = 0; i < 10; ++i) {
+    SE3<T> pose;
+    ASSERT_TRUE(buffer.Lookup(i, &pose)) << i;
+    EXPECT_LT(Distance(pose, Sample<T>(i)), Tolerance<T>()) << i;
+  }
+}
+
+TYPED_TEST(PoseBufferTest, SlerpsBetweenSamples) {
+  using T = TypeParam;
+  PoseBuffer<SE3<T>> buffer(16, RotationInterpolation::kSlerp);
+  PushSamples<T>(0, 10, &buffer);
+  // Slerp follows the constant yaw rate exactly.
+  for (double t : {0.25, 3.5, 7.9, 8.3, 8.999}) {
+    SE3<T> pose;
+    ASSERT_TRUE(buffer.Lookup(t, &pose)) << t;
+    EXPECT_LT(Distance(pose, Sample<T>(t)), 4 * Tolerance<T>()) << t;
+  }
+}
+
+TYPED_TEST(PoseBufferTest, NlerpStaysCloseToSlerp) {
+  using T = TypeParam;
+  PoseBuffer<SE3<T>> slerp(16, RotationInterpolation::kSlerp);
+  PoseBuffer<SE3<T>> nlerp(16, RotationInterpolation::kNlerp);
+  PushSamples<T>(0, 10, &slerp);
+  PushSamples<T>(0, 10, &nlerp);
+  for (double t : {0.25, 3.5, 7.9, 8.3, 8.999}) {
+    SE3<T> slerped, nlerped;
+    ASSERT_TRUE(slerp.Lookup(t, &slerped));
+    ASSERT_TRUE(nlerp.Lookup(t, &nlerped));
+    EXPECT_NEAR(nlerped.rotation().norm(), 1., Tolerance<T>()) << t;
+    EXPECT_LT((nlerped.translation() - slerped.translation()).norm(), Tolerance<T>()) << t;
+    // Under 0.1 degrees apart for samples less than 30 degrees apart, and equal half way.
+    const double angle = nlerped.rotation().angularDistance(slerped.rotation());
+    EXPECT_LT(angle, 0.1 * M_PI / 180) << t;
+    if (t == 3.5) {
+      EXPECT_LT(angle, 4 * Tolerance<T>());
+    }
+  }
+}
+
+// q and -q are the same rotation; both interpolations take the shorter arc between them.
+TYPED_TEST(PoseBufferTest, InterpolatesAlongTheShorterArc) {
+  using T = TypeParam;
+  for (RotationInterpolation interpolation :
+       {RotationInterpolation::kSlerp, RotationInterpolation::kNlerp}) {
+    PoseBuffer<SE3<T>> buffer(4, interpolation);
+    SE3<T> flipped = Sample<T>(1);
+    flipped.rotation().coeffs() = -flipped.rotation().coeffs();
+    ASSERT_TRUE(buffer.Push(0, Sample<T>(0)));
+    ASSERT_TRUE(buffer.Push(1, flipped));
+    SE3<T> pose;
+    ASSERT_TRUE(buffer.Lookup(0.5, &pose));
+    EXPECT_LT(Distance(pose, Sample<T>(0.5)), 4 * Tolerance<T>());
+  }
+}
+
+TYPED_TEST(PoseBufferTest, RejectsLookupsOutsideTheBufferedSpan) {
+  using T = TypeParam;
+  PoseBuffer<SE3<T>> buffer(16);
+  const SE3<T> untouched = Sample<T>(42);
+  SE3<T> pose = untouched;
+  double begin, end;
+  EXPECT_FALSE(buffer.Lookup(0, &pose));
+  EXPECT_FALSE(buffer.TimeSpan(&begin, &end));
+
+  PushSamples<T>(2, 6, &buffer);
+  ASSERT_TRUE(buffer.TimeSpan(&begin, &end));
+  EXPECT_EQ(begin, 2.);
+  EXPECT_EQ(end, 5.);
+  EXPECT_FALSE(buffer.Lookup(std::nextafter(2., 0.), &pose));
+  EXPECT_FALSE(buffer.Lookup(std::nextafter(5., 6.), &pose));
+  EXPECT_FALSE(buffer.Lookup(-1e9, &pose));
+  EXPECT_FALSE(buffer.Lookup(1e9, &pose));
+  EXPECT_EQ(Distance(pose, untouched), 0.);
+}
+
+TYPED_TEST(PoseBufferTest, RejectsPushesNotAfterTheNewest) {
+  using T = TypeParam;
+  PoseBuffer<SE3<T>> buffer(16);
+  PushSamples<T>(0, 3, &buffer);
+  EXPECT_FALSE(buffer.Push(2, Sample<T>(7)));
+  EXPECT_FALSE(buffer.Push(1, Sample<T>(7)));
+  EXPECT_EQ(buffer.size(), 3u);
+  SE3<T> pose;
+  ASSERT_TRUE(buffer.Lookup(2, &pose));
+  EXPECT_LT(Distance(pose, Sample<T>(2)), Tolerance<T>());
+
+  PoseBuffer<SE3<T>> empty(0);
+  EXPECT_FALSE(empty.Push(0, Sample<T>(0)));
+}
+
+TYPED_TEST(PoseBufferTest, EvictsTheOldestAtCapacity) {
+  using T = TypeParam;
+  PoseBuffer<SE3<T>> buffer(4);
+  PushSamples<T>(0, 10, &buffer);
+  EXPECT_EQ(buffer.size(), 4u);
+  EXPECT_EQ(buffer.capacity(), 4u);
+  double begin, end;
+  ASSERT_TRUE(buffer.TimeSpan(&begin, &end));
+  EXPECT_EQ(begin, 6.);
+  EXPECT_EQ(end, 9.);
+
+  SE3<T> pose;
+  EXPECT_FALSE(buffer.Lookup(5.5, &pose));
+  // The ring has wrapped, so these read across the end of the storage.
+  for (double t : {6., 6.5, 7., 7.25, 8.5, 9.}) {
+    ASSERT_TRUE(buffer.Lookup(t, &pose)) << t;
+    EXPECT_LT(Distance(pose, Sample<T>(t)), 4 * Tolerance<T>()) << t;
+  }
+
+  buffer.Clear();
+  EXPECT_EQ(buffer.size(), 0u);
+  EXPECT_FALSE(buffer.Lookup(9, &pose));
+  // Timestamps may restart after a Clear().
+  PushSamples<T>(0, 2, &buffer);
+  ASSERT_TRUE(buffer.Lookup(0.5, &pose));
+  EXPECT_LT(Distance(pose, Sample<T>(0.5)), 4 * Tolerance<T>());
+}
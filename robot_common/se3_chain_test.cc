@@ -0,0 +1,96 @@
+#include "se3_chain.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+using robot::common::Chain;
+using robot::common::SE3;
+
+namespace {
+
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 2e-6 : 1e-14;
+}
+
+template <typename T>
+double Distance(const SE3<T>& a, const SE3<T>& b) {
+  return (a.translation() - b.translation()).norm() + a.rotation().angularDistance(b.rotation());
+}
+
+// Distinct poses with moderate rotations, so that any misordering of the links shows.
+template <typename T>
+std::vector<SE3<T>> Links(int n) {
+  std::vector<SE3<T>> links;
+  for (int i = 0; i < n; ++i) {
+    Eigen::Matrix<double, 6, 1> tangent;
+    tangent << 0.5 + 0.1 * i, -0.3 * i, 0.2, 0.4 * std::sin(i + 1.), 0.3 * std::cos(2. * i),
+        0.25 - 0.05 * i;
+    links.push_back(SE3<double>::Exp(tangent).cast<T>());
+  }
+  return links;
+}
+
+// The eager left fold ((l0 * l1) * l2) * ... the chain must agree with.
+template <typename T>
+SE3<T> LeftFold(const std::vector<SE3<T>>& links) {
+  SE3<T> product = links[0];
+  for (size_t i = 1; i < links.size(); ++i) product = product * links[i];
+  return product;
+}
+
+// Chain(l[0]) * l[1] * ... * l[N - 1].
+template <int N, typename T, typename Chained>
+SE3<T> Compose(const std::vector<SE3<T>>& links, const Chained& chain) {
+  if constexpr (N == 0) {
+    return chain.Evaluate();
+  } else {
+    return Compose<N - 1>(links, chain * links[links.size() - N]);
+  }
+}
+
+template <int N, typename T>
+void ExpectMatchesLeftFold() {
+  const std::vector<SE3<T>> links = Links<T>(N);
+  const SE3<T> chained = Compose<N - 1>(links, Chain(links[0]));
+  // Rounding differs between the pairwise and the left-to-right order; it grows with N.
+  EXPECT_LT(Distance(chained, LeftFold(links)), 4 * N * Tolerance<T>()) << "N = " << N;
+}
+
+template <typename T>
+class SE3ChainTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(SE3ChainTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(SE3ChainTest, PairwiseReductionMatchesLeftFold) {
+  using T = TypeParam;
+  ExpectMatchesLeftFold<1, T>();
+  ExpectMatchesLeftFold<2, T>();
+  ExpectMatchesLeftFold<3, T>();
+  ExpectMatchesLeftFold<5, T>();
+  ExpectMatchesLeftFold<20, T>();
+}
+
+TYPED_TEST(SE3ChainTest, ConvertsImplicitlyToSE3) {
+  using T = TypeParam;
+  const std::vector<SE3<T>> links = Links<T>(3);
+  const SE3<T> pose = Chain(links[0]) * links[1] * links[2];
+  EXPECT_LT(Distance(pose, links[0] * links[1] * links[2]), 12 * Tolerance<T>());
+}
+
+TYPED_TEST(SE3ChainTest, AppliesToPointsLikeTheProduct) {
+  using T = TypeParam;
+  const std::vector<SE3<T>> links = Links<T>(5);
+  const typename SE3<T>::Translation point(T(1.5), T(-0.5), T(2));
+  const SE3<T> product = LeftFold(links);
+  const typename SE3<T>::Translation expected = product.translation() + product.rotation() * point;
+  const typename SE3<T>::Translation actual =
+      Chain(links[0]) * links[1] * links[2] * links[3] * links[4] * point;
+  EXPECT_LT((actual - expected).norm(), 32 * Tolerance<T>());
+}
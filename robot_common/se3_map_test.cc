@@ -0,0 +1,144 @@
+#include "se3_map.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using robot::common::SE3;
+using robot::common::SE3Layout;
+using robot::common::SE3Map;
+using robot::common::SE3PaddedStorage;
+
+namespace {
+
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 2e-6 : 1e-14;
+}
+
+template <typename T>
+SE3<T> Pose(double angle) {
+  Eigen::Matrix<double, 6, 1> tangent;
+  tangent << 0.4, -1.2, 0.7, angle * Eigen::Vector3d(0.3, -0.5, 0.8).normalized();
+  return SE3<double>::Exp(tangent).cast<T>();
+}
+
+template <typename T>
+double Distance(const SE3<T>& a, const SE3<T>& b) {
+  return (a.translation() - b.translation()).norm() + a.rotation().angularDistance(b.rotation());
+}
+
+// A packed [tx, ty, tz, qx, qy, qz, qw] buffer holding `pose`.
+template <typename T>
+std::vector<T> PackedBuffer(const SE3<T>& pose) {
+  return {pose.translation().x(), pose.translation().y(), pose.translation().z(),
+          pose.rotation().x(),    pose.rotation().y(),    pose.rotation().z(),
+          pose.rotation().w()};
+}
+
+template <typename T>
+class SE3MapTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(SE3MapTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(SE3MapTest, PackedViewReadsAndWritesTheBuffer) {
+  using T = TypeParam;
+  const SE3<T> pose = Pose<T>(1.);
+  std::vector<T> buffer = PackedBuffer(pose);
+  SE3Map<T> view(buffer.data());
+  EXPECT_EQ(view.ToSE3().translation(), pose.translation());
+  EXPECT_EQ(view.ToSE3().rotation().coeffs(), pose.rotation().coeffs());
+
+  // No copy is taken: writes through the view land in the buffer, and the view sees writes to it.
+  view.translation().y() = T(5);
+  EXPECT_EQ(buffer[1], T(5));
+  buffer[0] = T(-3);
+  EXPECT_EQ(view.translation().x(), T(-3));
+  view.rotation() = Eigen::Quaternion<T>::Identity();
+  EXPECT_EQ(buffer, (std::vector<T>{T(-3), T(5), pose.translation().z(), 0, 0, 0, 1}));
+}
+
+TYPED_TEST(SE3MapTest, RoundTripsInBothLayouts) {
+  using T = TypeParam;
+  const SE3<T> pose = Pose<T>(2.);
+  std::vector<T> packed(7, T(0));
+  SE3Map<T>(packed.data()) = pose;
+  EXPECT_EQ(packed, PackedBuffer(pose));
+  const SE3<T> from_packed = SE3Map<T>(packed.data());
+  EXPECT_EQ(from_packed.translation(), pose.translation());
+  EXPECT_EQ(from_packed.rotation().coeffs(), pose.rotation().coeffs());
+
+  SE3PaddedStorage<T> padded;
+  padded.data[3] = T(42);
+  padded.map() = pose;
+  const std::vector<T> expected = PackedBuffer(pose);
+  for (int i = 0; i < 3; ++i) EXPECT_EQ(padded.data[i], expected[i]) << i;
+  // The padding is left alone.
+  EXPECT_EQ(padded.data[3], T(42));
+  for (int i = 3; i < 7; ++i) EXPECT_EQ(padded.data[i + 1], expected[i]) << i;
+  const SE3<T> from_padded = padded.map();
+  EXPECT_EQ(from_padded.translation(), pose.translation());
+  EXPECT_EQ(from_padded.rotation().coeffs(), pose.rotation().coeffs());
+}
+
+TYPED_TEST(SE3MapTest, PaddedStorageIsAlignedIdentity) {
+  using T = TypeParam;
+  static_assert(alignof(SE3PaddedStorage<T>) == 32, "");
+  std::vector<SE3PaddedStorage<T>> storage(5);
+  for (const SE3PaddedStorage<T>& element : storage) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(element.data) % 32, 0u);
+    EXPECT_EQ(element.map().ToSE3().translation(), SE3<T>::Translation::Zero());
+    EXPECT_EQ(element.map().ToSE3().rotation().coeffs(), SE3<T>::Rotation::Identity().coeffs());
+    EXPECT_EQ(element.data[3], T(0));
+  }
+}
+
+TYPED_TEST(SE3MapTest, ConstViewReadsConstBuffers) {
+  using T = TypeParam;
+  using ConstPadded = SE3Map<const T, SE3Layout::kPadded>;
+  static_assert(SE3Map<const T>::kIsConst && !SE3Map<T>::kIsConst, "");
+  static_assert(std::is_same<typename SE3Map<const T>::Scalar, T>::value, "");
+  static_assert(
+      std::is_same<decltype(std::declval<const SE3PaddedStorage<T>&>().map()), ConstPadded>::value,
+      "const storage hands out read-only views");
+  const SE3<T> pose = Pose<T>(0.5);
+  const std::vector<T> buffer = PackedBuffer(pose);
+  const SE3Map<const T> view(buffer.data());
+  EXPECT_EQ(view.translation(), pose.translation());
+  EXPECT_LT(Distance(view.inverse(), pose.inverse()), 4 * Tolerance<T>());
+
+  SE3PaddedStorage<T> storage;
+  storage.map() = pose;
+  const SE3PaddedStorage<T>& const_storage = storage;
+  EXPECT_EQ(const_storage.map().ToSE3().translation(), pose.translation());
+}
+
+// Every mixed product and inverse() agree with the same operation on SE3 values.
+TYPED_TEST(SE3MapTest, ComposesAndInvertsLikeSE3) {
+  using T = TypeParam;
+  const SE3<T> a = Pose<T>(1.5);
+  const SE3<T> b = Pose<T>(-2.5);
+  std::vector<T> packed = PackedBuffer(a);
+  SE3PaddedStorage<T> padded;
+  padded.map() = b;
+  const SE3Map<T> a_map(packed.data());
+  const SE3Map<T, SE3Layout::kPadded> b_map = padded.map();
+  const SE3<T> expected = a * b;
+  const double tolerance = 4 * Tolerance<T>();
+
+  EXPECT_LT(Distance(a_map * b_map, expected), tolerance);
+  EXPECT_LT(Distance(b_map * a_map, b * a), tolerance);
+  EXPECT_LT(Distance(a * b_map, expected), tolerance);
+  EXPECT_LT(Distance(a_map * b, expected), tolerance);
+  EXPECT_LT(Distance(SE3Map<const T>(packed.data()) * b_map, expected), tolerance);
+
+  EXPECT_LT(Distance(a_map.inverse(), a.inverse()), tolerance);
+  EXPECT_LT(Distance(b_map.inverse(), b.inverse()), tolerance);
+  EXPECT_LT(Distance(a_map * a_map.inverse(), SE3<T>()), tolerance);
+}
@@ -0,0 +1,128 @@
+#include "so3.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+using robot::common::SmallAngleThreshold;
+using robot::common::SO3Exp;
+using robot::common::SO3LeftJacobian;
+using robot::common::SO3LeftJacobianInverse;
+using robot::common::SO3Log;
+using robot::common::SO3RightJacobian;
+using robot::common::SO3RightJacobianInverse;
+
+namespace {
+
+template <typename T>
+using Vector3 = Eigen::Matrix<T, 3, 1>;
+
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 2e-6 : 1e-14;
+}
+
+// Angles on both sides of the switch to the Taylor expansions, and up to pi.
+template <typename T>
+std::vector<double> TestAngles() {
+  const double threshold = SmallAngleThreshold<T>();
+  return {0.,  1e-9,  0.5 * threshold, 0.999 * threshold, threshold, 1.001 * threshold,
+          0.1, 1.,    2.,              3.,                M_PI - 1e-3};
+}
+
+// Angle-axis vectors of the given angle about a fixed, skewed axis.
+template <typename T>
+Vector3<T> Phi(double angle) {
+  return (angle * Eigen::Vector3d(0.3, -0.5, 0.8).normalized()).cast<T>();
+}
+
+Eigen::Vector3d Unit(int i) { return Eigen::Vector3d::Unit(i); }
+
+template <typename T>
+class SO3Test : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(SO3Test, Scalars);
+
+}  // namespace
+
+TYPED_TEST(SO3Test, ExpMatchesAngleAxis) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const Eigen::Quaterniond expected(Eigen::AngleAxisd(Phi<double>(angle).norm(),
+                                                        Phi<double>(1.)));
+    const Eigen::Quaternion<T> actual = SO3Exp(Phi<T>(angle));
+    EXPECT_NEAR(actual.norm(), 1., Tolerance<T>()) << angle;
+    EXPECT_LT(expected.angularDistance(actual.template cast<double>()), 4 * Tolerance<T>())
+        << angle;
+  }
+}
+
+TYPED_TEST(SO3Test, LogInvertsExp) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const Vector3<T> phi = Phi<T>(angle);
+    EXPECT_LT((SO3Log(SO3Exp(phi)) - phi).norm(), 8 * Tolerance<T>() * std::max(1., angle))
+        << angle;
+  }
+}
+
+TYPED_TEST(SO3Test, LogPicksTheShorterAngleNearPi) {
+  using T = TypeParam;
+  const Vector3<T> axis = Phi<T>(1.);
+  // A half turn has two logarithms; either sign is fine.
+  const Vector3<T> half_turn = SO3Log(Eigen::Quaternion<T>(Eigen::AngleAxis<T>(T(M_PI), axis)));
+  EXPECT_NEAR(half_turn.norm(), M_PI, 4 * Tolerance<T>());
+  EXPECT_NEAR(std::abs(half_turn.dot(axis)), M_PI, 4 * Tolerance<T>());
+  // Past a half turn the logarithm is the shorter rotation the other way round.
+  const Vector3<T> past = SO3Log(SO3Exp(Phi<T>(M_PI + 0.1)));
+  EXPECT_LT((past - Phi<T>(0.1 - M_PI)).norm(), 8 * Tolerance<T>());
+  // q and -q are the same rotation.
+  const Eigen::Quaternion<T> q = SO3Exp(Phi<T>(2.));
+  const Eigen::Quaternion<T> minus_q(-q.w(), -q.x(), -q.y(), -q.z());
+  EXPECT_LT((SO3Log(minus_q) - SO3Log(q)).norm(), 8 * Tolerance<T>());
+}
+
+// Central differences in double of Exp(phi + d) against Exp(J_l d) * Exp(phi) and
+// Exp(phi) * Exp(J_r d); float Jacobians are compared with the double ones.
+TYPED_TEST(SO3Test, JacobiansMatchFiniteDifferences) {
+  using T = TypeParam;
+  const double step = 1e-6;
+  for (double angle : TestAngles<T>()) {
+    const Eigen::Vector3d phi = Phi<double>(angle);
+    const Eigen::Quaterniond exp_phi = SO3Exp(phi);
+    Eigen::Matrix3d left, right;
+    for (int i = 0; i < 3; ++i) {
+      const Eigen::Quaterniond plus = SO3Exp<double>(phi + step * Unit(i));
+      const Eigen::Quaterniond minus = SO3Exp<double>(phi - step * Unit(i));
+      left.col(i) = (SO3Log<double>(plus * exp_phi.inverse()) -
+                     SO3Log<double>(minus * exp_phi.inverse())) /
+                    (2. * step);
+      right.col(i) = (SO3Log<double>(exp_phi.inverse() * plus) -
+                      SO3Log<double>(exp_phi.inverse() * minus)) /
+                     (2. * step);
+    }
+    const Vector3<T> phi_t = phi.cast<T>();
+    const double tolerance = 1e-8 + 8 * Tolerance<T>();
+    EXPECT_LT((SO3LeftJacobian(phi_t).template cast<double>() - left).norm(), tolerance) << angle;
+    EXPECT_LT((SO3RightJacobian(phi_t).template cast<double>() - right).norm(), tolerance)
+        << angle;
+  }
+}
+
+TYPED_TEST(SO3Test, JacobianInversesInvert) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const Vector3<T> phi = Phi<T>(angle);
+    const Eigen::Matrix<T, 3, 3> identity = Eigen::Matrix<T, 3, 3>::Identity();
+    // The inverse Jacobians grow towards theta = 2 pi; at pi they are still small.
+    EXPECT_LT((SO3LeftJacobian(phi) * SO3LeftJacobianInverse(phi) - identity).norm(),
+              16 * Tolerance<T>())
+        << angle;
+    EXPECT_LT((SO3RightJacobian(phi) * SO3RightJacobianInverse(phi) - identity).norm(),
+              16 * Tolerance<T>())
+        << angle;
+  }
+}
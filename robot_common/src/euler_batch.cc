@@ -0,0 +1,170 @@
+#include "euler_batch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fast_math.h"
+#include "simd.h"
+
+namespace robot {
+namespace common {
+namespace {
+
+// Quaternions the array-of-structures entry points convert per pass: they first unpack a chunk
+// into unit-stride buffers of this length on the stack, then run a kernel over those.
+constexpr size_t kChunk = 64;
+
+// The kernels read separate, unit-stride arrays; stride-4 loads of Eigen's (x, y, z, w) layout
+// vectorize poorly, if at all. Only the kFast loops are marked for vectorization: the exact ones
+// call libm.
+template <typename T, bool kFast>
+void Atan2Kernel(const T* ys, const T* xs, size_t size, T* out) {
+  if constexpr (kFast) {
+    ROBOT_SIMD_LOOP
+    for (size_t i = 0; i < size; ++i) out[i] = FastAtan2(ys[i], xs[i]);
+  } else {
+    for (size_t i = 0; i < size; ++i) out[i] = std::atan2(ys[i], xs[i]);
+  }
+}
+
+template <typename T, bool kFast>
+void YawKernel(const T* qw, const T* qx, const T* qy, const T* qz, size_t size, T* yaws) {
+  if constexpr (kFast) {
+    ROBOT_SIMD_LOOP
+    for (size_t i = 0; i < size; ++i) {
+      yaws[i] = FastAtan2(T(2) * (qw[i] * qz[i] + qx[i] * qy[i]),
+                          T(1) - T(2) * (qy[i] * qy[i] + qz[i] * qz[i]));
+    }
+  } else {
+    for (size_t i = 0; i < size; ++i) {
+      yaws[i] = std::atan2(T(2) * (qw[i] * qz[i] + qx[i] * qy[i]),
+                           T(1) - T(2) * (qy[i] * qy[i] + qz[i] * qz[i]));
+    }
+  }
+}
+
+template <typename T, bool kFast>
+void EulerKernel(const T* qw, const T* qx, const T* qy, const T* qz, size_t size, T* rolls,
+                 T* pitches, T* yaws) {
+  if constexpr (kFast) {
+    ROBOT_SIMD_LOOP
+    for (size_t i = 0; i < size; ++i) {
+      const T w = qw[i], x = qx[i], y = qy[i], z = qz[i];
+      rolls[i] = FastAtan2(T(2) * (w * x + y * z), T(1) - T(2) * (x * x + y * y));
+      pitches[i] = FastAsin(T(2) * (w * y - z * x));
+      yaws[i] = FastAtan2(T(2) * (w * z + x * y), T(1) - T(2) * (y * y + z * z));
+    }
+  } else {
+    for (size_t i = 0; i < size; ++i) {
+      const T w = qw[i], x = qx[i], y = qy[i], z = qz[i];
+      const T sinp = T(2) * (w * y - z * x);
+      rolls[i] = std::atan2(T(2) * (w * x + y * z), T(1) - T(2) * (x * x + y * y));
+      pitches[i] =
+          std::abs(sinp) >= T(1) ? std::copysign(T(M_PI / 2), sinp) : std::asin(sinp);
+      yaws[i] = std::atan2(T(2) * (w * z + x * y), T(1) - T(2) * (y * y + z * z));
+    }
+  }
+}
+
+// Copies quats[0, size) into the component buffers, size <= kChunk. Reading the coefficients
+// through a plain pointer lets the copy vectorize as shuffles.
+template <typename T>
+void Deinterleave(const Eigen::Quaternion<T>* quats, size_t size, T* qw, T* qx, T* qy, T* qz) {
+  const T* coeffs = quats->coeffs().data();
+  ROBOT_SIMD_LOOP
+  for (size_t i = 0; i < size; ++i) {
+    qx[i] = coeffs[4 * i];
+    qy[i] = coeffs[4 * i + 1];
+    qz[i] = coeffs[4 * i + 2];
+    qw[i] = coeffs[4 * i + 3];
+  }
+}
+
+// Unpacks only the two atan2 arguments rather than all four components, which halves the
+// traffic through the stack buffers.
+template <typename T, bool kFast>
+void YawFromQuaternions(const Eigen::Quaternion<T>* quats, size_t size, T* yaws) {
+  T ys[kChunk], xs[kChunk];
+  for (size_t begin = 0; begin < size; begin += kChunk) {
+    const size_t n = std::min(kChunk, size - begin);
+    const T* coeffs = quats[begin].coeffs().data();
+    ROBOT_SIMD_LOOP
+    for (size_t i = 0; i < n; ++i) {
+      const T x = coeffs[4 * i], y = coeffs[4 * i + 1], z = coeffs[4 * i + 2];
+      const T w = coeffs[4 * i + 3];
+      ys[i] = T(2) * (w * z + x * y);
+      xs[i] = T(1) - T(2) * (y * y + z * z);
+    }
+    Atan2Kernel<T, kFast>(ys, xs, n, yaws + begin);
+  }
+}
+
+template <typename T, bool kFast>
+void EulerFromQuaternions(const Eigen::Quaternion<T>* quats, size_t size, T* euler) {
+  T qw[kChunk], qx[kChunk], qy[kChunk], qz[kChunk];
+  T rolls[kChunk], pitches[kChunk], yaws[kChunk];
+  for (size_t begin = 0; begin < size; begin += kChunk) {
+    const size_t n = std::min(kChunk, size - begin);
+    Deinterleave(quats + begin, n, qw, qx, qy, qz);
+    EulerKernel<T, kFast>(qw, qx, qy, qz, n, rolls, pitches, yaws);
+    T* columns = euler + 3 * begin;
+    ROBOT_SIMD_LOOP
+    for (size_t i = 0; i < n; ++i) {
+      columns[3 * i] = rolls[i];
+      columns[3 * i + 1] = pitches[i];
+      columns[3 * i + 2] = yaws[i];
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+void GetYawBatch(const Eigen::Quaternion<T>* quats, size_t size, T* yaws,
+                 AngleAccuracy accuracy) {
+  if (accuracy == AngleAccuracy::kFast) {
+    YawFromQuaternions<T, true>(quats, size, yaws);
+  } else {
+    YawFromQuaternions<T, false>(quats, size, yaws);
+  }
+}
+
+template <typename T>
+void GetYawBatch(const SE3Array<T>& poses, T* yaws, AngleAccuracy accuracy) {
+  if (accuracy == AngleAccuracy::kFast) {
+    YawKernel<T, true>(poses.qw(), poses.qx(), poses.qy(), poses.qz(), poses.size(), yaws);
+  } else {
+    YawKernel<T, false>(poses.qw(), poses.qx(), poses.qy(), poses.qz(), poses.size(), yaws);
+  }
+}
+
+template <typename T>
+void EulerFromQuaternionBatch(const Eigen::Quaternion<T>* quats, size_t size,
+                              Eigen::Matrix<T, 3, Eigen::Dynamic>* euler,
+                              AngleAccuracy accuracy) {
+  euler->resize(3, size);
+  if (accuracy == AngleAccuracy::kFast) {
+    EulerFromQuaternions<T, true>(quats, size, euler->data());
+  } else {
+    EulerFromQuaternions<T, false>(quats, size, euler->data());
+  }
+}
+
+template void GetYawBatch<float>(const Eigen::Quaternion<float>* quats, size_t size,
+                                 float* yaws, AngleAccuracy accuracy);
+template void GetYawBatch<double>(const Eigen::Quaternion<double>* quats, size_t size,
+                                  double* yaws, AngleAccuracy accuracy);
+template void GetYawBatch<float>(const SE3Array<float>& poses, float* yaws,
+                                 AngleAccuracy accuracy);
+template void GetYawBatch<double>(const SE3Array<double>& poses, double* yaws,
+                                  AngleAccuracy accuracy);
+template void EulerFromQuaternionBatch<float>(const Eigen::Quaternion<float>* quats, size_t size,
+                                              Eigen::Matrix<float, 3, Eigen::Dynamic>* euler,
+                                              AngleAccuracy accuracy);
+template void EulerFromQuaternionBatch<double>(const Eigen::Quaternion<double>* quats,
+                                               size_t size,
+                                               Eigen::Matrix<double, 3, Eigen::Dynamic>* euler,
+                                               AngleAccuracy accuracy);
+
+}  // namespace common
+}  // namespace robot
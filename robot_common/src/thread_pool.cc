@@ -0,0 +1,89 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace robot {
+namespace common {
+
+ThreadPool::ThreadPool(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+  }
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) threads_.emplace_back([this] { Work(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+void ThreadPool::Work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+bool ThreadPool::RunOneTask() {
+  std::function<void()> task;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (tasks_.empty()) return false;
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+  }
+  task();
+  return true;
+}
+
+void ThreadPool::ParallelFor(size_t size, size_t min_chunk_size,
+                             const std::function<void(size_t, size_t)>& function) {
+  if (size == 0) return;
+  const size_t max_chunks = threads_.size() + 1;
+  const size_t num_chunks =
+      std::min(max_chunks, std::max<size_t>(1, size / std::max<size_t>(1, min_chunk_size)));
+  if (num_chunks == 1) {
+    function(0, size);
+    return;
+  }
+
+  // Chunks differ in length by at most one.
+  auto chunk_begin = [size, num_chunks](size_t chunk) { return chunk * size / num_chunks; };
+  std::mutex done_mutex;
+  std::condition_variable done;
+  // Guarded by done_mutex, which a chunk holds until it has signalled, so the caller cannot
+  // return while a chunk still touches these locals.
+  size_t num_pending = num_chunks - 1;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t chunk = 1; chunk < num_chunks; ++chunk) {
+      tasks_.emplace_back([&, chunk] {
+        function(chunk_begin(chunk), chunk_begin(chunk + 1));
+        std::lock_guard<std::mutex> done_lock(done_mutex);
+        if (--num_pending == 0) done.notify_one();
+      });
+    }
+  }
+  condition_.notify_all();
+  function(0, chunk_begin(1));
+
+  while (RunOneTask()) {
+  }
+  std::unique_lock<std::mutex> lock(done_mutex);
+  done.wait(lock, [&num_pending] { return num_pending == 0; });
+}
+
+}  // namespace common
+}  // namespace robot
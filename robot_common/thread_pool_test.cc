@@ -0,0 +1,81 @@
+#include "thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using robot::common::ThreadPool;
+
+TEST(ThreadPoolTest, ParallelForCoversEveryIndexOnce) {
+  ThreadPool thread_pool(3);
+  EXPECT_EQ(thread_pool.num_threads(), 3);
+  for (size_t size : {0u, 1u, 7u, 100u, 100003u}) {
+    for (size_t min_chunk_size : {0u, 1u, 16u, 1000u}) {
+      std::vector<std::atomic<int>> visits(size);
+      std::atomic<int> num_chunks(0);
+      thread_pool.ParallelFor(size, min_chunk_size, [&](size_t begin, size_t end) {
+        EXPECT_LT(begin, end);
+        ++num_chunks;
+        for (size_t i = begin; i < end; ++i) ++visits[i];
+      });
+      // Every chunk has finished by the time ParallelFor returns.
+      for (size_t i = 0; i < size; ++i) ASSERT_EQ(visits[i].load(), 1) << i;
+      EXPECT_LE(num_chunks.load(), 4);
+      if (size >= 4 * std::max<size_t>(1, min_chunk_size)) {
+        EXPECT_EQ(num_chunks.load(), 4);
+      }
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ChunksMayCallParallelFor) {
+  ThreadPool thread_pool(2);
+  std::atomic<int> total(0);
+  thread_pool.ParallelFor(8, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      thread_pool.ParallelFor(100, 1, [&](size_t inner_begin, size_t inner_end) {
+        total += static_cast<int>(inner_end - inner_begin);
+      });
+    }
+  });
+  EXPECT_EQ(total.load(), 800);
+}
+
+TEST(ThreadPoolTest, SharedByConcurrentCallers) {
+  ThreadPool thread_pool(2);
+  std::atomic<int> total(0);
+  std::vector<std::thread> callers;
+  for (int caller = 0; caller < 4; ++caller) {
+    callers.emplace_back([&] {
+      for (int repeat = 0; repeat < 50; ++repeat) {
+        thread_pool.ParallelFor(1000, 10, [&](size_t begin, size_t end) {
+          total += static_cast<int>(end - begin);
+        });
+      }
+    });
+  }
+  for (std::thread& caller : callers) caller.join();
+  EXPECT_EQ(total.load(), 4 * 50 * 1000);
+}
+
+TEST(ThreadPoolTest, ShutsDownIdleAndAfterWork) {
+  for (int repeat = 0; repeat < 20; ++repeat) {
+    ThreadPool idle(4);
+  }
+  for (int repeat = 0; repeat < 20; ++repeat) {
+    std::atomic<int> total(0);
+    {
+      ThreadPool thread_pool(4);
+      thread_pool.ParallelFor(64, 1, [&](size_t begin, size_t end) {
+        total += static_cast<int>(end - begin);
+      });
+    }
+    EXPECT_EQ(total.load(), 64);
+  }
+  ThreadPool default_threads;
+  EXPECT_GE(default_threads.num_threads(), 1);
+}
@@ -0,0 +1,178 @@
+#include "transform.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+using robot::common::SE2;
+using robot::common::SE3;
+using robot::common::SmallAngleThreshold;
+
+namespace {
+
+template <typename T>
+double Tolerance() {
+  return std::is_same<T, float>::value ? 2e-6 : 1e-14;
+}
+
+// Rotation angles on both sides of the switches to the Taylor expansions, the rotation's and the
+// later one of the SE3 Q block, and up to pi.
+template <typename T>
+std::vector<double> TestAngles() {
+  const double threshold = SmallAngleThreshold<T>();
+  return {0., 1e-9, 0.5 * threshold, 0.999 * threshold, threshold, 1.001 * threshold, 0.1,
+          0.2499, 0.2501, 1., -2., 3., M_PI - 1e-3};
+}
+
+// A tangent vector with a fixed translation part and a rotation of `angle` about a skewed axis.
+template <typename T>
+typename SE3<T>::Tangent SE3Tangent(double angle) {
+  Eigen::Matrix<double, 6, 1> tangent;
+  tangent << 0.4, -1.2, 0.7, angle * Eigen::Vector3d(0.3, -0.5, 0.8).normalized();
+  return tangent.cast<T>();
+}
+
+template <typename T>
+typename SE2<T>::Tangent SE2Tangent(double angle) {
+  return Eigen::Vector3d(0.4, -1.2, angle).cast<T>();
+}
+
+template <typename T>
+double Distance(const SE3<T>& a, const SE3<T>& b) {
+  return (a.translation() - b.translation()).norm() + a.rotation().angularDistance(b.rotation());
+}
+
+template <typename T>
+double Distance(const SE2<T>& a, const SE2<T>& b) {
+  return (a.translation() - b.translation()).norm() +
+         std::abs(robot::common::NormalizeAngle(a.rotation().angle() - b.rotation().angle()));
+}
+
+// Central differences in double of Log(Exp(xi + h e_k) * Exp(xi)^-1) and
+// Log(Exp(xi)^-1 * Exp(xi + h e_k)), column k of the left and of the right Jacobian.
+template <typename Group>
+void FiniteDifferenceJacobians(const typename Group::Tangent& tangent,
+                               typename Group::Jacobian* left, typename Group::Jacobian* right) {
+  using Tangent = typename Group::Tangent;
+  const double step = 1e-6;
+  const Group inverse = Group::Exp(tangent).inverse();
+  for (int k = 0; k < tangent.size(); ++k) {
+    const Group plus = Group::Exp(tangent + step * Tangent::Unit(k));
+    const Group minus = Group::Exp(tangent - step * Tangent::Unit(k));
+    left->col(k) = ((plus * inverse).Log() - (minus * inverse).Log()) / (2. * step);
+    right->col(k) = ((inverse * plus).Log() - (inverse * minus).Log()) / (2. * step);
+  }
+}
+
+template <typename T>
+class TransformTest : public ::testing::Test {};
+using Scalars = ::testing::Types<float, double>;
+TYPED_TEST_SUITE(TransformTest, Scalars);
+
+}  // namespace
+
+TYPED_TEST(TransformTest, SE3LogInvertsExp) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const typename SE3<T>::Tangent tangent = SE3Tangent<T>(angle);
+    EXPECT_LT((SE3<T>::Exp(tangent).Log() - tangent).norm(), 64 * Tolerance<T>()) << angle;
+  }
+}
+
+TYPED_TEST(TransformTest, SE2LogInvertsExp) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const typename SE2<T>::Tangent tangent = SE2Tangent<T>(angle);
+    EXPECT_LT((SE2<T>::Exp(tangent).Log() - tangent).norm(), 64 * Tolerance<T>()) << angle;
+  }
+}
+
+// SE2 embeds in SE3 as rotations about z, and its exponential agrees with SE3's there.
+TYPED_TEST(TransformTest, SE2ExpMatchesSE3) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const typename SE2<T>::Tangent tangent = SE2Tangent<T>(angle);
+    typename SE3<T>::Tangent lifted;
+    lifted << tangent.x(), tangent.y(), T(0), T(0), T(0), tangent.z();
+    EXPECT_LT(Distance(SE2<T>::Exp(tangent).ToSE3(), SE3<T>::Exp(lifted)), 16 * Tolerance<T>())
+        << angle;
+  }
+}
+
+TYPED_TEST(TransformTest, SE3JacobiansMatchFiniteDifferences) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const Eigen::Matrix<double, 6, 1> tangent = SE3Tangent<double>(angle);
+    Eigen::Matrix<double, 6, 6> left, right;
+    FiniteDifferenceJacobians<SE3<double>>(tangent, &left, &right);
+    const typename SE3<T>::Tangent tangent_t = tangent.cast<T>();
+    const double tolerance = 1e-7 + 32 * Tolerance<T>();
+    EXPECT_LT((SE3<T>::LeftJacobian(tangent_t).template cast<double>() - left).norm(), tolerance)
+        << angle;
+    EXPECT_LT((SE3<T>::RightJacobian(tangent_t).template cast<double>() - right).norm(),
+              tolerance)
+        << angle;
+  }
+}
+
+TYPED_TEST(TransformTest, SE2JacobiansMatchFiniteDifferences) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const Eigen::Vector3d tangent = SE2Tangent<double>(angle);
+    Eigen::Matrix3d left, right;
+    FiniteDifferenceJacobians<SE2<double>>(tangent, &left, &right);
+    const typename SE2<T>::Tangent tangent_t = tangent.cast<T>();
+    const double tolerance = 1e-7 + 32 * Tolerance<T>();
+    EXPECT_LT((SE2<T>::LeftJacobian(tangent_t).template cast<double>() - left).norm(), tolerance)
+        << angle;
+    EXPECT_LT((SE2<T>::RightJacobian(tangent_t).template cast<double>() - right).norm(),
+              tolerance)
+        << angle;
+  }
+}
+
+TYPED_TEST(TransformTest, JacobianInversesInvert) {
+  using T = TypeParam;
+  for (double angle : TestAngles<T>()) {
+    const typename SE3<T>::Tangent se3 = SE3Tangent<T>(angle);
+    const typename SE3<T>::Jacobian identity6 = SE3<T>::Jacobian::Identity();
+    EXPECT_LT((SE3<T>::LeftJacobian(se3) * SE3<T>::LeftJacobianInverse(se3) - identity6).norm(),
+              64 * Tolerance<T>())
+        << angle;
+    EXPECT_LT(
+        (SE3<T>::RightJacobian(se3) * SE3<T>::RightJacobianInverse(se3) - identity6).norm(),
+        64 * Tolerance<T>())
+        << angle;
+
+    const typename SE2<T>::Tangent se2 = SE2Tangent<T>(angle);
+    const typename SE2<T>::Jacobian identity3 = SE2<T>::Jacobian::Identity();
+    EXPECT_LT((SE2<T>::LeftJacobian(se2) * SE2<T>::LeftJacobianInverse(se2) - identity3).norm(),
+              64 * Tolerance<T>())
+        << angle;
+    EXPECT_LT(
+        (SE2<T>::RightJacobian(se2) * SE2<T>::RightJacobianInverse(se2) - identity3).norm(),
+        64 * Tolerance<T>())
+        << angle;
+  }
+}
+
+TYPED_TEST(TransformTest, AdjointConjugatesExp) {
+  using T = TypeParam;
+  const SE3<T> pose3 = SE3<T>::Exp(SE3Tangent<T>(2.));
+  const SE2<T> pose2 = SE2<T>::Exp(SE2Tangent<T>(2.));
+  for (double angle : TestAngles<T>()) {
+    const typename SE3<T>::Tangent xi3 = SE3Tangent<T>(angle) / T(3);
+    EXPECT_LT(Distance(SE3<T>::Exp(pose3.Adjoint() * xi3),
+                       pose3 * SE3<T>::Exp(xi3) * pose3.inverse()),
+              32 * Tolerance<T>())
+        << angle;
+    const typename SE2<T>::Tangent xi2 = SE2Tangent<T>(angle) / T(3);
+    EXPECT_LT(Distance(SE2<T>::Exp(pose2.Adjoint() * xi2),
+                       pose2 * SE2<T>::Exp(xi2) * pose2.inverse()),
+              32 * Tolerance<T>())
+        << angle;
+  }
+}
@@ -0,0 +1,24 @@
+// Jet instantiation of robot_common's NormalizeAngle, which the SPA cost functors differentiate.
+// It is tested here because robot_common does not depend on Ceres.
+#include "angle.h"
+
+#include <ceres/jet.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using robot::common::NormalizeAngle;
+
+TEST(NormalizeAngleTest, WrapsJetsWithUnitDerivative) {
+  using Jet = ceres::Jet<double, 2>;
+  for (double angle : {0., 1., M_PI - 1e-9, std::nextafter(M_PI, 0.), M_PI, -M_PI, 3. * M_PI / 2.,
+                       -7.5 * M_PI}) {
+    Jet jet(angle, 0);
+    jet.v[1] = 2.;
+    const Jet normalized = NormalizeAngle(jet);
+    EXPECT_EQ(normalized.a, NormalizeAngle(angle)) << angle;
+    EXPECT_EQ(normalized.v[0], 1.) << angle;
+    EXPECT_EQ(normalized.v[1], 2.) << angle;
+  }
+  EXPECT_EQ(NormalizeAngle(Jet(M_PI, 0)).a, -M_PI);
+}
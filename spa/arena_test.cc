@@ -0,0 +1,89 @@
+#include "arena.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "pose_graph_2d.h"
+#include "synthetic_graph.h"
+
+using robot::spa::Arena;
+
+namespace {
+
+struct Recorder {
+  Recorder(std::vector<int>* destroyed, int id) : destroyed(destroyed), id(id) {}
+  ~Recorder() { destroyed->push_back(id); }
+  std::vector<int>* destroyed;
+  int id;
+};
+
+}  // namespace
+
+TEST(ArenaTest, DestroysObjectsInReverseOrder) {
+  std::vector<int> destroyed;
+  {
+    Arena arena;
+    for (int id = 0; id < 3; ++id) arena.Create<Recorder>(&destroyed, id);
+    arena.Reset();
+    EXPECT_EQ(destroyed, std::vector<int>({2, 1, 0}));
+    arena.Create<Recorder>(&destroyed, 3);
+  }
+  EXPECT_EQ(destroyed, std::vector<int>({2, 1, 0, 3}));
+}
+
+TEST(ArenaTest, AlignsObjects) {
+  Arena arena(100);
+  for (int i = 0; i < 10; ++i) {
+    arena.Create<char>('a');
+    const Eigen::Matrix4d* matrix = arena.Create<Eigen::Matrix4d>(Eigen::Matrix4d::Identity());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(matrix) % alignof(Eigen::Matrix4d), 0u);
+    EXPECT_TRUE(matrix->isIdentity());
+  }
+}
+
+TEST(ArenaTest, RefillsWithoutAllocating) {
+  Arena arena(256);
+  arena.Reserve(1000 * Arena::MaxBytesPerObject<double>());
+  const size_t bytes_allocated = arena.bytes_allocated();
+  for (int pass = 0; pass < 3; ++pass) {
+    for (int i = 0; i < 1000; ++i) arena.Create<double>(i);
+    EXPECT_EQ(arena.bytes_used(), 1000 * sizeof(double));
+    EXPECT_EQ(arena.bytes_allocated(), bytes_allocated);
+    arena.Reset();
+  }
+}
+
+TEST(ArenaTest, PoseGraphSurvivesMovedPoseBlocks) {
+  robot::spa::SyntheticGraphOptions synthetic;
+  synthetic.num_poses = 200;
+  const robot::spa::SyntheticGraph2D graph = robot::spa::GenerateGraph2D(synthetic);
+  robot::spa::PoseGraph2D moved;
+  robot::spa::PoseGraph2D reserved;
+  reserved.Reserve(graph.data.poses.size(), graph.data.constraints.size());
+  for (robot::spa::PoseGraph2D* pose_graph : {&moved, &reserved}) {
+    // Solving halfway through makes the second half of the poses move the pose blocks of the
+    // graph without reserved storage under its live problem.
+    const size_t half = graph.data.poses.size() / 2;
+    for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+      pose_graph->AddPose(i, graph.data.poses[i]);
+      if (i + 1 != half) continue;
+      for (const auto& constraint : graph.data.constraints) {
+        if (static_cast<size_t>(std::max(constraint.source, constraint.target)) < half) {
+          pose_graph->AddConstraint(constraint);
+        }
+      }
+      pose_graph->Solve();
+    }
+    for (const auto& constraint : graph.data.constraints) {
+      if (static_cast<size_t>(std::max(constraint.source, constraint.target)) >= half) {
+        pose_graph->AddConstraint(constraint);
+      }
+    }
+  }
+  const double moved_cost = moved.Solve().summary.final_cost;
+  EXPECT_NEAR(moved_cost, reserved.Solve().summary.final_cost, 1e-6 * moved_cost);
+}
@@ -0,0 +1,168 @@
+#include "background_optimizer.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "synthetic_graph.h"
+
+using robot::spa::BackgroundOptimizer;
+using robot::spa::Constraint;
+using robot::spa::Pose;
+
+TEST(MpscQueueTest, KeepsEachProducersOrder) {
+  constexpr int kNumProducers = 4;
+  constexpr int kNumValues = 20000;
+  robot::spa::MpscQueue<std::pair<int, int>> queue;
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kNumProducers; ++producer) {
+    producers.emplace_back([&queue, producer] {
+      for (int i = 0; i < kNumValues; ++i) queue.Push({producer, i});
+    });
+  }
+  std::vector<std::pair<int, int>> values;
+  while (values.size() < static_cast<size_t>(kNumProducers * kNumValues)) queue.PopAll(&values);
+  for (std::thread& producer : producers) producer.join();
+  EXPECT_TRUE(queue.empty());
+
+  std::vector<int> next(kNumProducers, 0);
+  for (const auto& value : values) EXPECT_EQ(value.second, next[value.first]++);
+}
+
+TEST(DoubleBufferTest, ReadersNeverSeeAPartialWrite) {
+  robot::spa::DoubleBuffer<std::vector<int>> buffer;
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int reader = 0; reader < 3; ++reader) {
+    readers.emplace_back([&] {
+      int last = 0;
+      while (!done.load()) {
+        buffer.Read([&](const std::vector<int>& values) {
+          if (values.empty()) return;
+          for (int value : values) ASSERT_EQ(value, values.front());
+          EXPECT_GE(values.front(), last);
+          last = values.front();
+        });
+      }
+    });
+  }
+  for (int generation = 1; generation <= 2000; ++generation) {
+    buffer.Write([generation](std::vector<int>* values) { values->assign(256, generation); });
+  }
+  done.store(true);
+  for (std::thread& reader : readers) reader.join();
+  EXPECT_EQ(buffer.Read([](const std::vector<int>& values) { return values.front(); }), 2000);
+}
+
+TEST(BackgroundOptimizerTest, SolvesGraphAddedFromSeveralThreads) {
+  robot::spa::SyntheticGraphOptions synthetic;
+  synthetic.num_poses = 200;
+  synthetic.translation_noise = 0.;
+  synthetic.rotation_noise = 0.;
+  const robot::spa::SyntheticGraph2D graph = robot::spa::GenerateGraph2D(synthetic);
+
+  BackgroundOptimizer optimizer;
+  Pose pose;
+  EXPECT_FALSE(optimizer.LookupPose(0, &pose));
+  // Poses and constraints come from different threads, so constraints may reach the worker
+  // before their poses do.
+  std::thread pose_thread([&] {
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0., 0.05);
+    for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+      Pose initial = graph.data.poses[i];
+      if (i > 0) initial.translation += Eigen::Vector2d(noise(rng), noise(rng));
+      optimizer.AddPose(graph.data.pose_ids[i], initial);
+    }
+  });
+  std::thread constraint_thread([&] {
+    for (const Constraint& constraint : graph.data.constraints) optimizer.AddConstraint(constraint);
+  });
+  pose_thread.join();
+  constraint_thread.join();
+  optimizer.Flush();
+
+  EXPECT_GT(optimizer.generation(), 0);
+  optimizer.Read([&](const BackgroundOptimizer::Snapshot& snapshot) {
+    ASSERT_EQ(snapshot.poses.size(), graph.ground_truth.size());
+    EXPECT_TRUE(snapshot.report.summary.IsSolutionUsable());
+  });
+  for (size_t i = 0; i < graph.ground_truth.size(); ++i) {
+    ASSERT_TRUE(optimizer.LookupPose(graph.data.pose_ids[i], &pose));
+    EXPECT_LT((pose.translation - graph.ground_truth[i].translation).norm(), 1e-3) << "pose " << i;
+  }
+}
+
+// Each producer's Flush() must cover its own pose, not just as many poses as it has added.
+TEST(BackgroundOptimizerTest, FlushCoversTheCallersOwnAdditions) {
+  BackgroundOptimizer optimizer;
+  Pose origin;
+  origin.translation.setZero();
+  origin.rotation = Eigen::Rotation2Dd(0.);
+  std::atomic<int> num_missing{0};
+  std::vector<std::thread> producers;
+  for (int thread = 0; thread < 4; ++thread) {
+    producers.emplace_back([&, thread] {
+      for (int i = 0; i < 100; ++i) {
+        const int id = 1000 * thread + i;
+        optimizer.AddPose(id, origin);
+        optimizer.Flush();
+        Pose pose;
+        if (!optimizer.LookupPose(id, &pose)) ++num_missing;
+      }
+    });
+  }
+  for (std::thread& producer : producers) producer.join();
+  EXPECT_EQ(num_missing.load(), 0);
+}
+
+TEST(BackgroundOptimizerTest, ReadsAndAddsDuringSolve) {
+  std::atomic<bool> hold_solve{false}, in_solve{false};
+  BackgroundOptimizer::Options options;
+  options.pose_graph.solver.iteration_callback = [&](const ceres::IterationSummary&) {
+    if (!hold_solve.load()) return true;
+    in_solve.store(true);
+    while (hold_solve.load()) std::this_thread::yield();
+    return true;
+  };
+  BackgroundOptimizer optimizer(options);
+
+  Pose origin;
+  origin.translation.setZero();
+  origin.rotation = Eigen::Rotation2Dd(0.);
+  Constraint step;
+  step.relative_pose.translation = Eigen::Vector2d(1., 0.);
+  step.relative_pose.rotation = Eigen::Rotation2Dd(0.);
+  for (int id = 0; id < 2; ++id) optimizer.AddPose(id, origin);
+  step.source = 0;
+  step.target = 1;
+  optimizer.AddConstraint(step);
+  optimizer.Flush();
+
+  // The next solve stalls until released. Lookups and additions must not wait for it.
+  hold_solve.store(true);
+  optimizer.AddPose(2, origin);
+  step.source = 1;
+  step.target = 2;
+  optimizer.AddConstraint(step);
+  while (!in_solve.load()) std::this_thread::yield();
+  const int64_t generation = optimizer.generation();
+  Pose pose;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(optimizer.LookupPose(1, &pose));
+    EXPECT_NEAR(pose.translation.x(), 1., 1e-6);
+    optimizer.AddPose(100 + i, origin);
+  }
+  EXPECT_EQ(optimizer.generation(), generation);
+  hold_solve.store(false);
+
+  optimizer.Flush();
+  EXPECT_GT(optimizer.generation(), generation);
+  ASSERT_TRUE(optimizer.LookupPose(2, &pose));
+  EXPECT_NEAR(pose.translation.x(), 2., 1e-6);
+  EXPECT_TRUE(optimizer.LookupPose(1099, &pose));
+}
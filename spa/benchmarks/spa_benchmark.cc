@@ -0,0 +1,566 @@
+#include <benchmark/benchmark.h>
+#include <ceres/ceres.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "cost_functors.h"
+#include "g2o_io.h"
+#include "information.h"
+#include "pose_graph_2d.h"
+#include "pose_graph_3d.h"
+#include "snapshot.h"
+#include "submap_pose_graph_2d.h"
+#include "synthetic_graph.h"
+
+namespace {
+
+using robot::spa::Constraint;
+using robot::spa::Pose;
+using robot::spa::PoseGraph2D;
+
+using Graph = robot::spa::PoseGraphData2D;
+using robot::spa::SyntheticGraphOptions;
+
+// Synthetic graph of `num_poses` poses with the generator's default noise. Graphs are cached,
+// keyed by their shape.
+const Graph& GetGraph(int num_poses,
+                      SyntheticGraphOptions::Topology topology =
+                          SyntheticGraphOptions::Topology::kManhattan,
+                      double loop_closure_probability = 0.1) {
+  using Key = std::tuple<int, SyntheticGraphOptions::Topology, double>;
+  static std::map<Key, Graph>* graphs = new std::map<Key, Graph>;
+  const Key key(num_poses, topology, loop_closure_probability);
+  auto it = graphs->find(key);
+  if (it == graphs->end()) {
+    SyntheticGraphOptions options;
+    options.num_poses = num_poses;
+    options.topology = topology;
+    options.loop_closure_probability = loop_closure_probability;
+    it = graphs->emplace(key, robot::spa::GenerateGraph2D(options).data).first;
+  }
+  return it->second;
+}
+
+// Evaluates residuals and all Jacobians of every constraint of a 10k pose graph.
+template <typename MakeCostFunction>
+void EvaluateAll(benchmark::State& state, int num_parameter_blocks,
+                 MakeCostFunction make_cost_function) {
+  const Graph& graph = GetGraph(10000);
+  std::vector<double> blocks;
+  blocks.reserve(3 * graph.poses.size());
+  for (const Pose& pose : graph.poses) {
+    blocks.insert(blocks.end(),
+                  {pose.translation.x(), pose.translation.y(), pose.rotation.angle()});
+  }
+  std::vector<std::unique_ptr<ceres::CostFunction>> cost_functions;
+  std::vector<std::vector<const double*>> parameters;
+  for (const Constraint& constraint : graph.constraints) {
+    cost_functions.emplace_back(make_cost_function(constraint));
+    const double* source = &blocks[3 * constraint.source];
+    const double* target = &blocks[3 * constraint.target];
+    if (num_parameter_blocks == 2) {
+      parameters.push_back({source, target});
+    } else {
+      parameters.push_back({source, source + 1, source + 2, target, target + 1, target + 2});
+    }
+  }
+  double residuals[3];
+  double jacobian_storage[6][9];
+  double* jacobians[6];
+  for (int i = 0; i < 6; ++i) jacobians[i] = jacobian_storage[i];
+  for (auto _ : state) {
+    for (size_t i = 0; i < cost_functions.size(); ++i) {
+      cost_functions[i]->Evaluate(parameters[i].data(), residuals, jacobians);
+    }
+    benchmark::DoNotOptimize(jacobian_storage);
+  }
+  state.SetItemsProcessed(state.iterations() * cost_functions.size());
+}
+
+void BM_EvaluateScalarBlocksAutodiff(benchmark::State& state) {
+  const Eigen::Matrix3d sqrt_information = Eigen::Matrix3d::Identity();
+  EvaluateAll(state, 6, [&](const Constraint& constraint) {
+    return new ceres::AutoDiffCostFunction<robot::spa::SpaCostFunctor, 3, 1, 1, 1, 1, 1, 1>(
+        new robot::spa::SpaCostFunctor(constraint.relative_pose, sqrt_information));
+  });
+}
+BENCHMARK(BM_EvaluateScalarBlocksAutodiff);
+
+void BM_EvaluateScalarBlocksAnalytic(benchmark::State& state) {
+  const Eigen::Matrix3d sqrt_information = Eigen::Matrix3d::Identity();
+  EvaluateAll(state, 6, [&](const Constraint& constraint) {
+    return new robot::spa::SpaCostFunctorAnalytic(constraint.relative_pose, sqrt_information);
+  });
+}
+BENCHMARK(BM_EvaluateScalarBlocksAnalytic);
+
+// Identity information for every constraint, or, unless `diagonal`, one with an x-y
+// correlation. The evaluation benchmarks pick between the two with range(0).
+robot::spa::SqrtInformationTable MakeSqrtInformationTable(const Graph& graph, bool diagonal) {
+  Eigen::Matrix3d information = Eigen::Matrix3d::Identity();
+  if (!diagonal) information(0, 1) = information(1, 0) = 0.1;
+  robot::spa::SqrtInformationTable table;
+  table.reserve(graph.constraints.size());
+  for (size_t i = 0; i < graph.constraints.size(); ++i) table.Add(information);
+  return table;
+}
+
+void BM_EvaluatePoseBlocksAutodiff(benchmark::State& state) {
+  const robot::spa::SqrtInformationTable table =
+      MakeSqrtInformationTable(GetGraph(10000), state.range(0));
+  int index = 0;
+  EvaluateAll(state, 2, [&](const Constraint& constraint) {
+    return new ceres::AutoDiffCostFunction<robot::spa::SpaPoseBlockCostFunctor, 3, 3, 3>(
+        new robot::spa::SpaPoseBlockCostFunctor(constraint.relative_pose, &table, index++));
+  });
+}
+BENCHMARK(BM_EvaluatePoseBlocksAutodiff)->ArgName("diagonal")->Arg(0)->Arg(1);
+
+void BM_EvaluatePoseBlocksAnalytic(benchmark::State& state) {
+  const robot::spa::SqrtInformationTable table =
+      MakeSqrtInformationTable(GetGraph(10000), state.range(0));
+  int index = 0;
+  EvaluateAll(state, 2, [&](const Constraint& constraint) {
+    return new robot::spa::SpaPoseBlockCostFunctorAnalytic(constraint.relative_pose, &table,
+                                                           index++);
+  });
+}
+BENCHMARK(BM_EvaluatePoseBlocksAnalytic)->ArgName("diagonal")->Arg(0)->Arg(1);
+
+// Compile-time specialized analytic functor, on identity information or, per range(0) as
+// above, full, evaluated in double or, if range(1), in float.
+template <typename Scalar>
+ceres::CostFunction* NewFixedCostFunction(const Constraint& constraint,
+                                          const robot::spa::SqrtInformationTable& table,
+                                          int index) {
+  using robot::spa::InformationStructure;
+  if (table.structure(index) == InformationStructure::kIdentity) {
+    return new robot::spa::SpaPoseBlockCostFunctorFixed<InformationStructure::kIdentity, Scalar>(
+        constraint.relative_pose, &table, index);
+  }
+  return new robot::spa::SpaPoseBlockCostFunctorFixed<InformationStructure::kFull, Scalar>(
+      constraint.relative_pose, &table, index);
+}
+
+void BM_EvaluatePoseBlocksFixed(benchmark::State& state) {
+  const robot::spa::SqrtInformationTable table =
+      MakeSqrtInformationTable(GetGraph(10000), state.range(0));
+  int index = 0;
+  EvaluateAll(state, 2, [&](const Constraint& constraint) {
+    return state.range(1) ? NewFixedCostFunction<float>(constraint, table, index++)
+                          : NewFixedCostFunction<double>(constraint, table, index++);
+  });
+}
+BENCHMARK(BM_EvaluatePoseBlocksFixed)
+    ->ArgNames({"diagonal", "float"})
+    ->ArgsProduct({{0, 1}, {0, 1}});
+
+// Full solve with six scalar parameter blocks per pose, as the original spa_test did.
+void BM_SolveScalarBlocks(benchmark::State& state) {
+  const Graph& graph = GetGraph(state.range(0));
+  const Eigen::Matrix3d sqrt_information = Eigen::Matrix3d::Identity();
+  for (auto _ : state) {
+    std::vector<Pose> poses = graph.poses;
+    ceres::Problem problem;
+    for (const Constraint& constraint : graph.constraints) {
+      Pose& source = poses[constraint.source];
+      Pose& target = poses[constraint.target];
+      problem.AddResidualBlock(
+          new robot::spa::SpaCostFunctorAnalytic(constraint.relative_pose, sqrt_information),
+          new ceres::HuberLoss(1.0), &source.translation.x(), &source.translation.y(),
+          &source.rotation.angle(), &target.translation.x(), &target.translation.y(),
+          &target.rotation.angle());
+    }
+    problem.SetParameterBlockConstant(&poses[0].translation.x());
+    problem.SetParameterBlockConstant(&poses[0].translation.y());
+    problem.SetParameterBlockConstant(&poses[0].rotation.angle());
+    ceres::Solver::Options options;
+    options.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
+    ceres::Solver::Summary summary;
+    ceres::Solve(options, &problem, &summary);
+    benchmark::DoNotOptimize(summary.final_cost);
+  }
+}
+BENCHMARK(BM_SolveScalarBlocks)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_SolvePoseBlocks(benchmark::State& state) {
+  const Graph& graph = GetGraph(state.range(0));
+  for (auto _ : state) {
+    PoseGraph2D pose_graph;
+    pose_graph.Reserve(graph.poses.size());
+    for (size_t i = 0; i < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+    for (const Constraint& constraint : graph.constraints) pose_graph.AddConstraint(constraint);
+    const robot::spa::SolveReport report = pose_graph.Solve();
+    benchmark::DoNotOptimize(report.summary.final_cost);
+  }
+}
+BENCHMARK(BM_SolvePoseBlocks)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+// Solves a 50k pose graph with range(0) threads. Real time is reported, since CPU time sums
+// over threads.
+void BM_SolveThreads(benchmark::State& state) {
+  const Graph& graph = GetGraph(50000);
+  PoseGraph2D::Options options;
+  options.solver.num_threads = state.range(0);
+  options.solver.linear_solver_type = static_cast<ceres::LinearSolverType>(state.range(1));
+  options.solver.preconditioner_type = ceres::SCHUR_JACOBI;
+  options.solver.ordering_type = ceres::NESDIS;
+  for (auto _ : state) {
+    PoseGraph2D pose_graph(options);
+    pose_graph.Reserve(graph.poses.size());
+    for (size_t i = 0; i < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+    for (const Constraint& constraint : graph.constraints) pose_graph.AddConstraint(constraint);
+    const robot::spa::SolveReport report = pose_graph.Solve();
+    state.counters["iterations"] = report.summary.iterations.size();
+  }
+}
+BENCHMARK(BM_SolveThreads)
+    ->ArgNames({"threads", "linear_solver"})
+    ->ArgsProduct({{1, 2, 4, 8, 16},
+                   {ceres::SPARSE_NORMAL_CHOLESKY, ceres::SPARSE_SCHUR, ceres::ITERATIVE_SCHUR}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Latency of the solve following one new odometry constraint on an already optimized graph of
+// range(0) poses, in solve mode range(1).
+void BM_SolveAfterNewConstraint(benchmark::State& state) {
+  const Graph& graph = GetGraph(state.range(0) + 1);
+  PoseGraph2D::Options options;
+  options.solve_mode = static_cast<PoseGraph2D::SolveMode>(state.range(1));
+  for (auto _ : state) {
+    state.PauseTiming();
+    PoseGraph2D pose_graph(options);
+    pose_graph.Reserve(graph.poses.size());
+    for (size_t i = 0; i + 1 < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+    for (const Constraint& constraint : graph.constraints) {
+      if (constraint.target + 1 < static_cast<int>(graph.poses.size())) {
+        pose_graph.AddConstraint(constraint);
+      }
+    }
+    pose_graph.Solve(PoseGraph2D::SolveMode::kBatch);
+    pose_graph.AddPose(graph.poses.size() - 1, graph.poses.back());
+    for (const Constraint& constraint : graph.constraints) {
+      if (constraint.target + 1 == static_cast<int>(graph.poses.size())) {
+        pose_graph.AddConstraint(constraint);
+      }
+    }
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(pose_graph.Solve().summary.final_cost);
+  }
+}
+BENCHMARK(BM_SolveAfterNewConstraint)
+    ->ArgNames({"poses", "mode"})
+    ->ArgsProduct({{1000, 10000, 50000},
+                   {static_cast<int>(PoseGraph2D::SolveMode::kBatch),
+                    static_cast<int>(PoseGraph2D::SolveMode::kIncremental),
+                    static_cast<int>(PoseGraph2D::SolveMode::kSlidingWindow)}})
+    ->Unit(benchmark::kMillisecond);
+
+// Solves a 10k pose graph of topology range(0) with a loop closure at range(1) percent of the
+// poses, using cost functor type range(2).
+void BM_SolveSyntheticGraph(benchmark::State& state) {
+  const Graph& graph =
+      GetGraph(10000, static_cast<SyntheticGraphOptions::Topology>(state.range(0)),
+               state.range(1) / 100.);
+  PoseGraph2D::Options options;
+  options.cost_functor_type = static_cast<PoseGraph2D::CostFunctorType>(state.range(2));
+  for (auto _ : state) {
+    PoseGraph2D pose_graph(options);
+    pose_graph.Reserve(graph.poses.size(), graph.constraints.size());
+    for (size_t i = 0; i < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+    for (const Constraint& constraint : graph.constraints) pose_graph.AddConstraint(constraint);
+    const robot::spa::SolveReport report = pose_graph.Solve();
+    state.counters["constraints"] = graph.constraints.size();
+    state.counters["iterations"] = report.summary.iterations.size();
+    state.counters["evaluation_s"] = report.evaluation_time_seconds;
+    state.counters["linear_solver_s"] = report.linear_solver_time_seconds;
+    state.counters["downweighted"] = report.num_downweighted_residuals;
+  }
+}
+BENCHMARK(BM_SolveSyntheticGraph)
+    ->ArgNames({"topology", "loop_percent", "functor"})
+    ->ArgsProduct({{static_cast<int>(SyntheticGraphOptions::Topology::kManhattan),
+                    static_cast<int>(SyntheticGraphOptions::Topology::kRandomWalk)},
+                   {5, 20, 50},
+                   {static_cast<int>(PoseGraph2D::CostFunctorType::kAutodiff),
+                    static_cast<int>(PoseGraph2D::CostFunctorType::kAnalytic)}})
+    ->Unit(benchmark::kMillisecond);
+
+// Builds a graph of range(0) poses and its ceres problem without iterating, with storage and
+// cost function arena reserved up front if range(1).
+void BM_BuildProblem(benchmark::State& state) {
+  const Graph& graph = GetGraph(state.range(0));
+  PoseGraph2D::Options options;
+  options.solver.max_num_iterations = 0;
+  for (auto _ : state) {
+    PoseGraph2D pose_graph(options);
+    if (state.range(1)) pose_graph.Reserve(graph.poses.size(), graph.constraints.size());
+    for (size_t i = 0; i < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+    for (const Constraint& constraint : graph.constraints) pose_graph.AddConstraint(constraint);
+    state.counters["update_s"] = pose_graph.Solve().problem_update_time_seconds;
+  }
+}
+BENCHMARK(BM_BuildProblem)
+    ->ArgNames({"poses", "reserve"})
+    ->ArgsProduct({{100000, 1000000}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+// Solves a graph of range(0) poses with the analytic functors evaluated in precision range(1)
+// and reports how far the result lands from the all-double solution.
+void BM_SolvePrecision(benchmark::State& state) {
+  const Graph& graph = GetGraph(state.range(0));
+  auto solve = [&](robot::spa::EvaluationPrecision precision, std::vector<Pose>* poses) {
+    PoseGraph2D::Options options;
+    options.evaluation_precision = precision;
+    PoseGraph2D pose_graph(options);
+    pose_graph.Reserve(graph.poses.size(), graph.constraints.size());
+    for (size_t i = 0; i < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+    for (const Constraint& constraint : graph.constraints) pose_graph.AddConstraint(constraint);
+    const robot::spa::SolveReport report = pose_graph.Solve();
+    poses->clear();
+    for (size_t i = 0; i < graph.poses.size(); ++i) poses->push_back(pose_graph.pose(i));
+    return report;
+  };
+  std::vector<Pose> reference;
+  const double reference_cost =
+      solve(robot::spa::EvaluationPrecision::kDouble, &reference).summary.final_cost;
+  const auto precision = static_cast<robot::spa::EvaluationPrecision>(state.range(1));
+  std::vector<Pose> poses;
+  for (auto _ : state) {
+    const robot::spa::SolveReport report = solve(precision, &poses);
+    state.counters["evaluation_s"] = report.evaluation_time_seconds;
+    state.counters["cost_ratio"] = report.summary.final_cost / reference_cost;
+  }
+  double max_error = 0.;
+  for (size_t i = 0; i < poses.size(); ++i) {
+    max_error = std::max(max_error, (poses[i].translation - reference[i].translation).norm());
+  }
+  state.counters["max_translation_error"] = max_error;
+}
+BENCHMARK(BM_SolvePrecision)
+    ->ArgNames({"poses", "precision"})
+    ->ArgsProduct({{10000, 100000},
+                   {static_cast<int>(robot::spa::EvaluationPrecision::kDouble),
+                    static_cast<int>(robot::spa::EvaluationPrecision::kFloat)}})
+    ->Unit(benchmark::kMillisecond);
+
+// Two-level solve of a graph of range(0) poses in submaps of range(1) poses.
+void BM_SolveSubmapPoseGraph(benchmark::State& state) {
+  const Graph& graph = GetGraph(state.range(0));
+  robot::spa::SubmapPoseGraph2D::Options options;
+  options.submap_size = state.range(1);
+  for (auto _ : state) {
+    robot::spa::SubmapPoseGraph2D pose_graph(options);
+    for (size_t i = 0; i < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+    for (const Constraint& constraint : graph.constraints) pose_graph.AddConstraint(constraint);
+    const robot::spa::SubmapPoseGraph2D::Report report = pose_graph.Solve();
+    state.counters["submaps"] = report.num_submaps;
+    state.counters["submap_s"] = report.submap_time_seconds;
+    state.counters["coarse_s"] = report.coarse.summary.total_time_in_seconds;
+  }
+}
+BENCHMARK(BM_SolveSubmapPoseGraph)
+    ->ArgNames({"poses", "submap_size"})
+    ->ArgsProduct({{10000, 100000, 1000000}, {50, 200}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Covariance blocks loop closure gating needs on an optimized graph of range(0) poses: the
+// marginals of the latest pose and of 8 candidate partners, and their cross-covariances.
+void BM_ComputeLatestPoseCovariance(benchmark::State& state) {
+  const Graph& graph = GetGraph(state.range(0));
+  PoseGraph2D pose_graph;
+  pose_graph.Reserve(graph.poses.size(), graph.constraints.size());
+  for (size_t i = 0; i < graph.poses.size(); ++i) pose_graph.AddPose(i, graph.poses[i]);
+  for (const Constraint& constraint : graph.constraints) pose_graph.AddConstraint(constraint);
+  pose_graph.Solve();
+
+  const int latest = graph.poses.size() - 1;
+  std::vector<std::pair<int, int>> id_pairs = {{latest, latest}};
+  for (int i = 1; i <= 8; ++i) {
+    const int candidate = latest * i / 9;
+    id_pairs.emplace_back(candidate, candidate);
+    id_pairs.emplace_back(latest, candidate);
+  }
+  std::vector<Eigen::Matrix3d> covariances;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pose_graph.ComputeCovariances(id_pairs, &covariances));
+  }
+}
+BENCHMARK(BM_ComputeLatestPoseCovariance)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond);
+
+const robot::spa::PoseGraphData3D& GetGraph3D(int num_poses) {
+  static std::map<int, robot::spa::PoseGraphData3D>* graphs =
+      new std::map<int, robot::spa::PoseGraphData3D>;
+  auto it = graphs->find(num_poses);
+  if (it == graphs->end()) {
+    SyntheticGraphOptions options;
+    options.num_poses = num_poses;
+    it = graphs->emplace(num_poses, robot::spa::GenerateGraph3D(options).data).first;
+  }
+  return it->second;
+}
+
+// Evaluates residuals and Jacobians of every constraint of a 10k pose 3D graph.
+void BM_EvaluateSE3(benchmark::State& state) {
+  const robot::spa::PoseGraphData3D& graph = GetGraph3D(10000);
+  std::vector<double> blocks(robot::spa::kSE3BlockSize * graph.poses.size());
+  for (size_t i = 0; i < graph.poses.size(); ++i) {
+    robot::spa::SE3ToBlock(robot::spa::ToSE3(graph.poses[i]),
+                           &blocks[robot::spa::kSE3BlockSize * i]);
+  }
+  std::vector<std::unique_ptr<robot::spa::SpaCostFunctorSE3>> cost_functions;
+  for (const robot::spa::Constraint3d& constraint : graph.constraints) {
+    cost_functions.emplace_back(new robot::spa::SpaCostFunctorSE3(
+        robot::spa::ToSE3(constraint.relative_pose),
+        Eigen::Matrix<double, 6, 6>::Identity()));
+  }
+  double residuals[6];
+  double jacobian_storage[2][6 * robot::spa::kSE3BlockSize];
+  double* jacobians[2] = {jacobian_storage[0], jacobian_storage[1]};
+  for (auto _ : state) {
+    for (size_t i = 0; i < cost_functions.size(); ++i) {
+      const robot::spa::Constraint3d& constraint = graph.constraints[i];
+      const double* parameters[2] = {&blocks[robot::spa::kSE3BlockSize * constraint.source],
+                                     &blocks[robot::spa::kSE3BlockSize * constraint.target]};
+      cost_functions[i]->Evaluate(parameters, residuals, jacobians);
+    }
+    benchmark::DoNotOptimize(jacobian_storage);
+  }
+  state.SetItemsProcessed(state.iterations() * cost_functions.size());
+}
+BENCHMARK(BM_EvaluateSE3);
+
+void BM_SolvePoseGraph3D(benchmark::State& state) {
+  const robot::spa::PoseGraphData3D& graph = GetGraph3D(state.range(0));
+  for (auto _ : state) {
+    robot::spa::PoseGraph3D pose_graph;
+    pose_graph.Reserve(graph.poses.size(), graph.constraints.size());
+    for (size_t i = 0; i < graph.poses.size(); ++i) {
+      pose_graph.AddPose(graph.pose_ids[i], robot::spa::ToSE3(graph.poses[i]));
+    }
+    for (const robot::spa::Constraint3d& constraint : graph.constraints) {
+      pose_graph.AddConstraint(constraint);
+    }
+    const robot::spa::SolveReport report = pose_graph.Solve();
+    state.counters["iterations"] = report.summary.iterations.size();
+  }
+}
+BENCHMARK(BM_SolvePoseGraph3D)
+    ->RangeMultiplier(10)
+    ->Range(1000, 100000)
+    ->Unit(benchmark::kMillisecond);
+
+// Writes the range(0)-pose synthetic graph as g2o once and returns its path.
+const std::string& GetG2oFile(int num_poses) {
+  static std::map<int, std::string>* paths = new std::map<int, std::string>;
+  auto it = paths->find(num_poses);
+  if (it == paths->end()) {
+    const std::string path = "/tmp/spa_benchmark_" + std::to_string(num_poses) + ".g2o";
+    robot::spa::WriteG2o(path, GetGraph(num_poses));
+    it = paths->emplace(num_poses, path).first;
+  }
+  return it->second;
+}
+
+void BM_LoadG2o(benchmark::State& state) {
+  const std::string& path = GetG2oFile(state.range(0));
+  for (auto _ : state) {
+    robot::spa::PoseGraphData2D data;
+    robot::spa::LoadG2o(path, &data);
+    benchmark::DoNotOptimize(data.constraints.data());
+  }
+}
+BENCHMARK(BM_LoadG2o)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// The same records read with std::ifstream, as a baseline.
+void BM_LoadG2oIostream(benchmark::State& state) {
+  const std::string& path = GetG2oFile(state.range(0));
+  for (auto _ : state) {
+    robot::spa::PoseGraphData2D data;
+    std::ifstream file(path);
+    std::string tag;
+    while (file >> tag) {
+      if (tag == "VERTEX_SE2") {
+        int id;
+        double x, y, theta;
+        file >> id >> x >> y >> theta;
+        data.pose_ids.push_back(id);
+        data.poses.push_back({Eigen::Vector2d(x, y), Eigen::Rotation2Dd(theta)});
+      } else if (tag == "EDGE_SE2") {
+        Constraint constraint;
+        double x, y, theta, upper[6];
+        file >> constraint.source >> constraint.target >> x >> y >> theta;
+        for (double& value : upper) file >> value;
+        constraint.relative_pose = {Eigen::Vector2d(x, y), Eigen::Rotation2Dd(theta)};
+        constraint.information << upper[0], upper[1], upper[2], upper[1], upper[3], upper[4],
+            upper[2], upper[4], upper[5];
+        data.constraints.push_back(constraint);
+      } else {
+        std::getline(file, tag);
+      }
+    }
+    benchmark::DoNotOptimize(data.constraints.data());
+  }
+}
+BENCHMARK(BM_LoadG2oIostream)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+const std::string& GetSnapshotFile(int num_poses) {
+  static std::map<int, std::string>* paths = new std::map<int, std::string>;
+  auto it = paths->find(num_poses);
+  if (it == paths->end()) {
+    robot::spa::PoseGraphData2D data;
+    robot::spa::LoadG2o(GetG2oFile(num_poses), &data);
+    const std::string path = "/tmp/spa_benchmark_" + std::to_string(num_poses) + ".snapshot";
+    robot::spa::WriteSnapshot(path, data);
+    it = paths->emplace(num_poses, path).first;
+  }
+  return it->second;
+}
+
+// Maps and validates a snapshot, then touches every pose, as a restart that reads it would.
+void BM_OpenSnapshot(benchmark::State& state) {
+  const std::string& path = GetSnapshotFile(state.range(0));
+  for (auto _ : state) {
+    robot::spa::PoseGraphSnapshot snapshot;
+    snapshot.Open(path);
+    double sum = 0.;
+    for (size_t i = 0; i < 3 * snapshot.num_poses(); ++i) sum += snapshot.poses()[i];
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK(BM_OpenSnapshot)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+// Restores a PoseGraph2D from a snapshot, up to the point where it can be solved.
+void BM_RestoreFromSnapshot(benchmark::State& state) {
+  const std::string& path = GetSnapshotFile(state.range(0));
+  for (auto _ : state) {
+    robot::spa::PoseGraphSnapshot snapshot;
+    snapshot.Open(path);
+    PoseGraph2D pose_graph;
+    robot::spa::AddToPoseGraph(snapshot, &pose_graph);
+    benchmark::DoNotOptimize(pose_graph.num_poses());
+  }
+}
+BENCHMARK(BM_RestoreFromSnapshot)->Arg(100000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,176 @@
+#include "distributed_pose_graph.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "pose_graph_2d.h"
+#include "synthetic_graph.h"
+
+using robot::spa::Constraint;
+using robot::spa::DistributedPoseGraph2D;
+using robot::spa::InMemoryTransport;
+using robot::spa::Pose;
+
+namespace {
+
+constexpr int kNumRobots = 3;
+
+// Splits a synthetic trajectory into kNumRobots consecutive pieces, one per robot. The odometry
+// and loop closures across pieces become inter-robot constraints.
+struct Fleet {
+  explicit Fleet(const robot::spa::SyntheticGraph2D& graph,
+                 const DistributedPoseGraph2D::Options& base_options = {}) {
+    const int num_poses = graph.data.poses.size();
+    auto owner = [num_poses](int id) { return id * kNumRobots / num_poses; };
+    for (int robot_id = 0; robot_id < kNumRobots; ++robot_id) {
+      DistributedPoseGraph2D::Options options = base_options;
+      options.anchor = robot_id == 0;
+      graphs.emplace_back(new DistributedPoseGraph2D(robot_id, options, &transport));
+    }
+    for (int id = 0; id < num_poses; ++id) graphs[owner(id)]->AddPose(id, graph.data.poses[id]);
+    for (const Constraint& constraint : graph.data.constraints) {
+      const int source_robot = owner(constraint.source);
+      const int target_robot = owner(constraint.target);
+      if (source_robot == target_robot) {
+        EXPECT_TRUE(graphs[source_robot]->AddConstraint(constraint));
+        continue;
+      }
+      EXPECT_TRUE(graphs[source_robot]->AddInterRobotConstraint(constraint, target_robot));
+      EXPECT_TRUE(graphs[target_robot]->AddInterRobotConstraint(constraint, source_robot));
+      separators.insert(constraint.source);
+      separators.insert(constraint.target);
+    }
+  }
+
+  std::vector<DistributedPoseGraph2D*> pointers() const {
+    std::vector<DistributedPoseGraph2D*> pointers;
+    for (const auto& graph : graphs) pointers.push_back(graph.get());
+    return pointers;
+  }
+
+  InMemoryTransport transport;
+  std::vector<std::unique_ptr<DistributedPoseGraph2D>> graphs;
+  std::set<int> separators;
+};
+
+// Cost of the whole graph at the estimate `pose(id)`, after solving it from there if `solve`.
+double WholeGraphCost(const robot::spa::SyntheticGraph2D& graph,
+                      const std::function<Pose(int)>& pose, bool solve) {
+  robot::spa::PoseGraph2D::Options options;
+  options.solver.max_num_iterations = solve ? 50 : 0;
+  robot::spa::PoseGraph2D central(options);
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) central.AddPose(i, pose(i));
+  for (const Constraint& constraint : graph.data.constraints) central.AddConstraint(constraint);
+  const ceres::Solver::Summary summary = central.Solve().summary;
+  return solve ? summary.final_cost : summary.initial_cost;
+}
+
+// The fleet's estimate of pose `id`, from the robot that owns it.
+Pose FleetPose(const Fleet& fleet, int num_poses, int id) {
+  return fleet.graphs[id * kNumRobots / num_poses]->pose(id);
+}
+
+}  // namespace
+
+TEST(DistributedPoseGraph2DTest, DescendsWholeGraphCostOnNoiseFreeChain) {
+  // Without loop closures the fleet is a chain of robots. Block Gauss-Seidel only converges
+  // slowly there, as a misaligned separator bends each robot's whole piece, but every step
+  // lowers the cost of the whole graph.
+  robot::spa::SyntheticGraphOptions synthetic;
+  synthetic.num_poses = 90;
+  synthetic.loop_closure_probability = 0.;
+  synthetic.translation_noise = 0.;
+  synthetic.rotation_noise = 0.;
+  robot::spa::SyntheticGraph2D graph = robot::spa::GenerateGraph2D(synthetic);
+  std::mt19937 rng(11);
+  std::normal_distribution<double> noise(0., 0.05);
+  for (size_t i = 1; i < graph.data.poses.size(); ++i) {
+    graph.data.poses[i].translation += Eigen::Vector2d(noise(rng), noise(rng));
+  }
+  const int num_poses = graph.data.poses.size();
+
+  // Huber's linear regime would slow the descent on the stiff noise-free constraints.
+  DistributedPoseGraph2D::Options options;
+  options.pose_graph.loss.type = robot::spa::RobustLossOptions::Type::kTrivial;
+  Fleet fleet(graph, options);
+  EXPECT_EQ(fleet.separators.size(), 4u);
+  auto fleet_cost = [&] {
+    return WholeGraphCost(graph, [&](int id) { return FleetPose(fleet, num_poses, id); }, false);
+  };
+  const double initial_cost = fleet_cost();
+  double cost = initial_cost;
+  for (int round = 0; round < 20; ++round) {
+    robot::spa::RunBlockGaussSeidel(fleet.pointers(), 1, 0.);
+    const double next_cost = fleet_cost();
+    EXPECT_LE(next_cost, cost * (1. + 1e-9)) << round;
+    cost = next_cost;
+  }
+  EXPECT_LT(cost, 1e-2 * initial_cost);
+}
+
+TEST(DistributedPoseGraph2DTest, ApproachesCentralizedCostOnNoisyGraph) {
+  robot::spa::SyntheticGraphOptions synthetic;
+  synthetic.num_poses = 300;
+  synthetic.loop_closure_probability = 0.3;
+  const robot::spa::SyntheticGraph2D graph = robot::spa::GenerateGraph2D(synthetic);
+  const int num_poses = graph.data.poses.size();
+  auto odometry = [&](int id) { return graph.data.poses[id]; };
+  const double initial_cost = WholeGraphCost(graph, odometry, false);
+  const double optimal_cost = WholeGraphCost(graph, odometry, true);
+
+  Fleet fleet(graph);
+  ASSERT_FALSE(fleet.separators.empty());
+  const int rounds = robot::spa::RunBlockGaussSeidel(fleet.pointers(), 20, 0.);
+  const double distributed_cost =
+      WholeGraphCost(graph, [&](int id) { return FleetPose(fleet, num_poses, id); }, false);
+  // Most of the way from the odometry to the optimum.
+  EXPECT_LT(distributed_cost - optimal_cost, 0.05 * (initial_cost - optimal_cost));
+
+  // Only separator poses travel, each at most once per round and neighbour.
+  EXPECT_GT(fleet.transport.num_poses_sent(), 0);
+  EXPECT_LE(fleet.transport.num_poses_sent(),
+            static_cast<int64_t>(rounds * fleet.separators.size() * (kNumRobots - 1)));
+}
+
+TEST(DistributedPoseGraph2DTest, RejectsConstraintsWithWrongEnds) {
+  InMemoryTransport transport;
+  DistributedPoseGraph2D graph(0, DistributedPoseGraph2D::Options(), &transport);
+  Pose origin;
+  origin.translation.setZero();
+  origin.rotation = Eigen::Rotation2Dd(0.);
+  graph.AddPose(0, origin);
+  graph.AddPose(1, origin);
+  EXPECT_FALSE(graph.AddPose(1, origin));
+
+  Constraint constraint;
+  constraint.source = 1;
+  constraint.target = 7;
+  constraint.relative_pose.translation = Eigen::Vector2d(1., 2.);
+  constraint.relative_pose.rotation = Eigen::Rotation2Dd(0.5);
+  EXPECT_FALSE(graph.AddConstraint(constraint));
+  // A constraint with invalid information leaves no remote pose behind.
+  constraint.information = -Eigen::Matrix3d::Identity();
+  EXPECT_FALSE(graph.AddInterRobotConstraint(constraint, 1));
+  EXPECT_FALSE(graph.graph().HasPose(7));
+  constraint.information = Eigen::Matrix3d::Identity();
+  ASSERT_TRUE(graph.AddInterRobotConstraint(constraint, 1));
+  EXPECT_FALSE(graph.IsLocalPose(7));
+  EXPECT_TRUE(graph.pose(7).translation.isApprox(Eigen::Vector2d(1., 2.)));
+  // Pose 7 belongs to robot 1, and both ends of 0 -> 1 are local.
+  EXPECT_FALSE(graph.AddInterRobotConstraint(constraint, 2));
+  constraint.target = 0;
+  EXPECT_FALSE(graph.AddInterRobotConstraint(constraint, 1));
+
+  // A remote pose only moves when its owner says so.
+  graph.Step();
+  EXPECT_EQ(transport.num_poses_sent(), 1);
+  transport.Send(0, {2, {{7, origin}}});
+  transport.Send(0, {1, {{7, origin}}});
+  EXPECT_EQ(graph.Step().num_messages_received, 2);
+  EXPECT_TRUE(graph.pose(7).translation.isZero());
+}
@@ -0,0 +1,143 @@
+#include "g2o_io.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+using robot::spa::LoadG2o;
+using robot::spa::PoseGraphData2D;
+using robot::spa::PoseGraphData3D;
+using robot::spa::WriteG2o;
+
+namespace {
+
+std::string WriteFile(const std::string& name, const std::string& contents) {
+  const std::string path = ::testing::TempDir() + name;
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  std::fwrite(contents.data(), 1, contents.size(), file);
+  std::fclose(file);
+  return path;
+}
+
+TEST(G2oIoTest, Loads2DRecords) {
+  const std::string path = WriteFile("graph2d.g2o",
+                                     "# comment\n"
+                                     "VERTEX_SE2 0 0 0 0\n"
+                                     "VERTEX2 1 1.5 -2 0.25\r\n"
+                                     "PARAMS_IGNORED 3 4\n"
+                                     "\n"
+                                     "EDGE_SE2 0 1 1.5 -2 0.25 10 1 2 20 3 30\n"
+                                     "EDGE2 1 0 -1 2 -0.25 10 1 20 30 2 3\n"
+                                     "FIX 0");
+  PoseGraphData2D data;
+  std::string error;
+  ASSERT_TRUE(LoadG2o(path, &data, &error)) << error;
+  ASSERT_EQ(data.poses.size(), 2u);
+  EXPECT_EQ(data.pose_ids[1], 1);
+  EXPECT_EQ(data.poses[1].translation, Eigen::Vector2d(1.5, -2.));
+  EXPECT_EQ(data.poses[1].rotation.angle(), 0.25);
+  ASSERT_EQ(data.constraints.size(), 2u);
+  EXPECT_EQ(data.constraints[0].target, 1);
+  Eigen::Matrix3d information;
+  information << 10, 1, 2, 1, 20, 3, 2, 3, 30;
+  EXPECT_EQ(data.constraints[0].information, information);
+  // The TORO record lists the same matrix in its own order.
+  EXPECT_EQ(data.constraints[1].information, information);
+  ASSERT_EQ(data.fixed_pose_ids.size(), 1u);
+  EXPECT_EQ(data.fixed_pose_ids[0], 0);
+}
+
+TEST(G2oIoTest, RoundTrips2D) {
+  PoseGraphData2D data;
+  data.pose_ids = {4, 7};
+  data.poses = {{Eigen::Vector2d(0.1, 1. / 3.), Eigen::Rotation2Dd(-2.)},
+                {Eigen::Vector2d(1e-17, -5e8), Eigen::Rotation2Dd(3.)}};
+  robot::spa::Constraint constraint;
+  constraint.source = 4;
+  constraint.target = 7;
+  constraint.relative_pose = data.poses[1];
+  constraint.information << 2, 0.5, 0, 0.5, 3, 0.1, 0, 0.1, 4;
+  data.constraints = {constraint};
+  data.fixed_pose_ids = {4};
+  const std::string path = ::testing::TempDir() + "roundtrip2d.g2o";
+  ASSERT_TRUE(WriteG2o(path, data));
+
+  PoseGraphData2D loaded;
+  ASSERT_TRUE(LoadG2o(path, &loaded));
+  EXPECT_EQ(loaded.pose_ids, data.pose_ids);
+  for (size_t i = 0; i < data.poses.size(); ++i) {
+    EXPECT_EQ(loaded.poses[i].translation, data.poses[i].translation);
+    EXPECT_EQ(loaded.poses[i].rotation.angle(), data.poses[i].rotation.angle());
+  }
+  EXPECT_EQ(loaded.constraints[0].information, constraint.information);
+  EXPECT_EQ(loaded.fixed_pose_ids, data.fixed_pose_ids);
+}
+
+TEST(G2oIoTest, RoundTrips3D) {
+  PoseGraphData3D data;
+  data.pose_ids = {0, 1};
+  const Eigen::Quaterniond rotation =
+      Eigen::Quaterniond(Eigen::AngleAxisd(0.3, Eigen::Vector3d(1., 2., 3.).normalized()));
+  data.poses = {{Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity()},
+                {Eigen::Vector3d(1., -2., 0.5), rotation}};
+  robot::spa::Constraint3d constraint;
+  constraint.source = 0;
+  constraint.target = 1;
+  constraint.relative_pose = data.poses[1];
+  constraint.information.diagonal() << 1, 2, 3, 4, 5, 6;
+  constraint.information(0, 5) = constraint.information(5, 0) = 0.25;
+  data.constraints = {constraint};
+  const std::string path = ::testing::TempDir() + "roundtrip3d.g2o";
+  ASSERT_TRUE(WriteG2o(path, data));
+
+  PoseGraphData3D loaded;
+  ASSERT_TRUE(LoadG2o(path, &loaded));
+  ASSERT_EQ(loaded.poses.size(), 2u);
+  EXPECT_EQ(loaded.poses[1].translation, data.poses[1].translation);
+  EXPECT_TRUE(loaded.poses[1].rotation.isApprox(rotation, 1e-15));
+  ASSERT_EQ(loaded.constraints.size(), 1u);
+  EXPECT_EQ(loaded.constraints[0].information, constraint.information);
+}
+
+TEST(G2oIoTest, ReportsErrors) {
+  PoseGraphData2D data;
+  std::string error;
+  EXPECT_FALSE(LoadG2o(::testing::TempDir() + "missing.g2o", &data, &error));
+  EXPECT_FALSE(error.empty());
+
+  const std::string malformed = WriteFile("malformed.g2o", "VERTEX_SE2 0 0 0 0\nEDGE_SE2 0 1 x\n");
+  EXPECT_FALSE(LoadG2o(malformed, &data, &error));
+  EXPECT_NE(error.find(":2: malformed EDGE_SE2"), std::string::npos) << error;
+
+  const std::string three_d = WriteFile("three_d.g2o", "VERTEX_SE3:QUAT 0 0 0 0 0 0 0 1\n");
+  EXPECT_FALSE(LoadG2o(three_d, &data, &error));
+  EXPECT_NE(error.find("unexpected VERTEX_SE3:QUAT"), std::string::npos) << error;
+}
+
+TEST(G2oIoTest, WritesOptimizedPoseGraph) {
+  PoseGraphData2D data;
+  data.pose_ids = {0, 1};
+  data.poses = {{Eigen::Vector2d(0., 0.), Eigen::Rotation2Dd(0.)},
+                {Eigen::Vector2d(0.9, 0.2), Eigen::Rotation2Dd(0.1)}};
+  robot::spa::Constraint constraint;
+  constraint.source = 0;
+  constraint.target = 1;
+  constraint.relative_pose = {Eigen::Vector2d(1., 0.), Eigen::Rotation2Dd(0.)};
+  data.constraints = {constraint};
+
+  robot::spa::PoseGraph2D graph;
+  for (size_t i = 0; i < data.poses.size(); ++i) graph.AddPose(data.pose_ids[i], data.poses[i]);
+  for (const auto& c : data.constraints) graph.AddConstraint(c);
+  graph.Solve();
+  const std::string path = ::testing::TempDir() + "optimized.g2o";
+  ASSERT_TRUE(WriteG2o(path, graph));
+
+  PoseGraphData2D loaded;
+  ASSERT_TRUE(LoadG2o(path, &loaded));
+  EXPECT_NEAR(loaded.poses[1].translation.x(), 1., 1e-6);
+  EXPECT_NEAR(loaded.poses[1].translation.y(), 0., 1e-6);
+  EXPECT_EQ(loaded.fixed_pose_ids, std::vector<int>{0});
+}
+
+}  // namespace
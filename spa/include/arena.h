@@ -0,0 +1,85 @@
+#ifndef SPA_ARENA_H_
+#define SPA_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace robot {
+namespace spa {
+
+// Bump allocator for objects that live as long as the arena, e.g. the cost functions of a pose
+// graph. Create() carves objects out of large blocks instead of one heap allocation each, and
+// the arena destroys them all at once, in reverse order of creation. Reset() destroys them but
+// keeps the blocks, so filling the arena again to the same size allocates nothing. Not thread
+// safe.
+class Arena {
+ public:
+  explicit Arena(size_t block_size = 64 * 1024) : block_size_(block_size) {}
+  ~Arena() { Reset(); }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  template <typename T, typename... Args>
+  T* Create(Args&&... args) {
+    T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+      destructors_ = new (Allocate(sizeof(Destructor), alignof(Destructor)))
+          Destructor{[](void* object) { static_cast<T*>(object)->~T(); }, object, destructors_};
+    }
+    return object;
+  }
+
+  // Upper bound on the bytes one Create<T>() takes, alignment padding included.
+  template <typename T>
+  static constexpr size_t MaxBytesPerObject() {
+    return sizeof(T) + alignof(T) - 1 +
+           (std::is_trivially_destructible<T>::value
+                ? 0
+                : sizeof(Destructor) + alignof(Destructor) - 1);
+  }
+
+  // Makes room for `bytes` more bytes of objects so creating them does not allocate, as long
+  // as no object straddles the end of a block; size it with MaxBytesPerObject().
+  void Reserve(size_t bytes);
+  // Destroys every object and rewinds onto the first block.
+  void Reset();
+
+  // Bytes handed out since the last Reset(), including alignment padding.
+  size_t bytes_used() const { return bytes_used_; }
+  // Bytes of blocks held, used or not.
+  size_t bytes_allocated() const;
+
+ private:
+  struct Block {
+    std::unique_ptr<unsigned char[]> data;
+    size_t size;
+  };
+  // Intrusive list of the destructors to run, itself allocated in the arena.
+  struct Destructor {
+    void (*destroy)(void*);
+    void* object;
+    Destructor* next;
+  };
+
+  void* Allocate(size_t size, size_t alignment);
+  // Returns `offset` rounded up so that block.data + offset is aligned to `alignment`.
+  static size_t AlignedOffset(const Block& block, size_t offset, size_t alignment);
+
+  const size_t block_size_;
+  std::vector<Block> blocks_;
+  // Objects go into blocks_[current_block_] from `offset_` on.
+  size_t current_block_ = 0;
+  size_t offset_ = 0;
+  size_t bytes_used_ = 0;
+  Destructor* destructors_ = nullptr;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
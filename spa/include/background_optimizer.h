@@ -0,0 +1,122 @@
+#ifndef SPA_BACKGROUND_OPTIMIZER_H_
+#define SPA_BACKGROUND_OPTIMIZER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "double_buffer.h"
+#include "mpsc_queue.h"
+#include "pose_graph_2d.h"
+#include "solve_report.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+// Runs PoseGraph2D solves on a worker thread, so the threads building the graph never wait for
+// ceres. Poses and constraints go through a lock-free queue, and every solve publishes an
+// immutable snapshot of the optimized poses that readers look up without locks.
+//
+// The worker drains the queue, solves, publishes and repeats while new data arrives; data
+// queued during a solve goes into the next one. A constraint whose poses have not arrived yet,
+// e.g. because another thread adds them, waits in the worker until they do.
+class BackgroundOptimizer {
+ public:
+  struct Options {
+    PoseGraph2D::Options pose_graph;
+  };
+
+  // The graph after one solve, with poses in the order the graph received them.
+  struct Snapshot {
+    std::vector<int> pose_ids;
+    std::vector<Pose> poses;
+    std::unordered_map<int, int> pose_indices;
+    // Number of snapshots published so far, this one included; 0 before the first.
+    int64_t generation = 0;
+    // Of the latest solve; poses added since then are at their initial estimate.
+    SolveReport report;
+  };
+
+  BackgroundOptimizer();
+  explicit BackgroundOptimizer(const Options& options);
+  // Stops the worker, cutting a solve in progress short at its next iteration. Data still
+  // queued is dropped.
+  ~BackgroundOptimizer();
+
+  BackgroundOptimizer(const BackgroundOptimizer&) = delete;
+  BackgroundOptimizer& operator=(const BackgroundOptimizer&) = delete;
+
+  // Safe to call from any thread; never blocks. As in PoseGraph2D, the first pose the worker
+  // takes anchors the graph, and invalid constraints are dropped.
+  void AddPose(int id, const Pose& pose);
+  void AddConstraint(const Constraint& constraint);
+
+  // Blocks until everything added before the call is in a published snapshot. A constraint
+  // still waiting for its poses counts as flushed: it is in the worker, not yet in the graph.
+  void Flush();
+
+  // Returns reader(const Snapshot&) on the latest snapshot without taking a lock. The snapshot
+  // stays valid until the reader returns; keep readers short, as the worker's next-but-one
+  // publish waits for them.
+  template <typename Reader>
+  auto Read(Reader&& reader) const {
+    return snapshots_.Read(std::forward<Reader>(reader));
+  }
+  // Copies pose `id` from the latest snapshot. Returns false if no snapshot has it yet.
+  bool LookupPose(int id, Pose* pose) const;
+  int64_t generation() const;
+
+ private:
+  // A queued pose or constraint, numbered in the order producers added them.
+  template <typename T>
+  struct Sequenced {
+    uint64_t sequence;
+    T value;
+  };
+
+  void Run();
+  // Adds the popped poses and constraints to the graph. Returns whether any constraint was
+  // added.
+  bool Apply(const std::vector<Sequenced<std::pair<int, Pose>>>& poses,
+             const std::vector<Sequenced<Constraint>>& constraints);
+  void Publish(int64_t generation, const SolveReport& report);
+
+  // Declared before graph_, whose iteration callback reads it.
+  std::atomic<bool> stop_{false};
+  // Only the worker touches graph_, waiting_constraints_ and applied_out_of_order_.
+  PoseGraph2D graph_;
+  std::vector<Constraint> waiting_constraints_;
+  // Sequence numbers the worker has applied past the first one it has not, in a min-heap.
+  std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>
+      applied_out_of_order_;
+  MpscQueue<Sequenced<std::pair<int, Pose>>> pose_queue_;
+  MpscQueue<Sequenced<Constraint>> constraint_queue_;
+  DoubleBuffer<Snapshot> snapshots_;
+  // Hands out the sequence numbers. A producer takes one before its push lands, so the worker
+  // may pop later numbers before earlier ones.
+  std::atomic<uint64_t> num_added_{0};
+  // Producers notify without taking the mutex. The worker's wait times out, so a notification
+  // lost between its check of the queue and its wait only delays it.
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::mutex flush_mutex_;
+  std::condition_variable flushed_;
+  // Poses and constraints 0 up to this sequence number are all in the published snapshot.
+  // Guarded by flush_mutex_.
+  uint64_t num_published_ = 0;
+  // Started last, once everything it uses is constructed.
+  std::thread worker_;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
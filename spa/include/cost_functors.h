@@ -0,0 +1,453 @@
+#ifndef SPA_COST_FUNCTORS_H_
+#define SPA_COST_FUNCTORS_H_
+
+#include <ceres/ceres.h>
+
+#include <Eigen/Dense>
+#include <cmath>
+
+#include "angle.h"
+#include "information.h"
+#include "se3_manifold.h"
+#include "transform.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+class SpaCostFunctor {
+ public:
+  SpaCostFunctor(const Pose& observed, const Eigen::Matrix3d& sqrt_information)
+      : x_(observed.translation.x()),
+        y_(observed.translation.y()),
+        theta_(observed.rotation.angle()),
+        sqrt_information_(sqrt_information) {}
+  ~SpaCostFunctor() {}
+
+  template <typename T>
+  bool operator()(const T* const source_x, const T* const source_y, const T* const source_theta,
+                  const T* const target_x, const T* const target_y, const T* const target_theta,
+                  T* residual) const {
+    const T source_cos = cos(*source_theta);
+    const T source_sin = sin(*source_theta);
+    const T delta_x = *target_x - *source_x;
+    const T delta_y = *target_y - *source_y;
+    Eigen::Map<Eigen::Matrix<T, 3, 1>> residual_map(residual);
+    residual_map(0) = static_cast<T>(x_) - (source_cos * delta_x + source_sin * delta_y);
+    residual_map(1) = static_cast<T>(y_) - (source_cos * delta_y - source_sin * delta_x);
+    residual_map(2) =
+        common::NormalizeAngle(static_cast<T>(theta_) - (*target_theta - *source_theta));
+    residual_map = sqrt_information_.template cast<T>() * residual_map;
+    return true;
+  }
+
+ private:
+  const double x_;
+  const double y_;
+  const double theta_;
+  const Eigen::Matrix3d sqrt_information_;
+};
+
+class SpaCostFunctorAnalytic : public ceres::SizedCostFunction<3, 1, 1, 1, 1, 1, 1> {
+ public:
+  SpaCostFunctorAnalytic(const Pose& observed, const Eigen::Matrix3d& sqrt_information)
+      : x_(observed.translation.x()),
+        y_(observed.translation.y()),
+        theta_(observed.rotation.angle()),
+        sqrt_information_(sqrt_information) {}
+  virtual ~SpaCostFunctorAnalytic() {}
+
+  bool Evaluate(const double* const* parameters, double* residuals, double** jacobians) const {
+    const double cos_source_theta = cos(parameters[2][0]);
+    const double sin_source_theta = sin(parameters[2][0]);
+    const double dx = parameters[3][0] - parameters[0][0];
+    const double dy = parameters[4][0] - parameters[1][0];
+
+    Eigen::Map<Eigen::Vector3d> residual_map(residuals);
+    residual_map(0) = x_ - (cos_source_theta * dx + sin_source_theta * dy);
+    residual_map(1) = y_ - (cos_source_theta * dy - sin_source_theta * dx);
+    residual_map(2) = common::NormalizeAngle(theta_ - (parameters[5][0] - parameters[2][0]));
+    residual_map = sqrt_information_ * residual_map;
+
+    if (!jacobians) return true;
+
+    double* jacobian_source_x = jacobians[0];
+    double* jacobian_source_y = jacobians[1];
+    double* jacobian_source_theta = jacobians[2];
+    double* jacobian_target_x = jacobians[3];
+    double* jacobian_target_y = jacobians[4];
+    double* jacobian_target_theta = jacobians[5];
+
+    // Some sub-expressions
+    const double unweighted_jacobians_02 = sin_source_theta * dx - cos_source_theta * dy;
+    const double unweighted_jacobians_12 = cos_source_theta * dx + sin_source_theta * dy;
+    const double cos_source_theta_00 = sqrt_information_(0, 0) * cos_source_theta;
+    const double cos_source_theta_10 = sqrt_information_(1, 0) * cos_source_theta;
+    const double cos_source_theta_20 = sqrt_information_(2, 0) * cos_source_theta;
+    const double cos_source_theta_01 = sqrt_information_(0, 1) * cos_source_theta;
+    const double cos_source_theta_11 = sqrt_information_(1, 1) * cos_source_theta;
+    const double cos_source_theta_21 = sqrt_information_(2, 1) * cos_source_theta;
+    const double sin_source_theta_00 = sqrt_information_(0, 0) * sin_source_theta;
+    const double sin_source_theta_01 = sqrt_information_(0, 1) * sin_source_theta;
+    const double sin_source_theta_10 = sqrt_information_(1, 0) * sin_source_theta;
+    const double sin_source_theta_11 = sqrt_information_(1, 1) * sin_source_theta;
+    const double sin_source_theta_20 = sqrt_information_(2, 0) * sin_source_theta;
+    const double sin_source_theta_21 = sqrt_information_(2, 1) * sin_source_theta;
+
+    if (jacobian_source_x) {
+      jacobian_source_x[0] = cos_source_theta_00 - sin_source_theta_01;
+      jacobian_source_x[1] = cos_source_theta_10 - sin_source_theta_11;
+      jacobian_source_x[2] = cos_source_theta_20 - sin_source_theta_21;
+    }
+    if (jacobian_source_y) {
+      jacobian_source_y[0] = sin_source_theta_00 + cos_source_theta_01;
+      jacobian_source_y[1] = sin_source_theta_10 + cos_source_theta_11;
+      jacobian_source_y[2] = sin_source_theta_20 + cos_source_theta_21;
+    }
+    if (jacobian_source_theta) {
+      jacobian_source_theta[0] = sqrt_information_(0, 0) * unweighted_jacobians_02 +
+                                 sqrt_information_(0, 1) * unweighted_jacobians_12 +
+                                 sqrt_information_(0, 2);
+      jacobian_source_theta[1] = sqrt_information_(1, 0) * unweighted_jacobians_02 +
+                                 sqrt_information_(1, 1) * unweighted_jacobians_12 +
+                                 sqrt_information_(1, 2);
+      jacobian_source_theta[2] = sqrt_information_(2, 0) * unweighted_jacobians_02 +
+                                 sqrt_information_(2, 1) * unweighted_jacobians_12 +
+                                 sqrt_information_(2, 2);
+    }
+    if (jacobian_target_x) {
+      if (jacobian_source_x) {
+        jacobian_target_x[0] = -jacobian_source_x[0];
+        jacobian_target_x[1] = -jacobian_source_x[1];
+        jacobian_target_x[2] = -jacobian_source_x[2];
+      } else {
+        jacobian_target_x[0] = sin_source_theta_01 - cos_source_theta_00;
+        jacobian_target_x[1] = sin_source_theta_11 - cos_source_theta_10;
+        jacobian_target_x[2] = sin_source_theta_21 - cos_source_theta_20;
+      }
+    }
+    if (jacobian_target_y) {
+      if (jacobian_source_y) {
+        jacobian_target_y[0] = -jacobian_source_y[0];
+        jacobian_target_y[1] = -jacobian_source_y[1];
+        jacobian_target_y[2] = -jacobian_source_y[2];
+      } else {
+        jacobian_target_y[0] = -sin_source_theta_00 - cos_source_theta_01;
+        jacobian_target_y[1] = -sin_source_theta_10 - cos_source_theta_11;
+        jacobian_target_y[2] = -sin_source_theta_20 - cos_source_theta_21;
+      }
+    }
+    if (jacobian_target_theta) {
+      jacobian_target_theta[0] = -sqrt_information_(0, 2);
+      jacobian_target_theta[1] = -sqrt_information_(1, 2);
+      jacobian_target_theta[2] = -sqrt_information_(2, 2);
+    }
+    return true;
+  }
+
+ private:
+  const double x_;
+  const double y_;
+  const double theta_;
+  const Eigen::Matrix3d sqrt_information_;
+};
+
+// Same residual as SpaCostFunctor, over a single [x, y, theta] parameter block per pose. The
+// square root information is entry `index` of `sqrt_information`, which must outlive the
+// functor. Diagonal entries scale the residual instead of multiplying it by a 3x3 matrix.
+class SpaPoseBlockCostFunctor {
+ public:
+  SpaPoseBlockCostFunctor(const Pose& observed, const SqrtInformationTable* sqrt_information,
+                          int index)
+      : x_(observed.translation.x()),
+        y_(observed.translation.y()),
+        theta_(observed.rotation.angle()),
+        sqrt_information_(sqrt_information),
+        index_(index) {}
+
+  template <typename T>
+  bool operator()(const T* const source, const T* const target, T* residual) const {
+    const T source_cos = cos(source[2]);
+    const T source_sin = sin(source[2]);
+    const T delta_x = target[0] - source[0];
+    const T delta_y = target[1] - source[1];
+    Eigen::Map<Eigen::Matrix<T, 3, 1>> residual_map(residual);
+    residual_map(0) = static_cast<T>(x_) - (source_cos * delta_x + source_sin * delta_y);
+    residual_map(1) = static_cast<T>(y_) - (source_cos * delta_y - source_sin * delta_x);
+    residual_map(2) = common::NormalizeAngle(static_cast<T>(theta_) - (target[2] - source[2]));
+    const Eigen::Map<const Eigen::Matrix3d> sqrt_information =
+        sqrt_information_->sqrt_information(index_);
+    if (sqrt_information_->is_diagonal(index_)) {
+      residual_map = residual_map.cwiseProduct(sqrt_information.diagonal().template cast<T>());
+    } else {
+      residual_map = sqrt_information.template cast<T>() * residual_map;
+    }
+    return true;
+  }
+
+ private:
+  const double x_;
+  const double y_;
+  const double theta_;
+  const SqrtInformationTable* const sqrt_information_;
+  const int index_;
+};
+
+// Analytic counterpart of SpaPoseBlockCostFunctor. Ceres sees two 3-dimensional parameter
+// blocks per residual instead of six scalar ones.
+class SpaPoseBlockCostFunctorAnalytic : public ceres::SizedCostFunction<3, 3, 3> {
+ public:
+  SpaPoseBlockCostFunctorAnalytic(const Pose& observed,
+                                  const SqrtInformationTable* sqrt_information, int index)
+      : x_(observed.translation.x()),
+        y_(observed.translation.y()),
+        theta_(observed.rotation.angle()),
+        sqrt_information_(sqrt_information),
+        index_(index) {}
+  virtual ~SpaPoseBlockCostFunctorAnalytic() {}
+
+  bool Evaluate(const double* const* parameters, double* residuals, double** jacobians) const {
+    const double* source = parameters[0];
+    const double* target = parameters[1];
+    const double cos_source_theta = cos(source[2]);
+    const double sin_source_theta = sin(source[2]);
+    const double dx = target[0] - source[0];
+    const double dy = target[1] - source[1];
+
+    Eigen::Map<Eigen::Vector3d> residual_map(residuals);
+    residual_map(0) = x_ - (cos_source_theta * dx + sin_source_theta * dy);
+    residual_map(1) = y_ - (cos_source_theta * dy - sin_source_theta * dx);
+    residual_map(2) = common::NormalizeAngle(theta_ - (target[2] - source[2]));
+    const Eigen::Map<const Eigen::Matrix3d> sqrt_information =
+        sqrt_information_->sqrt_information(index_);
+    const bool is_diagonal = sqrt_information_->is_diagonal(index_);
+    if (is_diagonal) {
+      residual_map = residual_map.cwiseProduct(sqrt_information.diagonal());
+    } else {
+      residual_map = sqrt_information * residual_map;
+    }
+
+    if (!jacobians) return true;
+
+    // Unweighted derivative of the residual with respect to the source pose; the derivative
+    // with respect to the target is its negation in the translation columns and -e_theta in
+    // the rotation column.
+    Eigen::Matrix3d unweighted_source;
+    unweighted_source << cos_source_theta, sin_source_theta,
+        sin_source_theta * dx - cos_source_theta * dy, -sin_source_theta, cos_source_theta,
+        cos_source_theta * dx + sin_source_theta * dy, 0., 0., 1.;
+    const Eigen::Matrix3d jacobian_source =
+        is_diagonal ? Eigen::Matrix3d(sqrt_information.diagonal().asDiagonal() * unweighted_source)
+                    : Eigen::Matrix3d(sqrt_information * unweighted_source);
+
+    if (jacobians[0]) {
+      Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jacobian_source_map(jacobians[0]);
+      jacobian_source_map = jacobian_source;
+    }
+    if (jacobians[1]) {
+      Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor>> jacobian_target(jacobians[1]);
+      jacobian_target.leftCols<2>() = -jacobian_source.leftCols<2>();
+      jacobian_target.col(2) = -sqrt_information.col(2);
+    }
+    return true;
+  }
+
+ private:
+  const double x_;
+  const double y_;
+  const double theta_;
+  const SqrtInformationTable* const sqrt_information_;
+  const int index_;
+};
+
+// SpaPoseBlockCostFunctorAnalytic specialized at compile time on the structure of the square
+// root information, which must be `kStructure` for entry `index` of `sqrt_information`, and on
+// the arithmetic type `Scalar`. Parameters, residuals and Jacobians stay double; only the pose
+// differences are computed in double before switching to Scalar. The identity case never reads
+// the table. Evaluate() branches once on the requested Jacobians and runs an instantiation that
+// computes only those.
+template <InformationStructure kStructure, typename Scalar = double>
+class SpaPoseBlockCostFunctorFixed : public ceres::SizedCostFunction<3, 3, 3> {
+ public:
+  SpaPoseBlockCostFunctorFixed(const Pose& observed,
+                               const SqrtInformationTable* sqrt_information, int index)
+      : x_(observed.translation.x()),
+        y_(observed.translation.y()),
+        theta_(observed.rotation.angle()),
+        sqrt_information_(sqrt_information),
+        index_(index) {}
+
+  bool Evaluate(const double* const* parameters, double* residuals,
+                double** jacobians) const override {
+    if (!jacobians) return EvaluateWith<false, false>(parameters, residuals, jacobians);
+    if (jacobians[0]) {
+      return jacobians[1] ? EvaluateWith<true, true>(parameters, residuals, jacobians)
+                          : EvaluateWith<true, false>(parameters, residuals, jacobians);
+    }
+    return jacobians[1] ? EvaluateWith<false, true>(parameters, residuals, jacobians)
+                        : EvaluateWith<false, false>(parameters, residuals, jacobians);
+  }
+
+ private:
+  using Jacobian = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+  using Vector2 = Eigen::Matrix<Scalar, 2, 1>;
+  using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+  using Matrix2 = Eigen::Matrix<Scalar, 2, 2>;
+  using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+
+  template <bool kSourceJacobian, bool kTargetJacobian>
+  bool EvaluateWith(const double* const* parameters, double* residuals,
+                    double** jacobians) const {
+    const double* source = parameters[0];
+    const double* target = parameters[1];
+    // Differences of nearby poses lose nothing in Scalar, unlike their absolute coordinates.
+    const Scalar dx = static_cast<Scalar>(target[0] - source[0]);
+    const Scalar dy = static_cast<Scalar>(target[1] - source[1]);
+    const Scalar cos_source_theta = std::cos(static_cast<Scalar>(source[2]));
+    const Scalar sin_source_theta = std::sin(static_cast<Scalar>(source[2]));
+    const Scalar rotated_dx = cos_source_theta * dx + sin_source_theta * dy;
+    const Scalar rotated_dy = cos_source_theta * dy - sin_source_theta * dx;
+    const Vector3 unweighted(
+        static_cast<Scalar>(x_) - rotated_dx, static_cast<Scalar>(y_) - rotated_dy,
+        static_cast<Scalar>(common::NormalizeAngle(theta_ - (target[2] - source[2]))));
+    Eigen::Map<Eigen::Vector3d> residual_map(residuals);
+
+    // Unweighted Jacobians: the source one is [c, s, -rotated_dy; -s, c, rotated_dx; 0, 0, 1],
+    // the target one [-c, -s, 0; s, -c, 0; 0, 0, -1]. Weighting scales or mixes their rows.
+    if constexpr (kStructure == InformationStructure::kIdentity) {
+      residual_map = unweighted.template cast<double>();
+      if constexpr (kSourceJacobian) {
+        Eigen::Map<Jacobian>(jacobians[0]) << cos_source_theta, sin_source_theta, -rotated_dy,
+            -sin_source_theta, cos_source_theta, rotated_dx, 0., 0., 1.;
+      }
+      if constexpr (kTargetJacobian) {
+        Eigen::Map<Jacobian>(jacobians[1]) << -cos_source_theta, -sin_source_theta, 0.,
+            sin_source_theta, -cos_source_theta, 0., 0., 0., -1.;
+      }
+    } else if constexpr (kStructure == InformationStructure::kDiagonal) {
+      const Vector3 scale =
+          sqrt_information_->sqrt_information(index_).diagonal().template cast<Scalar>();
+      residual_map = unweighted.cwiseProduct(scale).template cast<double>();
+      const Scalar scaled_cos_0 = scale[0] * cos_source_theta;
+      const Scalar scaled_sin_0 = scale[0] * sin_source_theta;
+      const Scalar scaled_cos_1 = scale[1] * cos_source_theta;
+      const Scalar scaled_sin_1 = scale[1] * sin_source_theta;
+      if constexpr (kSourceJacobian) {
+        Eigen::Map<Jacobian>(jacobians[0]) << scaled_cos_0, scaled_sin_0, -scale[0] * rotated_dy,
+            -scaled_sin_1, scaled_cos_1, scale[1] * rotated_dx, 0., 0., scale[2];
+      }
+      if constexpr (kTargetJacobian) {
+        Eigen::Map<Jacobian>(jacobians[1]) << -scaled_cos_0, -scaled_sin_0, 0., scaled_sin_1,
+            -scaled_cos_1, 0., 0., 0., -scale[2];
+      }
+    } else {
+      const Matrix3 sqrt_information =
+          sqrt_information_->sqrt_information(index_).template cast<Scalar>();
+      residual_map = (sqrt_information * unweighted).template cast<double>();
+      Matrix2 rotation;
+      rotation << cos_source_theta, sin_source_theta, -sin_source_theta, cos_source_theta;
+      if constexpr (kSourceJacobian) {
+        Eigen::Map<Jacobian> jacobian(jacobians[0]);
+        jacobian.leftCols<2>() = (sqrt_information.template leftCols<2>() * rotation)
+                                     .template cast<double>();
+        const Vector3 theta_column =
+            sqrt_information.template leftCols<2>() * Vector2(-rotated_dy, rotated_dx) +
+            sqrt_information.col(2);
+        jacobian.col(2) = theta_column.template cast<double>();
+      }
+      if constexpr (kTargetJacobian) {
+        Eigen::Map<Jacobian> jacobian(jacobians[1]);
+        jacobian.leftCols<2>() = (-sqrt_information.template leftCols<2>() * rotation)
+                                     .template cast<double>();
+        jacobian.col(2) = -sqrt_information.col(2).template cast<double>();
+      }
+    }
+    return true;
+  }
+
+  const double x_;
+  const double y_;
+  const double theta_;
+  const SqrtInformationTable* const sqrt_information_;
+  const int index_;
+};
+
+// A constraint between poses of two rigid submaps, as a function of the submap origins. The
+// constrained poses are given in the frames of their origins, and the residual is that of
+// SpaPoseBlockCostFunctor once they are composed with the origins.
+class SubmapConstraintCostFunctor {
+ public:
+  SubmapConstraintCostFunctor(const Pose& source, const Pose& target, const Pose& observed,
+                              const SqrtInformationTable* sqrt_information, int index)
+      : source_{source.translation.x(), source.translation.y(), source.rotation.angle()},
+        target_{target.translation.x(), target.translation.y(), target.rotation.angle()},
+        constraint_(observed, sqrt_information, index) {}
+
+  template <typename T>
+  bool operator()(const T* const source_origin, const T* const target_origin,
+                  T* residual) const {
+    T source[3], target[3];
+    Compose(source_origin, source_, source);
+    Compose(target_origin, target_, target);
+    return constraint_(source, target, residual);
+  }
+
+ private:
+  template <typename T>
+  static void Compose(const T* origin, const double* local, T* pose) {
+    const T origin_cos = cos(origin[2]);
+    const T origin_sin = sin(origin[2]);
+    pose[0] = origin[0] + origin_cos * local[0] - origin_sin * local[1];
+    pose[1] = origin[1] + origin_sin * local[0] + origin_cos * local[1];
+    pose[2] = origin[2] + local[2];
+  }
+
+  const double source_[3];
+  const double target_[3];
+  const SpaPoseBlockCostFunctor constraint_;
+};
+
+// Residual sqrt_information * Log(measured^-1 * source^-1 * target) between two 3D pose
+// blocks on SE3Manifold, with analytic Jacobians with respect to their tangent perturbations:
+// Jr^-1(e) for the target and -Jr^-1(e) * Adjoint(target^-1 * source) for the source.
+class SpaCostFunctorSE3 : public ceres::SizedCostFunction<6, kSE3BlockSize, kSE3BlockSize> {
+ public:
+  SpaCostFunctorSE3(const common::SE3d& measured,
+                    const Eigen::Matrix<double, 6, 6>& sqrt_information)
+      : measured_inverse_(measured.inverse()), sqrt_information_(sqrt_information) {}
+  virtual ~SpaCostFunctorSE3() {}
+
+  bool Evaluate(const double* const* parameters, double* residuals, double** jacobians) const {
+    const common::SE3d relative =
+        SE3FromBlock(parameters[0]).inverse() * SE3FromBlock(parameters[1]);
+    const common::SE3d::Tangent error = (measured_inverse_ * relative).Log();
+    Eigen::Map<Eigen::Matrix<double, 6, 1>> residual_map(residuals);
+    residual_map = sqrt_information_ * error;
+
+    if (!jacobians) return true;
+
+    const Eigen::Matrix<double, 6, 6> jacobian_target =
+        sqrt_information_ * common::SE3d::RightJacobianInverse(error);
+    using BlockJacobian = Eigen::Matrix<double, 6, kSE3BlockSize, Eigen::RowMajor>;
+    if (jacobians[0]) {
+      Eigen::Map<BlockJacobian> jacobian(jacobians[0]);
+      jacobian.leftCols<6>() = -jacobian_target * relative.inverse().Adjoint();
+      jacobian.col(6).setZero();
+    }
+    if (jacobians[1]) {
+      Eigen::Map<BlockJacobian> jacobian(jacobians[1]);
+      jacobian.leftCols<6>() = jacobian_target;
+      jacobian.col(6).setZero();
+    }
+    return true;
+  }
+
+ private:
+  const common::SE3d measured_inverse_;
+  const Eigen::Matrix<double, 6, 6> sqrt_information_;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
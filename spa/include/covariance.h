@@ -0,0 +1,47 @@
+#ifndef SPA_COVARIANCE_H_
+#define SPA_COVARIANCE_H_
+
+#include <ceres/ceres.h>
+
+#include <Eigen/Dense>
+#include <utility>
+#include <vector>
+
+namespace robot {
+namespace spa {
+
+// How the pose graphs recover marginal covariances. Only the requested blocks of the covariance
+// matrix are computed, never the dense inverse of the information matrix.
+struct CovarianceOptions {
+  // SPARSE_QR factorizes the Jacobian with `sparse_linear_algebra_library` (SUITE_SPARSE or
+  // EIGEN_SPARSE) and back-substitutes only for the requested blocks. DENSE_SVD copes with rank
+  // deficient problems but is only usable on small graphs.
+  ceres::CovarianceAlgorithmType algorithm_type = ceres::SPARSE_QR;
+  // Defaults to ceres::Covariance::Options' choice, which depends on how Ceres was built.
+  ceres::SparseLinearAlgebraLibraryType sparse_linear_algebra_library =
+      ceres::Covariance::Options().sparse_linear_algebra_library_type;
+  // 0 uses every hardware thread.
+  int num_threads = 0;
+  // Problems worse conditioned than this count as rank deficient, and the computation fails.
+  double min_reciprocal_condition_number = 1e-14;
+  // Evaluates the Jacobian with the robust loss applied, so down-weighted constraints add less
+  // certainty.
+  bool apply_loss_function = true;
+};
+
+ceres::Covariance::Options ToCeresCovarianceOptions(const CovarianceOptions& options);
+
+using BlockPair = std::pair<const double*, const double*>;
+
+// Computes the covariance blocks between the parameter blocks of `block_pairs` in `problem`,
+// in their tangent space, each of size `tangent_size` x `tangent_size`. Blocks involving a
+// constant parameter block are zero. Returns false if a parameter block is not in `problem`
+// or the problem is rank deficient.
+bool ComputeCovarianceBlocks(const CovarianceOptions& options, int tangent_size,
+                             const std::vector<BlockPair>& block_pairs, ceres::Problem* problem,
+                             std::vector<Eigen::MatrixXd>* covariances);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SPA_DISTRIBUTED_POSE_GRAPH_H_
+#define SPA_DISTRIBUTED_POSE_GRAPH_H_
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "pose_graph_2d.h"
+#include "solve_report.h"
+#include "transport.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+// One robot's share of a pose graph split across a fleet, optimized by distributed block
+// Gauss-Seidel. Each robot owns its poses and the constraints between them. An inter-robot
+// constraint joins a local pose to a remote one; both robots add it, and each holds the other's
+// pose constant at the estimate its owner last sent.
+//
+// Step() folds in the separator poses received from the other robots, re-solves the local
+// partition, and sends each neighbour the separator poses it constrains that moved. Robots
+// exchange only separator poses, never their graphs. Stepping the robots one after another
+// descends the cost of the whole graph; stepping them concurrently is block Jacobi, which
+// converges more slowly. Either removes most of the error in a few rounds, but bending along
+// loops that span several robots only settles over many.
+//
+// Pose ids must be unique across the fleet.
+class DistributedPoseGraph2D {
+ public:
+  struct Options {
+    PoseGraph2D::Options pose_graph;
+    // Whether this robot's first pose fixes the fleet's frame. Exactly one robot should be the
+    // anchor; the others only hold their first pose fixed until they hear from a neighbour.
+    bool anchor = false;
+    // Separator poses that moved less than this since they were last sent, in meters and
+    // radians, are not sent again.
+    double send_tolerance = 1e-6;
+  };
+
+  struct StepReport {
+    SolveReport solve;
+    int num_messages_received = 0;
+    int num_poses_sent = 0;
+    // Largest move of a separator pose during the step, in meters or radians.
+    double max_separator_change = 0.;
+  };
+
+  // `transport` must outlive the graph.
+  DistributedPoseGraph2D(int robot_id, const Options& options, Transport* transport);
+
+  DistributedPoseGraph2D(const DistributedPoseGraph2D&) = delete;
+  DistributedPoseGraph2D& operator=(const DistributedPoseGraph2D&) = delete;
+
+  // Adds a local pose. Returns false if the id is known.
+  bool AddPose(int id, const Pose& pose);
+  // Adds a constraint between local poses. Returns false as PoseGraph2D::AddConstraint does.
+  bool AddConstraint(const Constraint& constraint);
+  // Adds a constraint between a local pose and pose `remote` of robot `remote_robot`, where
+  // `remote` is whichever end is not local. Until its owner sends it, the remote pose is where
+  // the constraint puts it. Returns false if neither or both ends are local.
+  bool AddInterRobotConstraint(const Constraint& constraint, int remote_robot);
+
+  StepReport Step();
+
+  int robot_id() const { return robot_id_; }
+  bool IsLocalPose(int id) const { return local_poses_.count(id) > 0; }
+  // The estimate of a local pose, or the latest received estimate of a remote one.
+  Pose pose(int id) const { return graph_.pose(id); }
+  const PoseGraph2D& graph() const { return graph_; }
+
+ private:
+  struct Neighbor {
+    // Local poses the neighbour's inter-robot constraints touch.
+    std::set<int> separator_ids;
+    std::unordered_map<int, Pose> last_sent;
+  };
+
+  const int robot_id_;
+  const Options options_;
+  Transport* const transport_;
+  PoseGraph2D graph_;
+  // Local pose ids, with the first in first_pose_id_.
+  std::set<int> local_poses_;
+  int first_pose_id_ = 0;
+  bool heard_from_neighbor_ = false;
+  // Owner robot of every remote pose.
+  std::unordered_map<int, int> remote_owners_;
+  std::map<int, Neighbor> neighbors_;
+};
+
+// Steps `graphs` one after another until a whole round moves no separator pose by more than
+// `tolerance`, or for `max_rounds` rounds. Returns the number of rounds run. For fleets
+// simulated in one process; on separate machines every robot runs its own Step() loop.
+int RunBlockGaussSeidel(const std::vector<DistributedPoseGraph2D*>& graphs, int max_rounds,
+                        double tolerance);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
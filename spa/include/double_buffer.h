@@ -0,0 +1,74 @@
+#ifndef SPA_DOUBLE_BUFFER_H_
+#define SPA_DOUBLE_BUFFER_H_
+
+#include <atomic>
+#include <thread>
+
+namespace robot {
+namespace spa {
+
+// Single-writer, multi-reader double buffer. Readers pin the published buffer with an atomic
+// counter and never take a lock or wait for the writer. The writer fills the other buffer and
+// publishes it with one atomic store; it only waits for readers still pinning that buffer from
+// before the previous publish.
+template <typename T>
+class DoubleBuffer {
+ public:
+  DoubleBuffer() = default;
+  DoubleBuffer(const DoubleBuffer&) = delete;
+  DoubleBuffer& operator=(const DoubleBuffer&) = delete;
+
+  // Returns reader(const T&) on the published value, which stays unchanged until the reader
+  // returns. Keep readers short: the writer's next-but-one publish waits for them.
+  template <typename Reader>
+  auto Read(Reader&& reader) const {
+    const Pin pin(this);
+    return reader(static_cast<const T&>(buffers_[pin.index]));
+  }
+
+  // Calls writer(T*) on the unpublished buffer, then publishes it. The buffer holds what was
+  // published two writes ago, so `writer` may update it incrementally. Only one thread may
+  // write.
+  template <typename Writer>
+  void Write(Writer&& writer) {
+    const int back = 1 - published_.load(std::memory_order_relaxed);
+    // Sequentially consistent, paired with the readers' recheck of published_ in Pin.
+    while (readers_[back].count.load() != 0) std::this_thread::yield();
+    writer(&buffers_[back]);
+    published_.store(back);
+  }
+
+ private:
+  // Registers a reader on the published buffer. A reader that loaded a stale index backs off
+  // when the recheck shows a publish happened in between, so the writer never overwrites a
+  // buffer a reader holds.
+  struct Pin {
+    explicit Pin(const DoubleBuffer* buffer) : buffer(buffer) {
+      for (;;) {
+        index = buffer->published_.load();
+        buffer->readers_[index].count.fetch_add(1);
+        if (buffer->published_.load() == index) return;
+        buffer->readers_[index].count.fetch_sub(1);
+      }
+    }
+    ~Pin() { buffer->readers_[index].count.fetch_sub(1, std::memory_order_release); }
+
+    const DoubleBuffer* buffer;
+    int index;
+  };
+
+  // Reader counts on separate cache lines, so readers of one buffer do not slow the writer's
+  // check of the other.
+  struct alignas(64) ReaderCount {
+    mutable std::atomic<int> count{0};
+  };
+
+  T buffers_[2];
+  std::atomic<int> published_{0};
+  ReaderCount readers_[2];
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SPA_G2O_IO_H_
+#define SPA_G2O_IO_H_
+
+#include <string>
+
+#include "pose_graph_2d.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+// Reads a pose graph in g2o format into `data`, replacing its contents. The 2D loader accepts
+// VERTEX_SE2/EDGE_SE2 and the TORO VERTEX2/EDGE2 records; the 3D loader accepts
+// VERTEX_SE3:QUAT/EDGE_SE3:QUAT. Both read FIX and skip other record types and '#' comments.
+//
+// The file is memory-mapped and parsed in place with std::from_chars, without allocating per
+// line. Returns false and fills `error` (if not null) with the file name and line on failure,
+// including on a record of the other dimension.
+bool LoadG2o(const std::string& path, PoseGraphData2D* data, std::string* error = nullptr);
+bool LoadG2o(const std::string& path, PoseGraphData3D* data, std::string* error = nullptr);
+
+// Writes `data` as VERTEX_SE2/EDGE_SE2 (or VERTEX_SE3:QUAT/EDGE_SE3:QUAT) and FIX records, with
+// doubles in their shortest round-trip form.
+bool WriteG2o(const std::string& path, const PoseGraphData2D& data,
+              std::string* error = nullptr);
+bool WriteG2o(const std::string& path, const PoseGraphData3D& data,
+              std::string* error = nullptr);
+
+// Writes the current estimate of `graph`, with FIX records for its constant poses.
+bool WriteG2o(const std::string& path, const PoseGraph2D& graph, std::string* error = nullptr);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
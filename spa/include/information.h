@@ -0,0 +1,49 @@
+#ifndef SPA_INFORMATION_H_
+#define SPA_INFORMATION_H_
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace robot {
+namespace spa {
+
+// Sparsity of a square root information matrix, from most to least specialized.
+enum class InformationStructure { kIdentity, kDiagonal, kFull };
+
+// Inverse of a symmetric positive definite covariance.
+Eigen::Matrix3d InformationFromCovariance(const Eigen::Matrix3d& covariance);
+
+// Whether `information` is positive definite, which constraints require.
+bool IsValidInformation(const Eigen::Matrix3d& information);
+
+// Square roots of constraint information matrices, laid out back to back (nine doubles each,
+// column-major) so the residual blocks of a solve walk one contiguous buffer. An entry is the
+// upper Cholesky factor U with U^T U = information, or, when the information is diagonal, the
+// element-wise square root of its diagonal, flagged so cost functions can scale rows instead of
+// multiplying by a 3x3 matrix. Identity information is flagged apart from other diagonal ones.
+class SqrtInformationTable {
+ public:
+  // Returns the index of the new entry, or -1 if `information` is not positive definite.
+  int Add(const Eigen::Matrix3d& information);
+
+  void reserve(size_t size) {
+    entries_.reserve(9 * size);
+    structures_.reserve(size);
+  }
+  size_t size() const { return structures_.size(); }
+
+  Eigen::Map<const Eigen::Matrix3d> sqrt_information(int index) const {
+    return Eigen::Map<const Eigen::Matrix3d>(&entries_[9 * index]);
+  }
+  InformationStructure structure(int index) const { return structures_[index]; }
+  bool is_diagonal(int index) const { return structures_[index] != InformationStructure::kFull; }
+
+ private:
+  std::vector<double> entries_;
+  std::vector<InformationStructure> structures_;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef SPA_MAPPED_FILE_H_
+#define SPA_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace robot {
+namespace spa {
+
+// Read-only memory map of a whole file.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Maps `path`, replacing any current mapping. Returns false and fills `error` on failure.
+  // `sequential` hints the kernel to read ahead aggressively.
+  bool Open(const std::string& path, bool sequential, std::string* error);
+  void Close();
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
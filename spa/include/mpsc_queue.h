@@ -0,0 +1,66 @@
+#ifndef SPA_MPSC_QUEUE_H_
+#define SPA_MPSC_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace robot {
+namespace spa {
+
+// Multi-producer, single-consumer queue. Push() is lock-free: a compare-and-swap onto an
+// intrusive stack. The consumer takes the whole stack with one exchange and reverses it, so
+// nodes are never popped one at a time and the stack has no ABA problem.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() = default;
+  ~MpscQueue() {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void Push(T value) {
+    Node* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  // Appends everything pushed so far to `values`, each producer's values in push order. Only
+  // one thread may pop.
+  void PopAll(std::vector<T>* values) {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    const size_t begin = values->size();
+    while (node) {
+      values->push_back(std::move(node->value));
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+    std::reverse(values->begin() + begin, values->end());
+  }
+
+  bool empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+ private:
+  struct Node {
+    T value;
+    Node* next;
+  };
+
+  std::atomic<Node*> head_{nullptr};
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
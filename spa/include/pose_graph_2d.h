@@ -0,0 +1,199 @@
+#ifndef SPA_POSE_GRAPH_2D_H_
+#define SPA_POSE_GRAPH_2D_H_
+
+#include <ceres/ceres.h>
+
+#include <Eigen/Dense>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "covariance.h"
+#include "information.h"
+#include "robust_loss.h"
+#include "solve_report.h"
+#include "solver_options.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+// Sparse pose adjustment over 2D poses. The graph owns its ceres::Problem and keeps it alive
+// between solves: poses and constraints can be added at any time, and each Solve() only adds
+// the residual blocks of constraints that are new since the previous call.
+//
+// Poses are stored contiguously as one [x, y, theta] parameter block each. Cost functions live
+// in an arena owned by the graph rather than in one heap allocation each; they survive rebuilds
+// of the problem, and with Reserve() adding constraints does not allocate per residual.
+class PoseGraph2D {
+ public:
+  // kAnalytic picks, per constraint, a cost function specialized on whether its information
+  // is the identity, diagonal or full, evaluated in the set EvaluationPrecision.
+  enum class CostFunctorType { kAutodiff, kAnalytic };
+
+  // kBatch re-solves every pose. kIncremental only re-solves the poses within
+  // `incremental_hops` constraints of an endpoint of a constraint added since the previous
+  // solve. kSlidingWindow only re-solves the `sliding_window_size` most recently added poses.
+  //
+  // The partial modes build a problem from just the residual blocks touching the active
+  // region, so their cost does not grow with the graph. Poses outside the region are held at
+  // their current estimate, not marginalized: no prior summarizes what they knew. A loop
+  // closure therefore only corrects its neighbourhood; run a kBatch solve now and then to
+  // spread it over the whole loop.
+  enum class SolveMode { kBatch, kIncremental, kSlidingWindow };
+
+  struct Options {
+    CostFunctorType cost_functor_type = CostFunctorType::kAnalytic;
+    // Initial precision of the analytic cost functions; autodiff always evaluates in double.
+    EvaluationPrecision evaluation_precision = EvaluationPrecision::kDouble;
+    RobustLossOptions loss;
+    OutlierRejectionOptions outlier_rejection;
+    SolverOptions solver;
+    CovarianceOptions covariance;
+    SolveMode solve_mode = SolveMode::kBatch;
+    int incremental_hops = 3;
+    int sliding_window_size = 100;
+  };
+
+  PoseGraph2D();
+  explicit PoseGraph2D(const Options& options);
+
+  PoseGraph2D(const PoseGraph2D&) = delete;
+  PoseGraph2D& operator=(const PoseGraph2D&) = delete;
+
+  // Reserves storage for `num_poses` poses and `num_constraints` constraints, their cost
+  // functions included. Growing past the reserved pose capacity moves the pose blocks, after
+  // which the next Solve() re-adds every residual block to a fresh ceres problem.
+  void Reserve(int num_poses, int num_constraints = 0);
+
+  // Adds a pose. The first pose added anchors the graph and is held constant. Returns false if
+  // a pose with this id already exists.
+  bool AddPose(int id, const Pose& pose);
+  // Returns false if either end of the constraint is not a known pose, or if its information
+  // matrix is not positive definite.
+  bool AddConstraint(const Constraint& constraint);
+  // Holds a pose fixed during optimization, or releases it. Returns false, changing nothing, if
+  // the pose is unknown.
+  bool SetPoseConstant(int id, bool constant);
+  // Switches the analytic cost functions to `precision` from the next Solve() on, e.g. float
+  // for frequent local solves and double for an occasional full one. Changing it recreates
+  // every residual block.
+  void SetEvaluationPrecision(EvaluationPrecision precision);
+  EvaluationPrecision evaluation_precision() const { return evaluation_precision_; }
+  // Overwrites the estimate of a known pose, e.g. one held constant at a value maintained
+  // elsewhere. Returns false, changing nothing, if the pose is unknown.
+  bool SetPose(int id, const Pose& pose);
+
+  bool HasPose(int id) const { return pose_indices_.count(id) > 0; }
+  bool IsPoseConstant(int id) const { return constant_poses_.count(id) > 0; }
+  Pose pose(int id) const;
+  int num_poses() const { return pose_ids_.size(); }
+  // Pose ids in insertion order.
+  const std::vector<int>& pose_ids() const { return pose_ids_; }
+  const std::vector<Constraint>& constraints() const { return constraints_; }
+  // Loop closures are constraints between poses not added one after the other. Only they are
+  // switchable or candidates for outlier rejection.
+  bool IsLoopClosure(int constraint_index) const;
+  // Whether outlier rejection dropped constraints()[constraint_index].
+  bool IsConstraintRejected(int constraint_index) const { return rejected_[constraint_index]; }
+  // The switch of a loop closure under RobustLossOptions::Type::kSwitchable, 1 otherwise.
+  double constraint_switch(int constraint_index) const { return switches_[constraint_index]; }
+
+  // Solves in the mode set in the options, or in `mode`.
+  SolveReport Solve();
+  SolveReport Solve(SolveMode mode);
+
+  // Covariances of the pose estimates in [x, y, theta], from the constraints of the last
+  // Solve(). Only the blocks between the pose pairs in `id_pairs` are computed, e.g. the latest
+  // pose against its loop closure candidates. Blocks involving a constant pose are zero.
+  // Returns false if a pose is unknown or in no solved constraint, or if the graph is rank
+  // deficient.
+  bool ComputeCovariances(const std::vector<std::pair<int, int>>& id_pairs,
+                          std::vector<Eigen::Matrix3d>* covariances);
+  // Marginal covariance of a single pose.
+  bool ComputeCovariance(int id, Eigen::Matrix3d* covariance);
+
+ private:
+  // Cost functions of a constraint, owned by `cost_functions_`. cost_function is null for a
+  // rejected constraint; switch_prior is set for switchable loop closures.
+  struct ResidualBlock {
+    ceres::CostFunction* cost_function;
+    ceres::CostFunction* switch_prior;
+  };
+
+  double* pose_block(int id) { return &pose_blocks_[3 * pose_indices_.at(id)]; }
+  // Replaces problem_ with a fresh one holding the existing residual blocks.
+  void RebuildProblem();
+  ceres::CostFunction* MakeCostFunction(int constraint_index);
+  // Adds the residual blocks of a constraint to problem_, over `cost_function` if given.
+  void AddResidualBlock(int constraint_index, ceres::CostFunction* cost_function = nullptr);
+  // Adds the residual blocks of a constraint to `problem`, with `loss_function` unless it is
+  // switchable.
+  void AddToProblem(int constraint_index, ceres::LossFunction* loss_function,
+                    ceres::Problem* problem);
+  // Vets the loop closures added since the previous outlier pass, including ones a partial
+  // solve has added to problem_ since, drops the rejected ones from problem_ and adds the
+  // residual blocks of the new constraints; returns how many it rejected.
+  int RejectOutliers();
+  void ApplyConstantPoses();
+  // Indices of the poses a partial solve may move.
+  std::vector<int> IncrementalRegion() const;
+  std::vector<int> SlidingWindowRegion() const;
+  void SolveRegion(const std::vector<int>& region, std::chrono::steady_clock::time_point start,
+                   SolveReport* report);
+
+  const Options options_;
+  EvaluationPrecision evaluation_precision_;
+  // [x, y, theta] of every pose, in insertion order.
+  std::vector<double> pose_blocks_;
+  std::vector<int> pose_ids_;
+  std::unordered_map<int, int> pose_indices_;
+  std::vector<Constraint> constraints_;
+  // Entry i belongs to constraints_[i].
+  SqrtInformationTable sqrt_information_;
+  // Indices into constraints_ of the constraints touching each pose, by pose index.
+  std::vector<std::vector<int>> pose_constraints_;
+  std::set<int> constant_poses_;
+  // One switch per constraint, whether or not it is used; a deque keeps their addresses stable.
+  std::deque<double> switches_;
+  std::vector<bool> rejected_;
+  // Shared by every residual block; declared before problem_ so it outlives it.
+  const std::unique_ptr<ceres::LossFunction> loss_function_;
+  // Owns every cost function, including ones only used while rejecting outliers.
+  Arena cost_functions_;
+  std::unique_ptr<ceres::Problem> problem_;
+  // One per constraint already added to problem_, in order.
+  std::vector<ResidualBlock> residual_blocks_;
+  // Constraints up to this index have been part of a solve.
+  size_t num_constraints_solved_ = 0;
+  // Constraints up to this index have been through outlier rejection. Only RejectOutliers()
+  // advances it, so partial solves, which skip the pass, leave their constraints to the next
+  // batch solve.
+  size_t vetted_up_to_ = 0;
+  // Set when pose_blocks_ reallocated under a live problem.
+  bool pose_blocks_moved_ = false;
+};
+
+// Current estimate of `graph` as flat arrays, with its constant poses as fixed_pose_ids.
+PoseGraphData2D ToPoseGraphData(const PoseGraph2D& graph);
+
+// One-shot optimization of `poses` using the autodiff or the analytic cost functor. Pose 0,
+// or the lowest id if there is no pose 0, is held constant. Constraints that cannot be added
+// are skipped and counted in num_invalid_constraints.
+SolveReport OptimizeAutodiffCostFunctor(const std::vector<Constraint>& constraints,
+                                        std::map<int, Pose>* poses_ptr,
+                                        const SolverOptions& solver_options = SolverOptions());
+SolveReport OptimizeAnalyticCostFunctor(const std::vector<Constraint>& constraints,
+                                        std::map<int, Pose>* poses_ptr,
+                                        const SolverOptions& solver_options = SolverOptions());
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
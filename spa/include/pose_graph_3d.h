@@ -0,0 +1,136 @@
+#ifndef SPA_POSE_GRAPH_3D_H_
+#define SPA_POSE_GRAPH_3D_H_
+
+#include <ceres/ceres.h>
+
+#include <Eigen/Dense>
+#include <deque>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "covariance.h"
+#include "robust_loss.h"
+#include "se3_manifold.h"
+#include "solve_report.h"
+#include "solver_options.h"
+#include "transform.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+inline common::SE3d ToSE3(const Pose3d& pose) {
+  return common::SE3d(pose.translation, pose.rotation);
+}
+
+inline Pose3d ToPose3d(const common::SE3d& pose) {
+  return {pose.translation(), pose.rotation()};
+}
+
+// Information over the SE3 tangent [rho; phi] from one over [x, y, z, qx, qy, qz]. The
+// quaternion vector part moves by half the rotation angle, so the rotation rows and columns
+// are halved; this is exact to first order at zero error.
+Eigen::Matrix<double, 6, 6> TangentInformation(const Eigen::Matrix<double, 6, 6>& information);
+
+// Sparse pose adjustment over 3D poses, the SE3 counterpart of PoseGraph2D. Each pose is one
+// 7-parameter block on SE3Manifold, and every constraint an analytic SpaCostFunctorSE3. The
+// ceres::Problem is kept between solves, and each Solve() only adds the residual blocks of
+// constraints new since the previous call.
+class PoseGraph3D {
+ public:
+  struct Options {
+    RobustLossOptions loss;
+    OutlierRejectionOptions outlier_rejection;
+    SolverOptions solver;
+    CovarianceOptions covariance;
+  };
+
+  PoseGraph3D();
+  explicit PoseGraph3D(const Options& options);
+
+  PoseGraph3D(const PoseGraph3D&) = delete;
+  PoseGraph3D& operator=(const PoseGraph3D&) = delete;
+
+  // Reserves storage for `num_poses` poses and `num_constraints` constraints. As in
+  // PoseGraph2D, growing past the reserved pose capacity makes the next Solve() rebuild the
+  // ceres problem.
+  void Reserve(int num_poses, int num_constraints = 0);
+
+  // Adds a pose. The first pose added anchors the graph and is held constant. Returns false if
+  // a pose with this id already exists.
+  bool AddPose(int id, const common::SE3d& pose);
+  // Returns false if either end of the constraint is not a known pose, or if its information
+  // matrix is not positive definite.
+  bool AddConstraint(const Constraint3d& constraint);
+  // Holds a pose fixed during optimization, or releases it. Returns false, changing nothing, if
+  // the pose is unknown.
+  bool SetPoseConstant(int id, bool constant);
+
+  bool HasPose(int id) const { return pose_indices_.count(id) > 0; }
+  bool IsPoseConstant(int id) const { return constant_poses_.count(id) > 0; }
+  common::SE3d pose(int id) const;
+  int num_poses() const { return pose_ids_.size(); }
+  // Pose ids in insertion order.
+  const std::vector<int>& pose_ids() const { return pose_ids_; }
+  const std::vector<Constraint3d>& constraints() const { return constraints_; }
+  // As in PoseGraph2D: loop closures join poses not added one after the other.
+  bool IsLoopClosure(int constraint_index) const;
+  bool IsConstraintRejected(int constraint_index) const { return rejected_[constraint_index]; }
+  double constraint_switch(int constraint_index) const { return switches_[constraint_index]; }
+
+  SolveReport Solve();
+
+  // As in PoseGraph2D, but in the tangent space [rho; phi] of the right perturbation
+  // T * Exp(delta), i.e. in the frame of each pose.
+  bool ComputeCovariances(const std::vector<std::pair<int, int>>& id_pairs,
+                          std::vector<Eigen::Matrix<double, 6, 6>>* covariances);
+  bool ComputeCovariance(int id, Eigen::Matrix<double, 6, 6>* covariance);
+
+ private:
+  double* pose_block(int id) { return &pose_blocks_[kSE3BlockSize * pose_indices_.at(id)]; }
+  void RebuildProblem();
+  // Adds the residual blocks of a constraint to `problem`, with `loss_function` unless it is
+  // switchable and `allow_switch`. Returns the constraint's own residual block.
+  ceres::ResidualBlockId AddToProblem(int constraint_index, ceres::LossFunction* loss_function,
+                                      ceres::Problem* problem, bool allow_switch = true);
+  // Adds the residual blocks problem_ lacks of constraints_ up to `end`.
+  void AddResidualBlocks(size_t end);
+  // Vets the loop closures added since the previous solve; returns how many it rejected.
+  int RejectOutliers();
+  void ApplyConstantPoses();
+
+  const Options options_;
+  // [tx, ty, tz, qx, qy, qz, qw] of every pose, in insertion order.
+  std::vector<double> pose_blocks_;
+  std::vector<int> pose_ids_;
+  std::unordered_map<int, int> pose_indices_;
+  std::vector<Constraint3d> constraints_;
+  // Upper triangular square roots of the tangent information of constraints_, in order.
+  std::vector<Eigen::Matrix<double, 6, 6>> sqrt_information_;
+  std::set<int> constant_poses_;
+  std::deque<double> switches_;
+  std::vector<bool> rejected_;
+  // Shared by every pose block and residual block; declared before problem_ so they outlive
+  // it.
+  const std::unique_ptr<SE3Manifold> manifold_;
+  const std::unique_ptr<ceres::LossFunction> loss_function_;
+  std::unique_ptr<ceres::Problem> problem_;
+  // Constraints up to this index have residual blocks in problem_.
+  size_t num_residual_blocks_ = 0;
+  // Constraints up to this index have been through outlier rejection. Unlike
+  // num_residual_blocks_, rebuilding problem_ does not reset it.
+  size_t vetted_up_to_ = 0;
+  // Set when pose_blocks_ reallocated under a live problem.
+  bool pose_blocks_moved_ = false;
+};
+
+// Current estimate of `graph` as flat arrays, with its constant poses as fixed_pose_ids.
+PoseGraphData3D ToPoseGraphData(const PoseGraph3D& graph);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef SPA_ROBUST_LOSS_H_
+#define SPA_ROBUST_LOSS_H_
+
+#include <ceres/ceres.h>
+
+#include <memory>
+#include <vector>
+
+#include "solver_options.h"
+
+namespace robot {
+namespace spa {
+
+struct RobustLossOptions {
+  // kSwitchable gives every loop closure a switch variable in [0, 1] that scales its residual,
+  // with a prior pulling the switch to 1 (Suenderhauf and Protzel, 2012); the optimizer turns
+  // off loop closures it cannot reconcile. Its residuals have no loss function.
+  enum class Type { kTrivial, kHuber, kCauchy, kTukey, kDcs, kSwitchable };
+
+  Type type = Type::kHuber;
+  // Whitened residual norm where the kernel starts down-weighting. For DCS (dynamic covariance
+  // scaling) this is sqrt(phi).
+  double scale = 1.;
+  // kSwitchable: standard deviation of the prior pulling each switch towards 1. Switching a
+  // constraint off costs (1 / stddev)^2, which should exceed the squared whitened residual of a
+  // true loop closure and stay below that of a false one.
+  double switch_prior_stddev = 1.;
+};
+
+// Loss function for `options`, or null for kTrivial and kSwitchable. The graphs share one
+// instance across all their residual blocks.
+std::unique_ptr<ceres::LossFunction> MakeLossFunction(const RobustLossOptions& options);
+
+// Dynamic covariance scaling (Agarwal et al., 2013): the robust kernel whose weight is the
+// DCS scale factor squared, min(1, 2 phi / (phi + s))^2.
+class DcsLoss : public ceres::LossFunction {
+ public:
+  explicit DcsLoss(double phi) : phi_(phi) {}
+  void Evaluate(double s, double rho[3]) const override;
+
+ private:
+  const double phi_;
+};
+
+// Scales the residuals of `cost_function` by a switch variable, passed as an extra last
+// parameter block of size 1.
+class SwitchableCostFunction : public ceres::CostFunction {
+ public:
+  // Takes ownership of `cost_function` unless `ownership` says otherwise.
+  explicit SwitchableCostFunction(ceres::CostFunction* cost_function,
+                                  ceres::Ownership ownership = ceres::TAKE_OWNERSHIP);
+  ~SwitchableCostFunction() override;
+  bool Evaluate(const double* const* parameters, double* residuals,
+                double** jacobians) const override;
+
+ private:
+  ceres::CostFunction* const cost_function_;
+  const ceres::Ownership ownership_;
+};
+
+// (1 - switch) / stddev.
+class SwitchPriorCostFunction : public ceres::SizedCostFunction<1, 1> {
+ public:
+  explicit SwitchPriorCostFunction(double stddev) : inverse_stddev_(1. / stddev) {}
+  bool Evaluate(const double* const* parameters, double* residuals,
+                double** jacobians) const override {
+    residuals[0] = (1. - parameters[0][0]) * inverse_stddev_;
+    if (jacobians && jacobians[0]) jacobians[0][0] = -inverse_stddev_;
+    return true;
+  }
+
+ private:
+  const double inverse_stddev_;
+};
+
+struct OutlierRejectionOptions {
+  // When set, a batch solve first vets the loop closures added since the previous batch solve,
+  // including ones incremental or sliding-window solves have used since, and drops the ones it
+  // rejects.
+  bool enabled = false;
+  // Squared whitened residual above which a loop closure is an outlier. 0 picks the 99%
+  // chi-square quantile for the residual dimension.
+  double max_squared_error = 0.;
+  // The kernel's convexity parameter is divided by this factor at every step.
+  double gnc_factor = 1.4;
+  int max_gnc_steps = 50;
+  // Solver iterations per step.
+  int max_iterations_per_step = 10;
+};
+
+// Outlier rejection by graduated non-convexity (Yang et al., 2020) with the Geman-McClure
+// kernel rho(s) = mu c^2 s / (mu c^2 + s), c^2 the squared error threshold. mu starts large,
+// where the kernel is nearly quadratic and the problem nearly convex, and shrinks towards 1;
+// each step warm-starts from the previous estimate.
+//
+// Build a problem holding the trusted residual blocks without a loss function and the
+// candidate blocks with loss(), then call Run().
+class GncOutlierRejection {
+ public:
+  GncOutlierRejection(const OutlierRejectionOptions& options, const SolverOptions& solver,
+                      int residual_dimension);
+
+  ceres::LossFunction* loss() { return &loss_; }
+
+  // Optimizes the parameters of `problem` in place and returns, for every candidate, whether
+  // it is an inlier.
+  std::vector<bool> Run(const std::vector<ceres::ResidualBlockId>& candidates,
+                        ceres::Problem* problem);
+
+ private:
+  class GemanMcClureLoss : public ceres::LossFunction {
+   public:
+    void Evaluate(double s, double rho[3]) const override;
+    double mu_c_sq = 1.;
+  };
+
+  const OutlierRejectionOptions options_;
+  const SolverOptions solver_;
+  const double max_squared_error_;
+  GemanMcClureLoss loss_;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SPA_SE3_MANIFOLD_H_
+#define SPA_SE3_MANIFOLD_H_
+
+#include <ceres/ceres.h>
+
+#include <Eigen/Dense>
+
+#include "transform.h"
+
+namespace robot {
+namespace spa {
+
+// A 3D pose parameter block is [tx, ty, tz, qx, qy, qz, qw]: the translation followed by the
+// quaternion in Eigen's memory order.
+constexpr int kSE3BlockSize = 7;
+
+inline common::SE3d SE3FromBlock(const double* block) {
+  return common::SE3d(Eigen::Map<const Eigen::Vector3d>(block),
+                      Eigen::Map<const Eigen::Quaterniond>(block + 3));
+}
+
+inline void SE3ToBlock(const common::SE3d& pose, double* block) {
+  Eigen::Map<Eigen::Vector3d> translation(block);
+  Eigen::Map<Eigen::Quaterniond> rotation(block + 3);
+  translation = pose.translation();
+  rotation = pose.rotation();
+}
+
+// SE3 with the right perturbation x + delta = x * Exp(delta), delta = [rho; phi].
+//
+// PlusJacobian() reports [I; 0] instead of the true 7x6 derivative. Cost functions on these
+// blocks return d residual / d delta in the first six columns of their Jacobian and zero in
+// the seventh, so the product Ceres forms is the exact tangent Jacobian without chaining
+// through the quaternion. Cost functions that differentiate with respect to the raw
+// parameters, such as autodiff ones, cannot be used with this manifold.
+class SE3Manifold : public ceres::Manifold {
+ public:
+  int AmbientSize() const override { return kSE3BlockSize; }
+  int TangentSize() const override { return 6; }
+
+  bool Plus(const double* x, const double* delta, double* x_plus_delta) const override {
+    common::SE3d pose = SE3FromBlock(x) * common::SE3d::Exp(
+                                              Eigen::Map<const common::SE3d::Tangent>(delta));
+    pose.rotation().normalize();
+    SE3ToBlock(pose, x_plus_delta);
+    return true;
+  }
+
+  bool PlusJacobian(const double* x, double* jacobian) const override {
+    Eigen::Map<Eigen::Matrix<double, kSE3BlockSize, 6, Eigen::RowMajor>> plus_jacobian(jacobian);
+    plus_jacobian.setZero();
+    plus_jacobian.topRows<6>().setIdentity();
+    return true;
+  }
+
+  bool Minus(const double* y, const double* x, double* y_minus_x) const override {
+    Eigen::Map<common::SE3d::Tangent> tangent(y_minus_x);
+    tangent = (SE3FromBlock(x).inverse() * SE3FromBlock(y)).Log();
+    return true;
+  }
+
+  bool MinusJacobian(const double* x, double* jacobian) const override {
+    Eigen::Map<Eigen::Matrix<double, 6, kSE3BlockSize, Eigen::RowMajor>> minus_jacobian(
+        jacobian);
+    minus_jacobian.setZero();
+    minus_jacobian.leftCols<6>().setIdentity();
+    return true;
+  }
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
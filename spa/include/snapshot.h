@@ -0,0 +1,118 @@
+#ifndef SPA_SNAPSHOT_H_
+#define SPA_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "mapped_file.h"
+#include "pose_graph_2d.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+// Binary pose graph snapshot. The file is a SnapshotHeader followed by four arrays, each
+// starting on a 64-byte boundary: pose ids, poses, constraints and fixed pose ids. Values are
+// stored in host byte order, so a mapped file is read in place.
+//
+// The header records the robot_common VERSION_MAJOR/VERSION_MINOR that wrote it. A snapshot
+// opens if its major version matches and its minor version is not newer than the reader's.
+
+// 2D constraint record. The information matrix is column-major.
+struct SnapshotConstraint2D {
+  int32_t source;
+  int32_t target;
+  // [x, y, theta].
+  double relative_pose[3];
+  double information[9];
+};
+
+// 3D constraint record. The information matrix is column-major.
+struct SnapshotConstraint3D {
+  int32_t source;
+  int32_t target;
+  // [x, y, z, qx, qy, qz, qw].
+  double relative_pose[7];
+  double information[36];
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  // Written as 0x01020304; a mismatch means the file comes from a host of other endianness.
+  uint32_t byte_order;
+  uint32_t version_major;
+  uint32_t version_minor;
+  // 2 or 3.
+  uint32_t dimension;
+  uint64_t num_poses;
+  uint64_t num_constraints;
+  uint64_t num_fixed_poses;
+  // Byte offsets of the arrays from the start of the file.
+  uint64_t pose_ids_offset;
+  uint64_t poses_offset;
+  uint64_t constraints_offset;
+  uint64_t fixed_pose_ids_offset;
+  uint64_t file_size;
+};
+
+static_assert(std::is_trivially_copyable<SnapshotHeader>::value, "");
+static_assert(std::is_trivially_copyable<SnapshotConstraint2D>::value, "");
+static_assert(std::is_trivially_copyable<SnapshotConstraint3D>::value, "");
+
+bool WriteSnapshot(const std::string& path, const PoseGraphData2D& data,
+                   std::string* error = nullptr);
+bool WriteSnapshot(const std::string& path, const PoseGraphData3D& data,
+                   std::string* error = nullptr);
+bool WriteSnapshot(const std::string& path, const PoseGraph2D& graph,
+                   std::string* error = nullptr);
+
+// Zero-copy view of a snapshot file. The arrays point into a single read-only mapping and stay
+// valid until the snapshot is reopened or destroyed.
+class PoseGraphSnapshot {
+ public:
+  // Maps and validates `path`. Returns false and fills `error` if the file is not a snapshot,
+  // is truncated, or has an incompatible version.
+  bool Open(const std::string& path, std::string* error = nullptr);
+
+  int dimension() const { return header_->dimension; }
+  int version_major() const { return header_->version_major; }
+  int version_minor() const { return header_->version_minor; }
+  size_t num_poses() const { return header_->num_poses; }
+  size_t num_constraints() const { return header_->num_constraints; }
+  size_t num_fixed_poses() const { return header_->num_fixed_poses; }
+
+  const int32_t* pose_ids() const { return At<int32_t>(header_->pose_ids_offset); }
+  // [x, y, theta] per pose in 2D, [x, y, z, qx, qy, qz, qw] in 3D.
+  const double* poses() const { return At<double>(header_->poses_offset); }
+  // Null unless dimension() is 2.
+  const SnapshotConstraint2D* constraints_2d() const {
+    return dimension() == 2 ? At<SnapshotConstraint2D>(header_->constraints_offset) : nullptr;
+  }
+  // Null unless dimension() is 3.
+  const SnapshotConstraint3D* constraints_3d() const {
+    return dimension() == 3 ? At<SnapshotConstraint3D>(header_->constraints_offset) : nullptr;
+  }
+  const int32_t* fixed_pose_ids() const { return At<int32_t>(header_->fixed_pose_ids_offset); }
+
+ private:
+  template <typename T>
+  const T* At(uint64_t offset) const {
+    return reinterpret_cast<const T*>(file_.data() + offset);
+  }
+
+  MappedFile file_;
+  const SnapshotHeader* header_ = nullptr;
+};
+
+// Adds the poses and constraints of a 2D snapshot to `graph`, reserving storage for all of
+// them up front. If the snapshot lists fixed poses, exactly those are held constant; otherwise
+// the first pose anchors the graph as usual. Returns false if the snapshot is not 2D or the
+// graph rejects a record.
+bool AddToPoseGraph(const PoseGraphSnapshot& snapshot, PoseGraph2D* graph,
+                    std::string* error = nullptr);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
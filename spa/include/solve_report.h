@@ -0,0 +1,52 @@
+#ifndef SPA_SOLVE_REPORT_H_
+#define SPA_SOLVE_REPORT_H_
+
+#include <ceres/ceres.h>
+
+#include <chrono>
+#include <vector>
+
+#include "solver_options.h"
+
+namespace robot {
+namespace spa {
+
+struct SolveReport {
+  ceres::Solver::Summary summary;
+  // Time spent adding the residual blocks of constraints new since the previous solve.
+  double problem_update_time_seconds = 0.;
+  // Wall time of ceres::Solve.
+  double solve_time_seconds = 0.;
+  // Of solve_time_seconds: residual and Jacobian evaluation, and the linear solver.
+  double evaluation_time_seconds = 0.;
+  double linear_solver_time_seconds = 0.;
+  // Cost after each iteration, starting with the initial cost.
+  std::vector<double> iteration_costs;
+  int num_poses = 0;
+  int num_constraints = 0;
+  // Poses the solve was allowed to move.
+  int num_variable_poses = 0;
+  // Residual blocks their loss function down-weights at the final estimate; for the Huber
+  // loss, those outside its quadratic region.
+  int num_downweighted_residuals = 0;
+  // High-water mark of the resident set size of the whole process.
+  long peak_rss_bytes = 0;
+  // Loop closures outlier rejection dropped before this solve.
+  int num_rejected_constraints = 0;
+  // Constraints the one-shot Optimize*CostFunctor functions could not add, as they join an
+  // unknown pose or their information is not positive definite. They are left out of the solve.
+  int num_invalid_constraints = 0;
+  // Why the solve stopped early, if it did.
+  bool time_budget_exceeded = false;
+  bool stopped_by_callback = false;
+};
+
+// Runs ceres::Solve on `problem` and fills in the solver fields of `report`. The time budget
+// of `options` is counted from `start`.
+void SolveAndReport(const SolverOptions& options, std::chrono::steady_clock::time_point start,
+                    ceres::Problem* problem, SolveReport* report);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
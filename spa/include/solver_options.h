@@ -0,0 +1,50 @@
+#ifndef SPA_SOLVER_OPTIONS_H_
+#define SPA_SOLVER_OPTIONS_H_
+
+#include <ceres/ceres.h>
+
+#include <functional>
+
+namespace robot {
+namespace spa {
+
+// Precision of the residual and Jacobian arithmetic. Ceres always takes doubles and
+// accumulates the normal equations in double; kFloat evaluates the cost functions in float
+// past the pose differences, trigonometry included, which is cheaper on embedded targets.
+enum class EvaluationPrecision { kDouble, kFloat };
+
+// The subset of ceres::Solver::Options that matters for pose graphs.
+struct SolverOptions {
+  // Threads used for Jacobian evaluation and the linear solver. 0 uses every hardware thread.
+  int num_threads = 0;
+  int max_num_iterations = 50;
+
+  // SPARSE_NORMAL_CHOLESKY and SPARSE_SCHUR factorize with `sparse_linear_algebra_library`.
+  // ITERATIVE_SCHUR and CGNR are matrix-free and use `preconditioner_type` instead; pose
+  // graphs have no landmark blocks, so Ceres picks the Schur elimination groups itself.
+  ceres::LinearSolverType linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
+  ceres::PreconditionerType preconditioner_type = ceres::JACOBI;
+  // Defaults to ceres::Solver::Options' choice, the best library the installed Ceres has.
+  ceres::SparseLinearAlgebraLibraryType sparse_linear_algebra_library =
+      ceres::Solver::Options().sparse_linear_algebra_library_type;
+  // Fill-reducing ordering of the sparse factorization. NESDIS (nested dissection) usually
+  // beats AMD on large graphs with many loop closures.
+  ceres::LinearSolverOrderingType ordering_type = ceres::AMD;
+
+  bool minimizer_progress_to_stdout = false;
+
+  // Wall-clock budget of a solve in seconds, counted from the start of the solve call; 0 means
+  // none. It is checked after every iteration, so a solve can overrun it by one iteration.
+  double time_budget_seconds = 0.;
+  // Called after every iteration. Returning false stops the solve at the current estimate.
+  std::function<bool(const ceres::IterationSummary&)> iteration_callback;
+};
+
+// Everything but the time budget and callback, which need a ceres::IterationCallback that
+// outlives the solve; SolveAndReport() installs one.
+ceres::Solver::Options ToCeresSolverOptions(const SolverOptions& options);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
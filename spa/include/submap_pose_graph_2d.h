@@ -0,0 +1,99 @@
+#ifndef SPA_SUBMAP_POSE_GRAPH_2D_H_
+#define SPA_SUBMAP_POSE_GRAPH_2D_H_
+
+#include <ceres/ceres.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "information.h"
+#include "pose_graph_2d.h"
+#include "robust_loss.h"
+#include "solve_report.h"
+#include "solver_options.h"
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+// Two-level optimizer for graphs too large for one ceres problem. Poses are grouped in
+// insertion order into submaps of `submap_size` poses, each anchored at its first pose. Solve()
+//  1. optimizes every submap with new data on its own, in parallel, over the constraints
+//     inside it, with the member poses kept in the frame of the submap origin;
+//  2. holds the submaps rigid and solves a coarse graph over their origins, with the
+//     constraints between submaps;
+//  3. moves every member pose with its submap origin.
+//
+// A rigid submap cannot bend to absorb a loop closure to another submap, so the result
+// approximates the full solution, the more closely the smaller the submaps. Where the exact
+// optimum matters, it is a good initial estimate for a PoseGraph2D batch solve.
+class SubmapPoseGraph2D {
+ public:
+  struct Options {
+    int submap_size = 100;
+    // Options of the submap solves. Each solve runs on a single thread, with `num_threads`
+    // submaps solved at once; 0 uses every hardware thread.
+    PoseGraph2D::Options submap;
+    int num_threads = 0;
+    // Options of the coarse solve over the submap origins.
+    RobustLossOptions coarse_loss;
+    SolverOptions coarse_solver;
+  };
+
+  struct Report {
+    int num_submaps = 0;
+    // Submaps re-solved because they got poses or constraints since the previous solve.
+    int num_solved_submaps = 0;
+    double submap_time_seconds = 0.;
+    // Empty if the graph has no constraint between submaps.
+    SolveReport coarse;
+    double total_time_seconds = 0.;
+  };
+
+  SubmapPoseGraph2D();
+  explicit SubmapPoseGraph2D(const Options& options);
+
+  // Return false as PoseGraph2D's do. The first pose anchors the graph.
+  bool AddPose(int id, const Pose& pose);
+  bool AddConstraint(const Constraint& constraint);
+
+  bool HasPose(int id) const { return pose_indices_.count(id) > 0; }
+  Pose pose(int id) const;
+  int num_poses() const { return pose_ids_.size(); }
+  int num_submaps() const { return submaps_.size(); }
+  const std::vector<int>& pose_ids() const { return pose_ids_; }
+  const std::vector<Constraint>& constraints() const { return constraints_; }
+
+  Report Solve();
+
+ private:
+  struct Submap {
+    Pose origin;
+    // Member poses in the frame of `origin`; the first is the identity.
+    std::vector<Pose> local_poses;
+    // Indices into constraints_ of the constraints between members.
+    std::vector<int> constraints;
+    bool dirty = true;
+  };
+
+  int submap_index(int pose_index) const { return pose_index / options_.submap_size; }
+  void SolveSubmap(int index);
+  void SolveCoarse(Report* report);
+
+  const Options options_;
+  std::vector<int> pose_ids_;
+  std::unordered_map<int, int> pose_indices_;
+  std::vector<Constraint> constraints_;
+  // Entry i belongs to constraints_[i].
+  SqrtInformationTable sqrt_information_;
+  std::vector<Submap> submaps_;
+  // Indices into constraints_ of the constraints between submaps.
+  std::vector<int> coarse_constraints_;
+  const std::unique_ptr<ceres::LossFunction> coarse_loss_function_;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef SPA_SYNTHETIC_GRAPH_H_
+#define SPA_SYNTHETIC_GRAPH_H_
+
+#include <vector>
+
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+struct SyntheticGraphOptions {
+  // kManhattan moves one step along a grid axis at a time and turns by multiples of 90
+  // degrees, revisiting grid points exactly. kRandomWalk turns by a random angle every step.
+  enum class Topology { kManhattan, kRandomWalk };
+
+  Topology topology = Topology::kManhattan;
+  int num_poses = 1000;
+  double step_length = 1.;
+  // Manhattan: probability of turning left or right (and, in 3D, of changing level) at a step.
+  double turn_probability = 0.3;
+  // Random walk: standard deviation of the heading change per step, in radians.
+  double turn_stddev = 0.2;
+
+  // Probability that a pose gets a loop closure to an earlier pose within
+  // `loop_closure_radius`, at least `min_loop_closure_gap` poses back.
+  double loop_closure_probability = 0.1;
+  double loop_closure_radius = 1.5;
+  int min_loop_closure_gap = 10;
+
+  // Standard deviations of the measurement noise, which also set the constraint information.
+  double translation_noise = 0.02;
+  double rotation_noise = 0.01;
+  // Fraction of loop closures replaced by a random relative pose.
+  double outlier_rate = 0.;
+
+  unsigned seed = 42;
+};
+
+// `data` holds the noisy measurements as constraints (odometry first in each pose's group,
+// then its loop closure) and the dead-reckoned odometry as the initial estimate; pose ids are
+// 0 .. num_poses - 1, with pose 0 fixed. ground_truth[i] is the true pose i and is_outlier[j]
+// flags data.constraints[j].
+struct SyntheticGraph2D {
+  PoseGraphData2D data;
+  std::vector<Pose> ground_truth;
+  std::vector<bool> is_outlier;
+};
+
+struct SyntheticGraph3D {
+  PoseGraphData3D data;
+  std::vector<Pose3d> ground_truth;
+  std::vector<bool> is_outlier;
+};
+
+SyntheticGraph2D GenerateGraph2D(const SyntheticGraphOptions& options);
+SyntheticGraph3D GenerateGraph3D(const SyntheticGraphOptions& options);
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef SPA_TRANSPORT_H_
+#define SPA_TRANSPORT_H_
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "types.h"
+
+namespace robot {
+namespace spa {
+
+// Latest estimates of separator poses, the poses of one robot that another robot's graph
+// constrains, sent by their owner.
+struct SeparatorMessage {
+  int source_robot;
+  std::vector<std::pair<int, Pose>> poses;
+};
+
+// Carries separator poses between the robots of a DistributedPoseGraph2D fleet. Implement it
+// over whatever link the robots share.
+class Transport {
+ public:
+  virtual ~Transport() = default;
+
+  // Queues `message` for robot `target_robot`.
+  virtual void Send(int target_robot, SeparatorMessage message) = 0;
+  // Returns the messages that arrived for `robot` since the previous call, oldest first.
+  virtual std::vector<SeparatorMessage> Receive(int robot) = 0;
+};
+
+// Delivers messages between robots in one process, e.g. in simulation and tests. Thread safe.
+class InMemoryTransport : public Transport {
+ public:
+  void Send(int target_robot, SeparatorMessage message) override;
+  std::vector<SeparatorMessage> Receive(int robot) override;
+
+  // Totals over every Send(), as a measure of network traffic.
+  int64_t num_messages_sent() const;
+  int64_t num_poses_sent() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<int, std::vector<SeparatorMessage>> inboxes_;
+  int64_t num_messages_sent_ = 0;
+  int64_t num_poses_sent_ = 0;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
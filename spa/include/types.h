@@ -0,0 +1,57 @@
+#ifndef SPA_TYPES_H_
+#define SPA_TYPES_H_
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace robot {
+namespace spa {
+
+struct Pose {
+  Eigen::Vector2d translation;
+  Eigen::Rotation2Dd rotation;
+};
+
+// Relative pose of `target` expressed in the frame of `source`, with the information matrix
+// (inverse covariance) of [x, y, theta].
+struct Constraint {
+  int source;
+  int target;
+  Pose relative_pose;
+  Eigen::Matrix3d information = Eigen::Matrix3d::Identity();
+};
+
+struct Pose3d {
+  Eigen::Vector3d translation;
+  Eigen::Quaterniond rotation;
+};
+
+// 3D counterpart of Constraint. The information matrix is over [x, y, z, qx, qy, qz], the
+// parameterization g2o uses for EDGE_SE3:QUAT.
+struct Constraint3d {
+  int source;
+  int target;
+  Pose3d relative_pose;
+  Eigen::Matrix<double, 6, 6> information = Eigen::Matrix<double, 6, 6>::Identity();
+};
+
+// A whole pose graph as flat arrays, as read from or written to a dataset. poses[i] has id
+// pose_ids[i]; `fixed_pose_ids` are the poses the dataset marks as held constant.
+struct PoseGraphData2D {
+  std::vector<int> pose_ids;
+  std::vector<Pose> poses;
+  std::vector<Constraint> constraints;
+  std::vector<int> fixed_pose_ids;
+};
+
+struct PoseGraphData3D {
+  std::vector<int> pose_ids;
+  std::vector<Pose3d> poses;
+  std::vector<Constraint3d> constraints;
+  std::vector<int> fixed_pose_ids;
+};
+
+}  // namespace spa
+}  // namespace robot
+
+#endif
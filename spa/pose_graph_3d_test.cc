@@ -0,0 +1,257 @@
+#include "pose_graph_3d.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "cost_functors.h"
+#include "pose_graph_2d.h"
+#include "synthetic_graph.h"
+
+using robot::common::SE3d;
+using robot::spa::Constraint3d;
+using robot::spa::PoseGraph3D;
+using robot::spa::SE3Manifold;
+using robot::spa::kSE3BlockSize;
+
+namespace {
+
+using Vector6d = Eigen::Matrix<double, 6, 1>;
+using Matrix6d = Eigen::Matrix<double, 6, 6>;
+
+SE3d RandomPose(std::mt19937* rng) {
+  std::normal_distribution<double> normal(0., 1.);
+  Vector6d tangent;
+  for (int i = 0; i < 6; ++i) tangent[i] = normal(*rng);
+  return SE3d::Exp(tangent);
+}
+
+}  // namespace
+
+TEST(SE3ManifoldTest, MinusInvertsPlus) {
+  std::mt19937 rng(1);
+  const SE3Manifold manifold;
+  double x[kSE3BlockSize], y[kSE3BlockSize];
+  robot::spa::SE3ToBlock(RandomPose(&rng), x);
+  Vector6d delta;
+  delta << 0.3, -0.2, 0.5, 0.1, -0.4, 0.2;
+  ASSERT_TRUE(manifold.Plus(x, delta.data(), y));
+  EXPECT_NEAR(Eigen::Map<const Eigen::Quaterniond>(y + 3).norm(), 1., 1e-12);
+  Vector6d minus;
+  ASSERT_TRUE(manifold.Minus(y, x, minus.data()));
+  EXPECT_LT((minus - delta).norm(), 1e-9);
+}
+
+// The Jacobians, composed with the manifold's PlusJacobian as Ceres does, match central
+// differences through SE3Manifold::Plus.
+TEST(SpaCostFunctorSE3Test, JacobiansMatchNumericDerivatives) {
+  std::mt19937 rng(2);
+  const SE3Manifold manifold;
+  const SE3d source = RandomPose(&rng);
+  const SE3d target = RandomPose(&rng);
+  const SE3d measured = source.inverse() * target * SE3d::Exp(0.1 * Vector6d::Ones());
+  Matrix6d information = Matrix6d::Identity();
+  information(0, 1) = information(1, 0) = 0.3;
+  information(3, 5) = information(5, 3) = -0.2;
+  const robot::spa::SpaCostFunctorSE3 cost_function(
+      measured, Eigen::LLT<Matrix6d>(information).matrixU().toDenseMatrix());
+
+  double blocks[2][kSE3BlockSize];
+  robot::spa::SE3ToBlock(source, blocks[0]);
+  robot::spa::SE3ToBlock(target, blocks[1]);
+  const double* parameters[2] = {blocks[0], blocks[1]};
+  Vector6d residual;
+  Eigen::Matrix<double, 6, kSE3BlockSize, Eigen::RowMajor> jacobians[2];
+  double* jacobian_pointers[2] = {jacobians[0].data(), jacobians[1].data()};
+  ASSERT_TRUE(cost_function.Evaluate(parameters, residual.data(), jacobian_pointers));
+
+  const double step = 1e-6;
+  for (int block = 0; block < 2; ++block) {
+    Eigen::Matrix<double, kSE3BlockSize, 6, Eigen::RowMajor> plus_jacobian;
+    manifold.PlusJacobian(blocks[block], plus_jacobian.data());
+    const Matrix6d analytic = jacobians[block] * plus_jacobian;
+    for (int i = 0; i < 6; ++i) {
+      Vector6d delta = Vector6d::Zero();
+      double perturbed[2][kSE3BlockSize];
+      Vector6d residuals[2];
+      for (int sign = 0; sign < 2; ++sign) {
+        delta[i] = sign == 0 ? step : -step;
+        std::copy(blocks[0], blocks[0] + kSE3BlockSize, perturbed[0]);
+        std::copy(blocks[1], blocks[1] + kSE3BlockSize, perturbed[1]);
+        manifold.Plus(blocks[block], delta.data(), perturbed[block]);
+        const double* perturbed_parameters[2] = {perturbed[0], perturbed[1]};
+        cost_function.Evaluate(perturbed_parameters, residuals[sign].data(), nullptr);
+      }
+      const Vector6d numeric = (residuals[0] - residuals[1]) / (2. * step);
+      EXPECT_LT((analytic.col(i) - numeric).norm(), 1e-6) << "block " << block << " col " << i;
+    }
+  }
+}
+
+TEST(PoseGraph3DTest, RecoversNoiseFreeGraphFromPerturbedStart) {
+  robot::spa::SyntheticGraphOptions options;
+  options.num_poses = 30;
+  options.loop_closure_probability = 0.5;
+  options.min_loop_closure_gap = 4;
+  options.translation_noise = 0.;
+  options.rotation_noise = 0.;
+  const robot::spa::SyntheticGraph3D graph = robot::spa::GenerateGraph3D(options);
+
+  std::mt19937 rng(3);
+  PoseGraph3D pose_graph;
+  for (size_t i = 0; i < graph.ground_truth.size(); ++i) {
+    SE3d pose = robot::spa::ToSE3(graph.ground_truth[i]);
+    if (i > 0) pose = pose * SE3d::Exp(0.05 * RandomPose(&rng).Log());
+    EXPECT_TRUE(pose_graph.AddPose(i, pose));
+  }
+  EXPECT_FALSE(pose_graph.AddPose(0, SE3d()));
+  for (const Constraint3d& constraint : graph.data.constraints) {
+    EXPECT_TRUE(pose_graph.AddConstraint(constraint));
+  }
+  const robot::spa::SolveReport report = pose_graph.Solve();
+  EXPECT_TRUE(report.summary.IsSolutionUsable());
+  EXPECT_EQ(report.num_variable_poses, 29);
+  for (size_t i = 0; i < graph.ground_truth.size(); ++i) {
+    const SE3d error = robot::spa::ToSE3(graph.ground_truth[i]).inverse() * pose_graph.pose(i);
+    EXPECT_LT(error.Log().norm(), 1e-5) << "pose " << i;
+  }
+}
+
+TEST(PoseGraph3DTest, SolvesNoisyGraphBelowGroundTruthCost) {
+  robot::spa::SyntheticGraphOptions options;
+  options.num_poses = 60;
+  options.loop_closure_probability = 0.5;
+  options.min_loop_closure_gap = 5;
+  options.translation_noise = 0.05;
+  options.rotation_noise = 0.05;
+  const robot::spa::SyntheticGraph3D graph = robot::spa::GenerateGraph3D(options);
+
+  PoseGraph3D::Options evaluate_only;
+  evaluate_only.solver.max_num_iterations = 0;
+  PoseGraph3D truth(evaluate_only);
+  PoseGraph3D pose_graph;
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+    truth.AddPose(i, robot::spa::ToSE3(graph.ground_truth[i]));
+    pose_graph.AddPose(i, robot::spa::ToSE3(graph.data.poses[i]));
+  }
+  for (const Constraint3d& constraint : graph.data.constraints) truth.AddConstraint(constraint);
+  // Add half the constraints, solve, then the rest: the second solve extends the problem.
+  const size_t half = graph.data.constraints.size() / 2;
+  for (size_t i = 0; i < half; ++i) pose_graph.AddConstraint(graph.data.constraints[i]);
+  pose_graph.Solve();
+  for (size_t i = half; i < graph.data.constraints.size(); ++i) {
+    pose_graph.AddConstraint(graph.data.constraints[i]);
+  }
+  const robot::spa::SolveReport report = pose_graph.Solve();
+  EXPECT_EQ(report.summary.num_residual_blocks, static_cast<int>(graph.data.constraints.size()));
+  EXPECT_LT(report.summary.final_cost, truth.Solve().summary.initial_cost);
+
+  const robot::spa::PoseGraphData3D data = robot::spa::ToPoseGraphData(pose_graph);
+  EXPECT_EQ(data.poses.size(), graph.data.poses.size());
+  EXPECT_EQ(data.fixed_pose_ids, std::vector<int>{0});
+}
+
+// A planar graph lifted to 3D converges to the same estimate in both solvers.
+TEST(PoseGraph3DTest, MatchesPoseGraph2DOnPlanarGraph) {
+  robot::spa::SyntheticGraphOptions options;
+  options.num_poses = 60;
+  options.loop_closure_probability = 0.5;
+  options.min_loop_closure_gap = 5;
+  options.translation_noise = 0.05;
+  options.rotation_noise = 0.05;
+  const robot::spa::SyntheticGraph2D graph = robot::spa::GenerateGraph2D(options);
+  auto lift = [](const robot::spa::Pose& pose) {
+    return SE3d(Eigen::Vector3d(pose.translation.x(), pose.translation.y(), 0.),
+                Eigen::Quaterniond(
+                    Eigen::AngleAxisd(pose.rotation.angle(), Eigen::Vector3d::UnitZ())));
+  };
+
+  robot::spa::PoseGraph2D planar;
+  PoseGraph3D pose_graph;
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+    planar.AddPose(i, graph.data.poses[i]);
+    pose_graph.AddPose(i, lift(graph.data.poses[i]));
+  }
+  for (const robot::spa::Constraint& constraint : graph.data.constraints) {
+    planar.AddConstraint(constraint);
+    Constraint3d lifted;
+    lifted.source = constraint.source;
+    lifted.target = constraint.target;
+    lifted.relative_pose = robot::spa::ToPose3d(lift(constraint.relative_pose));
+    // The same weights in x, y and yaw; z, roll and pitch are measured exactly as zero.
+    lifted.information = 100. * Matrix6d::Identity();
+    lifted.information.topLeftCorner<2, 2>() = constraint.information.topLeftCorner<2, 2>();
+    lifted.information(5, 5) = 4. * constraint.information(2, 2);
+    pose_graph.AddConstraint(lifted);
+  }
+  planar.Solve();
+  pose_graph.Solve();
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+    const robot::spa::Pose expected = planar.pose(i);
+    const SE3d actual = pose_graph.pose(i);
+    EXPECT_LT((actual.translation().head<2>() - expected.translation).norm(), 1e-4);
+    EXPECT_NEAR(actual.translation().z(), 0., 1e-6);
+    EXPECT_NEAR(robot::common::NormalizeAngle(actual.ToSE2().rotation().angle() -
+                                              expected.rotation.angle()),
+                0., 1e-4);
+  }
+}
+
+TEST(PoseGraph3DTest, RejectsBadConstraints) {
+  PoseGraph3D pose_graph;
+  pose_graph.AddPose(0, SE3d());
+  Constraint3d constraint;
+  constraint.source = 0;
+  constraint.target = 1;
+  constraint.relative_pose = {Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity()};
+  EXPECT_FALSE(pose_graph.AddConstraint(constraint));
+  pose_graph.AddPose(1, SE3d());
+  constraint.information(2, 2) = -1.;
+  EXPECT_FALSE(pose_graph.AddConstraint(constraint));
+  EXPECT_TRUE(pose_graph.constraints().empty());
+}
+
+TEST(PoseGraph3DTest, IgnoresUnknownPoseInSetPoseConstant) {
+  PoseGraph3D pose_graph;
+  pose_graph.AddPose(0, SE3d());
+  pose_graph.AddPose(1, SE3d());
+  Constraint3d constraint;
+  constraint.source = 0;
+  constraint.target = 1;
+  constraint.relative_pose = {Eigen::Vector3d::UnitX(), Eigen::Quaterniond::Identity()};
+  ASSERT_TRUE(pose_graph.AddConstraint(constraint));
+  EXPECT_FALSE(pose_graph.SetPoseConstant(42, true));
+  EXPECT_FALSE(pose_graph.IsPoseConstant(42));
+  const robot::spa::SolveReport report = pose_graph.Solve();
+  EXPECT_TRUE(report.summary.IsSolutionUsable());
+  EXPECT_EQ(report.num_variable_poses, 1);
+  EXPECT_TRUE(pose_graph.pose(1).translation().isApprox(Eigen::Vector3d::UnitX(), 1e-6));
+}
+
+TEST(PoseGraph3DTest, ComputesCovarianceInPoseFrame) {
+  std::mt19937 rng(7);
+  PoseGraph3D::Options options;
+  options.loss.type = robot::spa::RobustLossOptions::Type::kTrivial;
+  PoseGraph3D pose_graph(options);
+  const SE3d anchor = RandomPose(&rng);
+  const SE3d relative_pose = RandomPose(&rng);
+  pose_graph.AddPose(0, anchor);
+  pose_graph.AddPose(1, anchor * relative_pose);
+  Constraint3d constraint;
+  constraint.source = 0;
+  constraint.target = 1;
+  constraint.relative_pose = robot::spa::ToPose3d(relative_pose);
+  const Matrix6d random = Matrix6d::Random();
+  constraint.information = random * random.transpose() + Matrix6d::Identity();
+  ASSERT_TRUE(pose_graph.AddConstraint(constraint));
+  pose_graph.Solve();
+
+  // The residual is the right perturbation of pose 1 itself, so its covariance is the inverse of
+  // the constraint's tangent information.
+  Matrix6d covariance;
+  ASSERT_TRUE(pose_graph.ComputeCovariance(1, &covariance));
+  EXPECT_TRUE(covariance.isApprox(
+      robot::spa::TangentInformation(constraint.information).inverse(), 1e-6));
+  ASSERT_TRUE(pose_graph.ComputeCovariance(0, &covariance));
+  EXPECT_TRUE(covariance.isZero());
+}
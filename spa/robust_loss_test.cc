@@ -0,0 +1,219 @@
+#include "robust_loss.h"
+
+#include <gtest/gtest.h>
+
+#include "pose_graph_2d.h"
+#include "pose_graph_3d.h"
+#include "synthetic_graph.h"
+
+using robot::spa::RobustLossOptions;
+
+namespace {
+
+// First and second derivatives of `loss` match central differences of rho(s).
+void ExpectConsistentDerivatives(const ceres::LossFunction& loss, double s) {
+  const double step = 1e-5 * std::max(1., s);
+  double rho[3], plus[3], minus[3];
+  loss.Evaluate(s, rho);
+  loss.Evaluate(s + step, plus);
+  loss.Evaluate(s - step, minus);
+  EXPECT_NEAR(rho[1], (plus[0] - minus[0]) / (2. * step), 1e-6) << "s = " << s;
+  EXPECT_NEAR(rho[2], (plus[1] - minus[1]) / (2. * step), 1e-6) << "s = " << s;
+}
+
+robot::spa::SyntheticGraph2D MakeGraphWithOutliers() {
+  robot::spa::SyntheticGraphOptions options;
+  options.num_poses = 100;
+  options.loop_closure_probability = 0.5;
+  options.min_loop_closure_gap = 5;
+  options.outlier_rate = 0.3;
+  return robot::spa::GenerateGraph2D(options);
+}
+
+}  // namespace
+
+TEST(RobustLossTest, MakesEveryKernel) {
+  RobustLossOptions options;
+  for (auto type : {RobustLossOptions::Type::kHuber, RobustLossOptions::Type::kCauchy,
+                    RobustLossOptions::Type::kTukey, RobustLossOptions::Type::kDcs}) {
+    options.type = type;
+    EXPECT_NE(robot::spa::MakeLossFunction(options), nullptr);
+  }
+  options.type = RobustLossOptions::Type::kTrivial;
+  EXPECT_EQ(robot::spa::MakeLossFunction(options), nullptr);
+  options.type = RobustLossOptions::Type::kSwitchable;
+  EXPECT_EQ(robot::spa::MakeLossFunction(options), nullptr);
+}
+
+TEST(RobustLossTest, DcsIsQuadraticUpToPhiAndContinuousPastIt) {
+  const robot::spa::DcsLoss loss(2.);
+  double rho[3];
+  loss.Evaluate(1., rho);
+  EXPECT_DOUBLE_EQ(rho[0], 1.);
+  EXPECT_DOUBLE_EQ(rho[1], 1.);
+  loss.Evaluate(2. + 1e-12, rho);
+  EXPECT_NEAR(rho[0], 2., 1e-9);
+  EXPECT_NEAR(rho[1], 1., 1e-9);
+  // Past phi the weight is the squared DCS scale factor.
+  loss.Evaluate(6., rho);
+  EXPECT_DOUBLE_EQ(rho[1], (2. * 2. / (2. + 6.)) * (2. * 2. / (2. + 6.)));
+  for (double s : {3., 10., 100.}) ExpectConsistentDerivatives(loss, s);
+}
+
+TEST(SwitchableCostFunctionTest, ScalesResidualsAndDifferentiatesSwitch) {
+  // r = x - 3 around a 1-parameter block.
+  class Offset : public ceres::SizedCostFunction<1, 1> {
+   public:
+    bool Evaluate(const double* const* parameters, double* residuals,
+                  double** jacobians) const override {
+      residuals[0] = parameters[0][0] - 3.;
+      if (jacobians && jacobians[0]) jacobians[0][0] = 1.;
+      return true;
+    }
+  };
+  const robot::spa::SwitchableCostFunction cost_function(new Offset);
+  ASSERT_EQ(cost_function.parameter_block_sizes().size(), 2u);
+  EXPECT_EQ(cost_function.parameter_block_sizes()[1], 1);
+  const double x = 5., weight = 0.25;
+  const double* parameters[2] = {&x, &weight};
+  double residual, jacobian_x, jacobian_switch;
+  double* jacobians[2] = {&jacobian_x, &jacobian_switch};
+  ASSERT_TRUE(cost_function.Evaluate(parameters, &residual, jacobians));
+  EXPECT_DOUBLE_EQ(residual, 0.5);
+  EXPECT_DOUBLE_EQ(jacobian_x, 0.25);
+  EXPECT_DOUBLE_EQ(jacobian_switch, 2.);
+}
+
+TEST(OutlierRejectionTest, RejectsFalseLoopClosures2D) {
+  const robot::spa::SyntheticGraph2D graph = MakeGraphWithOutliers();
+  robot::spa::PoseGraph2D::Options options;
+  options.outlier_rejection.enabled = true;
+  robot::spa::PoseGraph2D pose_graph(options);
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) pose_graph.AddPose(i, graph.data.poses[i]);
+  int num_outliers = 0;
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    pose_graph.AddConstraint(graph.data.constraints[i]);
+    num_outliers += graph.is_outlier[i];
+  }
+  ASSERT_GT(num_outliers, 3);
+  const robot::spa::SolveReport report = pose_graph.Solve();
+  EXPECT_EQ(report.num_rejected_constraints, num_outliers);
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    EXPECT_EQ(pose_graph.IsConstraintRejected(i), graph.is_outlier[i]) << "constraint " << i;
+  }
+  EXPECT_EQ(report.summary.num_residual_blocks,
+            static_cast<int>(graph.data.constraints.size()) - num_outliers);
+  // The rejected constraints stay rejected, and nothing new needs vetting.
+  EXPECT_EQ(pose_graph.Solve().num_rejected_constraints, 0);
+}
+
+TEST(OutlierRejectionTest, VetsLoopClosuresAPartialSolveUsed2D) {
+  const robot::spa::SyntheticGraph2D graph = MakeGraphWithOutliers();
+  robot::spa::PoseGraph2D::Options options;
+  options.outlier_rejection.enabled = true;
+  robot::spa::PoseGraph2D pose_graph(options);
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) pose_graph.AddPose(i, graph.data.poses[i]);
+  int num_outliers = 0;
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    pose_graph.AddConstraint(graph.data.constraints[i]);
+    num_outliers += graph.is_outlier[i];
+  }
+  ASSERT_GT(num_outliers, 3);
+  // Incremental solves skip outlier rejection, which the next batch solve catches up on.
+  EXPECT_EQ(pose_graph.Solve(robot::spa::PoseGraph2D::SolveMode::kIncremental)
+                .num_rejected_constraints,
+            0);
+  const robot::spa::SolveReport report =
+      pose_graph.Solve(robot::spa::PoseGraph2D::SolveMode::kBatch);
+  EXPECT_EQ(report.num_rejected_constraints, num_outliers);
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    EXPECT_EQ(pose_graph.IsConstraintRejected(i), graph.is_outlier[i]) << "constraint " << i;
+  }
+  EXPECT_EQ(report.summary.num_residual_blocks,
+            static_cast<int>(graph.data.constraints.size()) - num_outliers);
+}
+
+TEST(OutlierRejectionTest, SwitchesOffFalseLoopClosures2D) {
+  const robot::spa::SyntheticGraph2D graph = MakeGraphWithOutliers();
+  robot::spa::PoseGraph2D::Options options;
+  options.loss.type = RobustLossOptions::Type::kSwitchable;
+  options.loss.switch_prior_stddev = 0.1;
+  robot::spa::PoseGraph2D pose_graph(options);
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) pose_graph.AddPose(i, graph.data.poses[i]);
+  for (const robot::spa::Constraint& constraint : graph.data.constraints) {
+    pose_graph.AddConstraint(constraint);
+  }
+  pose_graph.Solve();
+  // Every false loop closure is switched off. The tight prior keeps a true loop closure from
+  // being switched off just because it disagrees with the drifted odometry by a few sigma.
+  int num_inliers = 0, num_inliers_on = 0;
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    if (!pose_graph.IsLoopClosure(i)) {
+      EXPECT_EQ(pose_graph.constraint_switch(i), 1.);
+    } else if (graph.is_outlier[i]) {
+      EXPECT_LT(pose_graph.constraint_switch(i), 0.1) << "constraint " << i;
+    } else {
+      ++num_inliers;
+      num_inliers_on += pose_graph.constraint_switch(i) > 0.9;
+    }
+  }
+  EXPECT_GT(num_inliers_on, num_inliers / 2);
+}
+
+TEST(OutlierRejectionTest, RejectsFalseLoopClosures3D) {
+  robot::spa::SyntheticGraphOptions synthetic;
+  synthetic.num_poses = 100;
+  synthetic.loop_closure_probability = 1.;
+  synthetic.min_loop_closure_gap = 5;
+  synthetic.outlier_rate = 0.3;
+  const robot::spa::SyntheticGraph3D graph = robot::spa::GenerateGraph3D(synthetic);
+  robot::spa::PoseGraph3D::Options options;
+  options.outlier_rejection.enabled = true;
+  robot::spa::PoseGraph3D pose_graph(options);
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+    pose_graph.AddPose(i, robot::spa::ToSE3(graph.data.poses[i]));
+  }
+  int num_outliers = 0;
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    pose_graph.AddConstraint(graph.data.constraints[i]);
+    num_outliers += graph.is_outlier[i];
+  }
+  ASSERT_GT(num_outliers, 0);
+  EXPECT_EQ(pose_graph.Solve().num_rejected_constraints, num_outliers);
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    EXPECT_EQ(pose_graph.IsConstraintRejected(i), graph.is_outlier[i]) << "constraint " << i;
+  }
+  EXPECT_EQ(pose_graph.Solve().num_rejected_constraints, 0);
+}
+
+// Vetting weighs switchable loop closures by the GNC loss alone; a gross outlier must not get past
+// it on the strength of its switch.
+TEST(OutlierRejectionTest, RejectsGrossOutlierAmongSwitchableLoopClosures3D) {
+  robot::spa::SyntheticGraphOptions synthetic;
+  synthetic.num_poses = 60;
+  synthetic.loop_closure_probability = 0.5;
+  synthetic.min_loop_closure_gap = 5;
+  robot::spa::SyntheticGraph3D graph = robot::spa::GenerateGraph3D(synthetic);
+  robot::spa::Constraint3d outlier;
+  outlier.source = 10;
+  outlier.target = 50;
+  outlier.relative_pose.translation = Eigen::Vector3d(40., -25., 10.);
+  outlier.relative_pose.rotation = Eigen::AngleAxisd(2.5, Eigen::Vector3d::UnitZ());
+  graph.data.constraints.push_back(outlier);
+
+  robot::spa::PoseGraph3D::Options options;
+  options.loss.type = RobustLossOptions::Type::kSwitchable;
+  options.outlier_rejection.enabled = true;
+  robot::spa::PoseGraph3D pose_graph(options);
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+    pose_graph.AddPose(i, robot::spa::ToSE3(graph.data.poses[i]));
+  }
+  for (const robot::spa::Constraint3d& constraint : graph.data.constraints) {
+    pose_graph.AddConstraint(constraint);
+  }
+  EXPECT_EQ(pose_graph.Solve().num_rejected_constraints, 1);
+  const int outlier_index = graph.data.constraints.size() - 1;
+  for (int i = 0; i <= outlier_index; ++i) {
+    EXPECT_EQ(pose_graph.IsConstraintRejected(i), i == outlier_index) << "constraint " << i;
+  }
+}
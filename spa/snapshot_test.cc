@@ -0,0 +1,163 @@
+#include "snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "version.h"
+
+using robot::spa::Constraint;
+using robot::spa::PoseGraph2D;
+using robot::spa::PoseGraphSnapshot;
+using robot::spa::SnapshotHeader;
+using robot::spa::WriteSnapshot;
+
+namespace {
+
+std::vector<char> ReadFile(const std::string& path) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  std::vector<char> contents;
+  char buffer[4096];
+  size_t size;
+  while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.insert(contents.end(), buffer, buffer + size);
+  }
+  std::fclose(file);
+  return contents;
+}
+
+void WriteFile(const std::string& path, const std::vector<char>& contents) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  std::fwrite(contents.data(), 1, contents.size(), file);
+  std::fclose(file);
+}
+
+robot::spa::PoseGraphData2D MakeData2D() {
+  robot::spa::PoseGraphData2D data;
+  data.pose_ids = {3, 5, 8};
+  data.poses = {{Eigen::Vector2d(0., 0.), Eigen::Rotation2Dd(0.)},
+                {Eigen::Vector2d(1.1, 0.1), Eigen::Rotation2Dd(0.05)},
+                {Eigen::Vector2d(2.2, -0.1), Eigen::Rotation2Dd(-0.05)}};
+  Constraint constraint;
+  constraint.relative_pose = {Eigen::Vector2d(1., 0.), Eigen::Rotation2Dd(0.)};
+  constraint.source = 3;
+  constraint.target = 5;
+  data.constraints.push_back(constraint);
+  constraint.source = 5;
+  constraint.target = 8;
+  constraint.information << 4, 1, 0, 1, 4, 0, 0, 0, 9;
+  data.constraints.push_back(constraint);
+  data.fixed_pose_ids = {3};
+  return data;
+}
+
+TEST(SnapshotTest, RoundTrips2D) {
+  const robot::spa::PoseGraphData2D data = MakeData2D();
+  const std::string path = ::testing::TempDir() + "graph2d.snapshot";
+  ASSERT_TRUE(WriteSnapshot(path, data));
+
+  PoseGraphSnapshot snapshot;
+  std::string error;
+  ASSERT_TRUE(snapshot.Open(path, &error)) << error;
+  EXPECT_EQ(snapshot.dimension(), 2);
+  EXPECT_EQ(snapshot.version_major(), VERSION_MAJOR);
+  EXPECT_EQ(snapshot.version_minor(), VERSION_MINOR);
+  ASSERT_EQ(snapshot.num_poses(), 3u);
+  ASSERT_EQ(snapshot.num_constraints(), 2u);
+  EXPECT_EQ(snapshot.constraints_3d(), nullptr);
+  EXPECT_EQ(snapshot.pose_ids()[2], 8);
+  EXPECT_EQ(snapshot.poses()[3], 1.1);
+  EXPECT_EQ(snapshot.poses()[5], 0.05);
+  EXPECT_EQ(snapshot.constraints_2d()[1].target, 8);
+  EXPECT_EQ(Eigen::Map<const Eigen::Matrix3d>(snapshot.constraints_2d()[1].information),
+            data.constraints[1].information);
+  ASSERT_EQ(snapshot.num_fixed_poses(), 1u);
+  EXPECT_EQ(snapshot.fixed_pose_ids()[0], 3);
+}
+
+TEST(SnapshotTest, RestoresPoseGraph) {
+  PoseGraph2D original;
+  const robot::spa::PoseGraphData2D data = MakeData2D();
+  for (size_t i = 0; i < data.poses.size(); ++i) original.AddPose(data.pose_ids[i], data.poses[i]);
+  for (const Constraint& constraint : data.constraints) original.AddConstraint(constraint);
+  original.SetPoseConstant(8, true);
+  const std::string path = ::testing::TempDir() + "graph.snapshot";
+  ASSERT_TRUE(WriteSnapshot(path, original));
+
+  PoseGraphSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Open(path));
+  PoseGraph2D restored;
+  std::string error;
+  ASSERT_TRUE(robot::spa::AddToPoseGraph(snapshot, &restored, &error)) << error;
+  EXPECT_EQ(restored.pose_ids(), original.pose_ids());
+  EXPECT_TRUE(restored.IsPoseConstant(3));
+  EXPECT_FALSE(restored.IsPoseConstant(5));
+  EXPECT_TRUE(restored.IsPoseConstant(8));
+  ASSERT_EQ(restored.constraints().size(), 2u);
+  EXPECT_EQ(restored.constraints()[1].information, data.constraints[1].information);
+
+  original.Solve();
+  restored.Solve();
+  for (int id : original.pose_ids()) {
+    EXPECT_EQ(restored.pose(id).translation, original.pose(id).translation);
+    EXPECT_EQ(restored.pose(id).rotation.angle(), original.pose(id).rotation.angle());
+  }
+}
+
+TEST(SnapshotTest, RoundTrips3D) {
+  robot::spa::PoseGraphData3D data;
+  data.pose_ids = {0, 1};
+  data.poses = {{Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity()},
+                {Eigen::Vector3d(1., 2., 3.), Eigen::Quaterniond(0.5, 0.5, 0.5, 0.5)}};
+  robot::spa::Constraint3d constraint;
+  constraint.source = 0;
+  constraint.target = 1;
+  constraint.relative_pose = data.poses[1];
+  constraint.information(2, 4) = constraint.information(4, 2) = 0.5;
+  data.constraints = {constraint};
+  const std::string path = ::testing::TempDir() + "graph3d.snapshot";
+  ASSERT_TRUE(WriteSnapshot(path, data));
+
+  PoseGraphSnapshot snapshot;
+  ASSERT_TRUE(snapshot.Open(path));
+  EXPECT_EQ(snapshot.dimension(), 3);
+  EXPECT_EQ(snapshot.constraints_2d(), nullptr);
+  const double expected_pose[7] = {1., 2., 3., 0.5, 0.5, 0.5, 0.5};
+  for (int i = 0; i < 7; ++i) EXPECT_EQ(snapshot.poses()[7 + i], expected_pose[i]);
+  EXPECT_EQ((Eigen::Map<const Eigen::Matrix<double, 6, 6>>(
+                snapshot.constraints_3d()[0].information)),
+            constraint.information);
+  PoseGraph2D graph;
+  EXPECT_FALSE(robot::spa::AddToPoseGraph(snapshot, &graph));
+}
+
+TEST(SnapshotTest, RejectsIncompatibleOrDamagedFiles) {
+  const std::string path = ::testing::TempDir() + "damaged.snapshot";
+  ASSERT_TRUE(WriteSnapshot(path, MakeData2D()));
+  const std::vector<char> contents = ReadFile(path);
+  PoseGraphSnapshot snapshot;
+  std::string error;
+
+  std::vector<char> newer = contents;
+  reinterpret_cast<SnapshotHeader*>(newer.data())->version_minor = VERSION_MINOR + 1;
+  WriteFile(path, newer);
+  EXPECT_FALSE(snapshot.Open(path, &error));
+  EXPECT_NE(error.find("version"), std::string::npos) << error;
+
+  std::vector<char> other_major = contents;
+  reinterpret_cast<SnapshotHeader*>(other_major.data())->version_major = VERSION_MAJOR + 1;
+  WriteFile(path, other_major);
+  EXPECT_FALSE(snapshot.Open(path, &error));
+
+  WriteFile(path, std::vector<char>(contents.begin(), contents.end() - 1));
+  EXPECT_FALSE(snapshot.Open(path, &error));
+  EXPECT_NE(error.find("truncated"), std::string::npos) << error;
+
+  WriteFile(path, std::vector<char>(100, 'x'));
+  EXPECT_FALSE(snapshot.Open(path, &error));
+  EXPECT_NE(error.find("not a pose graph snapshot"), std::string::npos) << error;
+}
+
+}  // namespace
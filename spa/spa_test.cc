@@ -2,18 +2,20 @@
 #include <gtest/gtest.h>
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
 
-struct Pose {
-  Eigen::Vector2d translation;
-  Eigen::Rotation2Dd rotation;
-};
+#include "cost_functors.h"
+#include "pose_graph_2d.h"
 
-struct Constraint {
-  int source;
-  int target;
-  Pose relative_pose;
-};
+using robot::spa::Constraint;
+using robot::spa::OptimizeAnalyticCostFunctor;
+using robot::spa::OptimizeAutodiffCostFunctor;
+using robot::spa::Pose;
+using robot::spa::PoseGraph2D;
 
 struct TestCase {
   TestCase() {
@@ -52,198 +54,6 @@ struct TestCase {
   std::map<int, Pose> poses;
 };
 
-template <typename T>
-T NormalizeAngleDifference(T difference) {
-  const T kPi = T(M_PI);
-  while (difference > kPi) difference -= 2. * kPi;
-  while (difference < -kPi) difference += 2. * kPi;
-  return difference;
-}
-class SpaCostFunctor {
- public:
-  SpaCostFunctor(const Pose& observed, const Eigen::Matrix3d& sqrt_information)
-      : x_(observed.translation.x()),
-        y_(observed.translation.y()),
-        theta_(observed.rotation.angle()),
-        sqrt_information_(sqrt_information) {}
-  ~SpaCostFunctor() {}
-
-  template <typename T>
-  bool operator()(const T* const source_x, const T* const source_y, const T* const source_theta,
-                  const T* const target_x, const T* const target_y, const T* const target_theta,
-                  T* residual) const {
-    const T source_cos = cos(*source_theta);
-    const T source_sin = sin(*source_theta);
-    const T delta_x = *target_x - *source_x;
-    const T delta_y = *target_y - *source_y;
-    Eigen::Map<Eigen::Matrix<T, 3, 1>> residual_map(residual);
-    residual_map(0) = static_cast<T>(x_) - (source_cos * delta_x + source_sin * delta_y);
-    residual_map(1) = static_cast<T>(y_) - (source_cos * delta_y - source_sin * delta_x);
-    residual_map(2) =
-        NormalizeAngleDifference(static_cast<T>(theta_) - (*target_theta - *source_theta));
-    residual_map = sqrt_information_.template cast<T>() * residual_map;
-    return true;
-  }
-
- private:
-  const double x_;
-  const double y_;
-  const double theta_;
-  const Eigen::Matrix3d& sqrt_information_;
-};
-
-class SpaCostFunctorAnalytic : public ceres::SizedCostFunction<3, 1, 1, 1, 1, 1, 1> {
- public:
-  SpaCostFunctorAnalytic(const Pose& observed, const Eigen::Matrix3d& sqrt_information)
-      : x_(observed.translation.x()),
-        y_(observed.translation.y()),
-        theta_(observed.rotation.angle()),
-        sqrt_information_(sqrt_information) {}
-  virtual ~SpaCostFunctorAnalytic() {}
-
-  bool Evaluate(const double* const* parameters, double* residuals, double** jacobians) const {
-    const double cos_source_theta = cos(parameters[2][0]);
-    const double sin_source_theta = sin(parameters[2][0]);
-    const double dx = parameters[3][0] - parameters[0][0];
-    const double dy = parameters[4][0] - parameters[1][0];
-
-    Eigen::Map<Eigen::Vector3d> residual_map(residuals);
-    residual_map(0) = x_ - (cos_source_theta * dx + sin_source_theta * dy);
-    residual_map(1) = y_ - (cos_source_theta * dy - sin_source_theta * dx);
-    residual_map(2) = NormalizeAngleDifference(theta_ - (parameters[5][0] - parameters[2][0]));
-    residual_map = sqrt_information_ * residual_map;
-
-    if (!jacobians) return true;
-
-    double* jacobian_source_x = jacobians[0];
-    double* jacobian_source_y = jacobians[1];
-    double* jacobian_source_theta = jacobians[2];
-    double* jacobian_target_x = jacobians[3];
-    double* jacobian_target_y = jacobians[4];
-    double* jacobian_target_theta = jacobians[5];
-
-    // Some sub-expressions
-    const double unweighted_jacobians_02 = sin_source_theta * dx - cos_source_theta * dy;
-    const double unweighted_jacobians_12 = cos_source_theta * dx + sin_source_theta * dy;
-    const double cos_source_theta_00 = sqrt_information_(0, 0) * cos_source_theta;
-    const double cos_source_theta_10 = sqrt_information_(1, 0) * cos_source_theta;
-    const double cos_source_theta_20 = sqrt_information_(2, 0) * cos_source_theta;
-    const double cos_source_theta_01 = sqrt_information_(0, 1) * cos_source_theta;
-    const double cos_source_theta_11 = sqrt_information_(1, 1) * cos_source_theta;
-    const double cos_source_theta_21 = sqrt_information_(2, 1) * cos_source_theta;
-    const double sin_source_theta_00 = sqrt_information_(0, 0) * sin_source_theta;
-    const double sin_source_theta_01 = sqrt_information_(0, 1) * sin_source_theta;
-    const double sin_source_theta_10 = sqrt_information_(1, 0) * sin_source_theta;
-    const double sin_source_theta_11 = sqrt_information_(1, 1) * sin_source_theta;
-    const double sin_source_theta_20 = sqrt_information_(2, 0) * sin_source_theta;
-    const double sin_source_theta_21 = sqrt_information_(2, 1) * sin_source_theta;
-
-    if (jacobian_source_x) {
-      jacobian_source_x[0] = cos_source_theta_00 - sin_source_theta_01;
-      jacobian_source_x[1] = cos_source_theta_10 - sin_source_theta_11;
-      jacobian_source_x[2] = cos_source_theta_20 - sin_source_theta_21;
-    }
-    if (jacobian_source_y) {
-      jacobian_source_y[0] = sin_source_theta_00 + cos_source_theta_01;
-      jacobian_source_y[1] = sin_source_theta_10 + cos_source_theta_11;
-      jacobian_source_y[2] = sin_source_theta_20 + cos_source_theta_21;
-    }
-    if (jacobian_source_theta) {
-      jacobian_source_theta[0] = sqrt_information_(0, 0) * unweighted_jacobians_02 +
-                                 sqrt_information_(0, 1) * unweighted_jacobians_12;
-      jacobian_source_theta[1] = sqrt_information_(1, 0) * unweighted_jacobians_02 +
-                                 sqrt_information_(1, 1) * unweighted_jacobians_12;
-      jacobian_source_theta[2] = sqrt_information_(2, 0) * unweighted_jacobians_02 +
-                                 sqrt_information_(2, 1) * unweighted_jacobians_12;
-    }
-    if (jacobian_target_x) {
-      if (jacobian_source_x) {
-        jacobian_target_x[0] = -jacobian_source_x[0];
-        jacobian_target_x[1] = -jacobian_source_x[1];
-        jacobian_target_x[2] = -jacobian_source_x[2];
-      } else {
-        jacobian_target_x[0] = sin_source_theta_01 - cos_source_theta_00;
-        jacobian_target_x[1] = sin_source_theta_11 - cos_source_theta_10;
-        jacobian_target_x[2] = sin_source_theta_21 - cos_source_theta_20;
-      }
-    }
-    if (jacobian_target_y) {
-      if (jacobian_source_y) {
-        jacobian_target_y[0] = -jacobian_source_y[0];
-        jacobian_target_y[1] = -jacobian_source_y[1];
-        jacobian_target_y[2] = -jacobian_source_y[2];
-      } else {
-        jacobian_target_y[0] = -sin_source_theta_00 - cos_source_theta_01;
-        jacobian_target_y[1] = -sin_source_theta_10 - cos_source_theta_11;
-        jacobian_target_y[2] = -sin_source_theta_20 - cos_source_theta_21;
-      }
-    }
-    if (jacobian_target_theta) {
-      jacobian_target_theta[0] = -sqrt_information_(0, 2);
-      jacobian_target_theta[1] = -sqrt_information_(1, 2);
-      jacobian_target_theta[2] = -sqrt_information_(2, 2);
-    }
-    return true;
-  }
-
- private:
-  const double x_;
-  const double y_;
-  const double theta_;
-  const Eigen::Matrix3d sqrt_information_;
-};
-
-void OptimizeAutodiffCostFunctor(const std::vector<Constraint>& constraints,
-                                 std::map<int, Pose>* poses_ptr) {
-  Eigen::Matrix3d information_matrix = Eigen::Matrix3d::Identity();
-  Eigen::Matrix3d sqrt_information = information_matrix.llt().matrixU();
-  auto& poses = *poses_ptr;
-  ceres::Problem problem;
-  for (const auto& constraint : constraints) {
-    auto& source = poses[constraint.source];
-    auto& target = poses[constraint.target];
-    problem.AddResidualBlock(new ceres::AutoDiffCostFunction<SpaCostFunctor, 3, 1, 1, 1, 1, 1, 1>(
-                                 new SpaCostFunctor(constraint.relative_pose, sqrt_information)),
-                             new ceres::HuberLoss(1.0), &source.translation.x(),
-                             &source.translation.y(), &source.rotation.angle(),
-                             &target.translation.x(), &target.translation.y(),
-                             &target.rotation.angle());
-  }
-  auto& reference_pose = poses[0];
-  problem.SetParameterBlockConstant(&reference_pose.translation.x());
-  problem.SetParameterBlockConstant(&reference_pose.translation.y());
-  problem.SetParameterBlockConstant(&reference_pose.rotation.angle());
-  ceres::Solver::Options options;
-  ceres::Solver::Summary summary;
-  options.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
-  ceres::Solve(options, &problem, &summary);
-}
-
-void OptimizeAnalyticCostFunctor(const std::vector<Constraint>& constraints,
-                                 std::map<int, Pose>* poses_ptr) {
-  Eigen::Matrix3d information_matrix = Eigen::Matrix3d::Identity();
-  Eigen::Matrix3d sqrt_information = information_matrix.llt().matrixU();
-  auto& poses = *poses_ptr;
-  ceres::Problem problem;
-  for (const auto& constraint : constraints) {
-    auto& source = poses[constraint.source];
-    auto& target = poses[constraint.target];
-    problem.AddResidualBlock(new SpaCostFunctorAnalytic(constraint.relative_pose, sqrt_information),
-                             new ceres::HuberLoss(1.0), &source.translation.x(),
-                             &source.translation.y(), &source.rotation.angle(),
-                             &target.translation.x(), &target.translation.y(),
-                             &target.rotation.angle());
-  }
-  auto& reference_pose = poses[0];
-  problem.SetParameterBlockConstant(&reference_pose.translation.x());
-  problem.SetParameterBlockConstant(&reference_pose.translation.y());
-  problem.SetParameterBlockConstant(&reference_pose.rotation.angle());
-  ceres::Solver::Options options;
-  ceres::Solver::Summary summary;
-  options.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
-  ceres::Solve(options, &problem, &summary);
-}
-
 TEST(OptimizeAutodiffCostFunctorTest, SpaTest) {
   TestCase tc;
   OptimizeAutodiffCostFunctor(tc.constraints, &tc.poses);
@@ -272,6 +82,488 @@ TEST(OptimizeAnalyticCostFunctorTest, SpaTest) {
   EXPECT_NEAR(tc.poses[2].rotation.angle(), -M_PI / 2, 1e-6);
 }
 
+// Without a pose 0 the lowest id is the anchor, and no pose is made up for id 0. Constraints
+// to unknown poses are counted, not solved.
+TEST(OptimizeAnalyticCostFunctorTest, AnchorsLowestIdAndCountsInvalidConstraints) {
+  TestCase tc;
+  std::map<int, Pose> poses;
+  for (const auto& id_pose : tc.poses) poses[id_pose.first + 10] = id_pose.second;
+  std::vector<Constraint> constraints = tc.constraints;
+  for (Constraint& constraint : constraints) {
+    constraint.source += 10;
+    constraint.target += 10;
+  }
+  Constraint dangling = constraints[0];
+  dangling.target = 0;
+  constraints.push_back(dangling);
+  const robot::spa::SolveReport report = OptimizeAnalyticCostFunctor(constraints, &poses);
+  EXPECT_EQ(report.num_invalid_constraints, 1);
+  EXPECT_EQ(report.num_poses, 3);
+  ASSERT_EQ(poses.size(), 3u);
+  EXPECT_EQ(poses.count(0), 0u);
+  EXPECT_EQ(poses[10].translation, tc.poses[0].translation);
+  EXPECT_NEAR(poses[11].translation.x(), 4.0, 1e-6);
+  EXPECT_NEAR(poses[12].translation.y(), 4.0, 1e-6);
+}
+
+void ExpectSolution(const PoseGraph2D& graph, double tolerance = 1e-6) {
+  EXPECT_NEAR(graph.pose(0).translation.x(), 0.0, tolerance);
+  EXPECT_NEAR(graph.pose(0).translation.y(), 0.0, tolerance);
+  EXPECT_NEAR(graph.pose(0).rotation.angle(), 0.0, tolerance);
+  EXPECT_NEAR(graph.pose(1).translation.x(), 4.0, tolerance);
+  EXPECT_NEAR(graph.pose(1).translation.y(), 0.0, tolerance);
+  EXPECT_NEAR(graph.pose(1).rotation.angle(), M_PI / 2, tolerance);
+  EXPECT_NEAR(graph.pose(2).translation.x(), 0.0, tolerance);
+  EXPECT_NEAR(graph.pose(2).translation.y(), 4.0, tolerance);
+  EXPECT_NEAR(graph.pose(2).rotation.angle(), -M_PI / 2, tolerance);
+}
+
+TEST(PoseGraph2DTest, SolvesIncrementally) {
+  TestCase tc;
+  PoseGraph2D graph;
+  for (const auto& id_pose : tc.poses) EXPECT_TRUE(graph.AddPose(id_pose.first, id_pose.second));
+  EXPECT_FALSE(graph.AddPose(0, tc.poses[0]));
+  EXPECT_TRUE(graph.AddConstraint(tc.constraints[0]));
+  EXPECT_TRUE(graph.AddConstraint(tc.constraints[1]));
+  graph.Solve();
+
+  EXPECT_TRUE(graph.AddConstraint(tc.constraints[2]));
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_TRUE(report.summary.IsSolutionUsable());
+  EXPECT_EQ(report.num_poses, 3);
+  EXPECT_EQ(report.num_constraints, 3);
+  EXPECT_EQ(report.summary.num_residual_blocks, 3);
+  ExpectSolution(graph);
+}
+
+TEST(PoseGraph2DTest, RejectsConstraintToUnknownPose) {
+  TestCase tc;
+  PoseGraph2D graph;
+  graph.AddPose(0, tc.poses[0]);
+  EXPECT_FALSE(graph.AddConstraint(tc.constraints[0]));
+  EXPECT_TRUE(graph.constraints().empty());
+}
+
+TEST(PoseGraph2DTest, IgnoresUnknownPoseInSetters) {
+  TestCase tc;
+  PoseGraph2D graph;
+  for (const auto& id_pose : tc.poses) graph.AddPose(id_pose.first, id_pose.second);
+  for (const Constraint& constraint : tc.constraints) graph.AddConstraint(constraint);
+  EXPECT_FALSE(graph.SetPose(42, tc.poses[1]));
+  EXPECT_FALSE(graph.HasPose(42));
+  EXPECT_TRUE(graph.SetPose(2, tc.poses[1]));
+  EXPECT_EQ(graph.pose(2).translation, tc.poses[1].translation);
+  EXPECT_FALSE(graph.SetPoseConstant(42, true));
+  EXPECT_FALSE(graph.IsPoseConstant(42));
+  EXPECT_TRUE(graph.SetPoseConstant(1, true));
+  EXPECT_TRUE(graph.IsPoseConstant(1));
+  // Solve() reaches every constant pose's block, which an unknown id would throw on.
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_TRUE(report.summary.IsSolutionUsable());
+  EXPECT_EQ(report.num_variable_poses, 1);
+}
+
+TEST(PoseGraph2DTest, RebuildsProblemWhenPoseStorageGrows) {
+  TestCase tc;
+  PoseGraph2D graph;
+  graph.AddPose(0, tc.poses[0]);
+  graph.AddPose(1, tc.poses[1]);
+  graph.AddConstraint(tc.constraints[0]);
+  graph.Solve();
+
+  // Adding poses past the initial capacity moves every pose block.
+  graph.AddPose(2, tc.poses[2]);
+  for (int id = 3; id < 64; ++id) graph.AddPose(id, tc.poses[0]);
+  graph.AddConstraint(tc.constraints[1]);
+  graph.AddConstraint(tc.constraints[2]);
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_EQ(report.summary.num_residual_blocks, 3);
+  ExpectSolution(graph);
+}
+
+TEST(PoseGraph2DTest, SolvesWithIterativeSchurOnThreads) {
+  TestCase tc;
+  PoseGraph2D::Options options;
+  options.solver.num_threads = 4;
+  options.solver.linear_solver_type = ceres::ITERATIVE_SCHUR;
+  options.solver.preconditioner_type = ceres::SCHUR_JACOBI;
+  PoseGraph2D graph(options);
+  for (const auto& id_pose : tc.poses) graph.AddPose(id_pose.first, id_pose.second);
+  for (const auto& constraint : tc.constraints) graph.AddConstraint(constraint);
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_EQ(report.summary.num_threads_given, 4);
+  ExpectSolution(graph);
+}
+
+TEST(PoseGraph2DTest, SolvesInFloatAndSwitchesPrecision) {
+  TestCase tc;
+  PoseGraph2D::Options options;
+  options.evaluation_precision = robot::spa::EvaluationPrecision::kFloat;
+  PoseGraph2D graph(options);
+  for (const auto& id_pose : tc.poses) graph.AddPose(id_pose.first, id_pose.second);
+  for (const auto& constraint : tc.constraints) graph.AddConstraint(constraint);
+  graph.Solve();
+  ExpectSolution(graph, 1e-4);
+
+  graph.SetEvaluationPrecision(robot::spa::EvaluationPrecision::kDouble);
+  EXPECT_EQ(graph.evaluation_precision(), robot::spa::EvaluationPrecision::kDouble);
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_EQ(report.summary.num_residual_blocks, 3);
+  ExpectSolution(graph);
+}
+
+// Adds poses [begin, end) 1 m apart along x, each constrained to the one before it by
+// odometry. Every pose but the first starts 0.1 m off in y.
+void AddChain(int begin, int end, PoseGraph2D* graph) {
+  for (int id = begin; id < end; ++id) {
+    Pose pose;
+    pose.translation = Eigen::Vector2d(id, id == 0 ? 0. : 0.1);
+    pose.rotation = Eigen::Rotation2Dd(0.);
+    graph->AddPose(id, pose);
+    if (id == 0) continue;
+    Constraint constraint;
+    constraint.source = id - 1;
+    constraint.target = id;
+    constraint.relative_pose.translation = Eigen::Vector2d(1., 0.);
+    constraint.relative_pose.rotation = Eigen::Rotation2Dd(0.);
+    graph->AddConstraint(constraint);
+  }
+}
+
+TEST(PoseGraph2DTest, IncrementalSolveOnlyMovesNeighbourhood) {
+  PoseGraph2D::Options options;
+  options.incremental_hops = 2;
+  PoseGraph2D graph(options);
+  AddChain(0, 20, &graph);
+  EXPECT_EQ(graph.Solve(PoseGraph2D::SolveMode::kBatch).num_variable_poses, 19);
+
+  // Adding pose 20 seeds the region with poses 19 and 20; two hops add 18 and 17.
+  AddChain(20, 21, &graph);
+  const Pose before = graph.pose(16);
+  const robot::spa::SolveReport report = graph.Solve(PoseGraph2D::SolveMode::kIncremental);
+  EXPECT_EQ(report.num_variable_poses, 4);
+  EXPECT_EQ(report.summary.num_residual_blocks, 4);
+  EXPECT_EQ(graph.pose(16).translation, before.translation);
+  EXPECT_NEAR(graph.pose(20).translation.x(), 20., 1e-6);
+  EXPECT_NEAR(graph.pose(20).translation.y(), 0., 1e-6);
+
+  // Nothing new to solve.
+  EXPECT_EQ(graph.Solve(PoseGraph2D::SolveMode::kIncremental).num_variable_poses, 0);
+}
+
+TEST(PoseGraph2DTest, SlidingWindowFreezesOldPoses) {
+  PoseGraph2D::Options options;
+  options.solve_mode = PoseGraph2D::SolveMode::kSlidingWindow;
+  options.sliding_window_size = 5;
+  PoseGraph2D graph(options);
+  AddChain(0, 20, &graph);
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_EQ(report.num_variable_poses, 5);
+  EXPECT_EQ(report.summary.num_residual_blocks, 5);
+  EXPECT_EQ(graph.pose(14).translation, Eigen::Vector2d(14., 0.1));
+  for (int id = 15; id < 20; ++id) {
+    EXPECT_NEAR(graph.pose(id).translation.x(), id, 1e-6);
+    EXPECT_NEAR(graph.pose(id).translation.y(), 0.1, 1e-6);
+  }
+}
+
+TEST(PoseGraph2DTest, ReportsSolverStatistics) {
+  PoseGraph2D graph;
+  AddChain(0, 10, &graph);
+  robot::spa::SolveReport report = graph.Solve();
+  ASSERT_FALSE(report.iteration_costs.empty());
+  EXPECT_EQ(report.iteration_costs.size(), report.summary.iterations.size());
+  EXPECT_LT(report.iteration_costs.back(), report.iteration_costs.front());
+  EXPECT_GE(report.evaluation_time_seconds, 0.);
+  EXPECT_GE(report.linear_solver_time_seconds, 0.);
+  EXPECT_GT(report.peak_rss_bytes, 0);
+  EXPECT_EQ(report.num_downweighted_residuals, 0);
+  EXPECT_FALSE(report.time_budget_exceeded);
+  EXPECT_FALSE(report.stopped_by_callback);
+
+  // A loop closure 100 m off lands far outside the Huber loss's quadratic region.
+  Constraint outlier;
+  outlier.source = 0;
+  outlier.target = 9;
+  outlier.relative_pose.translation = Eigen::Vector2d(100., 0.);
+  outlier.relative_pose.rotation = Eigen::Rotation2Dd(0.);
+  graph.AddConstraint(outlier);
+  report = graph.Solve();
+  EXPECT_GE(report.num_downweighted_residuals, 1);
+}
+
+TEST(PoseGraph2DTest, StopsWhenIterationCallbackReturnsFalse) {
+  PoseGraph2D::Options options;
+  int num_calls = 0;
+  options.solver.iteration_callback = [&](const ceres::IterationSummary& summary) {
+    ++num_calls;
+    return summary.iteration < 1;
+  };
+  PoseGraph2D graph(options);
+  AddChain(0, 10, &graph);
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_TRUE(report.stopped_by_callback);
+  EXPECT_EQ(report.summary.termination_type, ceres::USER_SUCCESS);
+  EXPECT_EQ(num_calls, 2);
+  EXPECT_EQ(report.summary.iterations.size(), 2u);
+}
+
+TEST(PoseGraph2DTest, StopsAtTimeBudget) {
+  PoseGraph2D::Options options;
+  options.solver.time_budget_seconds = 1e-9;
+  PoseGraph2D graph(options);
+  AddChain(0, 10, &graph);
+  const robot::spa::SolveReport report = graph.Solve();
+  EXPECT_TRUE(report.time_budget_exceeded);
+  EXPECT_FALSE(report.stopped_by_callback);
+  EXPECT_LE(report.summary.iterations.size(), 1u);
+}
+
+TEST(SolverOptionsTest, ForwardsToCeres) {
+  robot::spa::SolverOptions options;
+  options.num_threads = 16;
+  options.max_num_iterations = 7;
+  options.linear_solver_type = ceres::SPARSE_SCHUR;
+  options.sparse_linear_algebra_library = ceres::EIGEN_SPARSE;
+  options.ordering_type = ceres::NESDIS;
+  const ceres::Solver::Options ceres_options = robot::spa::ToCeresSolverOptions(options);
+  EXPECT_EQ(ceres_options.num_threads, 16);
+  EXPECT_EQ(ceres_options.max_num_iterations, 7);
+  EXPECT_EQ(ceres_options.linear_solver_type, ceres::SPARSE_SCHUR);
+  EXPECT_EQ(ceres_options.sparse_linear_algebra_library_type, ceres::EIGEN_SPARSE);
+  EXPECT_EQ(ceres_options.linear_solver_ordering_type, ceres::NESDIS);
+
+  options.num_threads = 0;
+  EXPECT_GE(robot::spa::ToCeresSolverOptions(options).num_threads, 1);
+}
+
+// Ceres picks the sparse library by what it was built with; SuiteSparse may be missing.
+TEST(SolverOptionsTest, DefaultsToCeresSparseLibrary) {
+  EXPECT_EQ(robot::spa::SolverOptions().sparse_linear_algebra_library,
+            ceres::Solver::Options().sparse_linear_algebra_library_type);
+  EXPECT_EQ(robot::spa::CovarianceOptions().sparse_linear_algebra_library,
+            ceres::Covariance::Options().sparse_linear_algebra_library_type);
+}
+
+// The specialized functors for entry `index` of `table`, in double and in float, each with the
+// tolerance it should match autodiff to.
+using FixedFunctors = std::vector<std::pair<std::unique_ptr<ceres::CostFunction>, double>>;
+template <robot::spa::InformationStructure kStructure>
+FixedFunctors MakeFixedFunctors(const Pose& observed,
+                                const robot::spa::SqrtInformationTable& table, int index) {
+  FixedFunctors functors;
+  functors.emplace_back(
+      new robot::spa::SpaPoseBlockCostFunctorFixed<kStructure, double>(observed, &table, index),
+      1e-9);
+  functors.emplace_back(
+      new robot::spa::SpaPoseBlockCostFunctorFixed<kStructure, float>(observed, &table, index),
+      1e-5);
+  return functors;
+}
+
+void ExpectBlockFunctorsMatchAutodiff(const Eigen::Matrix3d& information) {
+  Pose observed;
+  observed.translation = Eigen::Vector2d(1.5, -0.4);
+  observed.rotation = Eigen::Rotation2Dd(0.7);
+  robot::spa::SqrtInformationTable table;
+  const int index = table.Add(information);
+  ASSERT_EQ(index, 0);
+  const Eigen::Matrix3d sqrt_information = table.sqrt_information(index);
+  EXPECT_TRUE((sqrt_information.transpose() * sqrt_information).isApprox(information));
+  const double source[3] = {0.3, -1.2, 2.9};
+  const double target[3] = {1.1, 0.4, -2.8};
+  const double* parameters[2] = {source, target};
+
+  robot::spa::SpaPoseBlockCostFunctorAnalytic analytic(observed, &table, index);
+  ceres::AutoDiffCostFunction<robot::spa::SpaPoseBlockCostFunctor, 3, 3, 3> autodiff(
+      new robot::spa::SpaPoseBlockCostFunctor(observed, &table, index));
+  robot::spa::SpaCostFunctorAnalytic scalar(observed, sqrt_information);
+
+  double analytic_residuals[3], autodiff_residuals[3], scalar_residuals[3];
+  double analytic_jacobians[2][9], autodiff_jacobians[2][9], scalar_jacobians[6][3];
+  double* analytic_jacobian_ptrs[2] = {analytic_jacobians[0], analytic_jacobians[1]};
+  double* autodiff_jacobian_ptrs[2] = {autodiff_jacobians[0], autodiff_jacobians[1]};
+  double* scalar_jacobian_ptrs[6];
+  for (int i = 0; i < 6; ++i) scalar_jacobian_ptrs[i] = scalar_jacobians[i];
+  const double* scalar_parameters[6] = {&source[0], &source[1], &source[2],
+                                        &target[0], &target[1], &target[2]};
+  ASSERT_TRUE(analytic.Evaluate(parameters, analytic_residuals, analytic_jacobian_ptrs));
+  ASSERT_TRUE(autodiff.Evaluate(parameters, autodiff_residuals, autodiff_jacobian_ptrs));
+  ASSERT_TRUE(scalar.Evaluate(scalar_parameters, scalar_residuals, scalar_jacobian_ptrs));
+
+  // The specialized functor, with each subset of the Jacobians.
+  // The specialized functors, with each subset of the Jacobians.
+  FixedFunctors fixed_functors;
+  switch (table.structure(index)) {
+    case robot::spa::InformationStructure::kIdentity:
+      fixed_functors = MakeFixedFunctors<robot::spa::InformationStructure::kIdentity>(
+          observed, table, index);
+      break;
+    case robot::spa::InformationStructure::kDiagonal:
+      fixed_functors = MakeFixedFunctors<robot::spa::InformationStructure::kDiagonal>(
+          observed, table, index);
+      break;
+    case robot::spa::InformationStructure::kFull:
+      fixed_functors =
+          MakeFixedFunctors<robot::spa::InformationStructure::kFull>(observed, table, index);
+      break;
+  }
+  for (const auto& fixed_tolerance : fixed_functors) {
+    const ceres::CostFunction& fixed = *fixed_tolerance.first;
+    const double tolerance = fixed_tolerance.second;
+    double fixed_residuals[3];
+    ASSERT_TRUE(fixed.Evaluate(parameters, fixed_residuals, nullptr));
+    for (int i = 0; i < 3; ++i) EXPECT_NEAR(fixed_residuals[i], autodiff_residuals[i], tolerance);
+    for (int mask = 0; mask < 4; ++mask) {
+      double fixed_jacobians[2][9];
+      double* fixed_jacobian_ptrs[2] = {mask & 1 ? fixed_jacobians[0] : nullptr,
+                                        mask & 2 ? fixed_jacobians[1] : nullptr};
+      ASSERT_TRUE(fixed.Evaluate(parameters, fixed_residuals, fixed_jacobian_ptrs));
+      for (int block = 0; block < 2; ++block) {
+        if (!fixed_jacobian_ptrs[block]) continue;
+        for (int i = 0; i < 9; ++i) {
+          EXPECT_NEAR(fixed_jacobians[block][i], autodiff_jacobians[block][i],
+                      std::max(tolerance, 1e-6));
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(analytic_residuals[i], autodiff_residuals[i], 1e-9);
+    EXPECT_NEAR(analytic_residuals[i], scalar_residuals[i], 1e-9);
+  }
+  for (int block = 0; block < 2; ++block) {
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) {
+        const double expected = autodiff_jacobians[block][3 * row + col];
+        EXPECT_NEAR(analytic_jacobians[block][3 * row + col], expected, 1e-6);
+        EXPECT_NEAR(scalar_jacobians[3 * block + col][row], expected, 1e-6);
+      }
+    }
+  }
+}
+
+TEST(SpaPoseBlockCostFunctorTest, AnalyticMatchesAutodiff) {
+  Eigen::Matrix3d sqrt_information;
+  sqrt_information << 2.0, 0.3, -0.1, 0.0, 1.5, 0.2, 0.0, 0.0, 3.0;
+  ExpectBlockFunctorsMatchAutodiff(sqrt_information.transpose() * sqrt_information);
+}
+
+TEST(SpaPoseBlockCostFunctorTest, AnalyticMatchesAutodiffWithDiagonalInformation) {
+  ExpectBlockFunctorsMatchAutodiff(Eigen::Vector3d(4.0, 2.25, 9.0).asDiagonal());
+}
+
+TEST(SpaPoseBlockCostFunctorTest, AnalyticMatchesAutodiffWithIdentityInformation) {
+  ExpectBlockFunctorsMatchAutodiff(Eigen::Matrix3d::Identity());
+}
+
+TEST(SqrtInformationTableTest, FlagsDiagonalAndRejectsIndefinite) {
+  robot::spa::SqrtInformationTable table;
+  EXPECT_EQ(table.Add(Eigen::Vector3d(4.0, 1.0, 9.0).asDiagonal()), 0);
+  EXPECT_TRUE(table.is_diagonal(0));
+  EXPECT_EQ(table.structure(0), robot::spa::InformationStructure::kDiagonal);
+  EXPECT_EQ(table.sqrt_information(0).diagonal(), Eigen::Vector3d(2.0, 1.0, 3.0));
+  Eigen::Matrix3d information = Eigen::Matrix3d::Identity();
+  information(0, 1) = information(1, 0) = 0.5;
+  EXPECT_EQ(table.Add(information), 1);
+  EXPECT_FALSE(table.is_diagonal(1));
+  EXPECT_EQ(table.structure(1), robot::spa::InformationStructure::kFull);
+  EXPECT_EQ(table.Add(Eigen::Matrix3d::Identity()), 2);
+  EXPECT_TRUE(table.is_diagonal(2));
+  EXPECT_EQ(table.structure(2), robot::spa::InformationStructure::kIdentity);
+  EXPECT_EQ(table.Add(-Eigen::Matrix3d::Identity()), -1);
+  EXPECT_FALSE(robot::spa::IsValidInformation(-Eigen::Matrix3d::Identity()));
+  EXPECT_TRUE(robot::spa::IsValidInformation(information));
+  information(0, 1) = information(1, 0) = 2.0;
+  EXPECT_EQ(table.Add(information), -1);
+  EXPECT_FALSE(robot::spa::IsValidInformation(information));
+  EXPECT_EQ(table.size(), 3u);
+}
+
+TEST(PoseGraph2DTest, WeighsConstraintsByInformation) {
+  PoseGraph2D::Options options;
+  // No robust loss, so the information alone sets the weights.
+  options.loss.type = robot::spa::RobustLossOptions::Type::kTrivial;
+  PoseGraph2D graph(options);
+  Pose origin;
+  origin.translation.setZero();
+  origin.rotation = Eigen::Rotation2Dd(0.);
+  graph.AddPose(0, origin);
+  graph.AddPose(1, origin);
+
+  Constraint strong;
+  strong.source = 0;
+  strong.target = 1;
+  strong.relative_pose.translation = Eigen::Vector2d(1., 0.);
+  strong.relative_pose.rotation = Eigen::Rotation2Dd(0.);
+  strong.information = robot::spa::InformationFromCovariance(0.01 * Eigen::Matrix3d::Identity());
+  Constraint weak = strong;
+  weak.relative_pose.translation = Eigen::Vector2d(2., 0.);
+  weak.information.setIdentity();
+  EXPECT_TRUE(graph.AddConstraint(strong));
+  EXPECT_TRUE(graph.AddConstraint(weak));
+  weak.information = -weak.information;
+  EXPECT_FALSE(graph.AddConstraint(weak));
+
+  graph.Solve();
+  EXPECT_NEAR(graph.pose(1).translation.x(), 102. / 101., 1e-6);
+  EXPECT_NEAR(graph.pose(1).translation.y(), 0., 1e-6);
+}
+
+TEST(PoseGraph2DTest, ComputesSelectedCovarianceBlocks) {
+  PoseGraph2D::Options options;
+  options.loss.type = robot::spa::RobustLossOptions::Type::kTrivial;
+  PoseGraph2D graph(options);
+  Pose pose;
+  pose.rotation = Eigen::Rotation2Dd(0.);
+  for (int id = 0; id < 4; ++id) {
+    pose.translation = Eigen::Vector2d(id, 0.);
+    graph.AddPose(id, pose);
+  }
+  const Eigen::Matrix3d covariance = Eigen::Vector3d(0.01, 0.04, 0.0025).asDiagonal();
+  for (int id = 0; id < 2; ++id) {
+    Constraint constraint;
+    constraint.source = id;
+    constraint.target = id + 1;
+    constraint.relative_pose.translation = Eigen::Vector2d(1., 0.);
+    constraint.relative_pose.rotation = Eigen::Rotation2Dd(0.);
+    constraint.information = robot::spa::InformationFromCovariance(covariance);
+    graph.AddConstraint(constraint);
+  }
+  graph.Solve();
+
+  // Pose 2 is pose 1 composed with a noisy odometry step; turning pose 1 swings pose 2 sideways.
+  Eigen::Matrix3d step_jacobian = Eigen::Matrix3d::Identity();
+  step_jacobian(1, 2) = 1.;
+  std::vector<Eigen::Matrix3d> covariances;
+  ASSERT_TRUE(graph.ComputeCovariances({{0, 0}, {1, 1}, {2, 2}, {1, 2}, {2, 1}}, &covariances));
+  ASSERT_EQ(covariances.size(), 5u);
+  EXPECT_TRUE(covariances[0].isZero());
+  EXPECT_TRUE(covariances[1].isApprox(covariance, 1e-6));
+  EXPECT_TRUE(covariances[2].isApprox(
+      step_jacobian * covariance * step_jacobian.transpose() + covariance, 1e-6));
+  EXPECT_TRUE(covariances[3].isApprox(covariance * step_jacobian.transpose(), 1e-6));
+  EXPECT_TRUE(covariances[4].isApprox(covariances[3].transpose(), 1e-6));
+
+  // Pose 3 is in no constraint, pose 4 does not exist.
+  Eigen::Matrix3d marginal;
+  EXPECT_FALSE(graph.ComputeCovariance(3, &marginal));
+  EXPECT_FALSE(graph.ComputeCovariance(4, &marginal));
+
+  // A loop closure back to the anchor makes pose 2 more certain.
+  Constraint loop_closure;
+  loop_closure.source = 0;
+  loop_closure.target = 2;
+  loop_closure.relative_pose.translation = Eigen::Vector2d(2., 0.);
+  loop_closure.relative_pose.rotation = Eigen::Rotation2Dd(0.);
+  loop_closure.information = robot::spa::InformationFromCovariance(covariance);
+  graph.AddConstraint(loop_closure);
+  graph.Solve();
+  ASSERT_TRUE(graph.ComputeCovariance(2, &marginal));
+  EXPECT_LT(marginal.trace(), covariances[2].trace());
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
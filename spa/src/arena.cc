@@ -0,0 +1,63 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace robot {
+namespace spa {
+
+void Arena::Reserve(size_t bytes) {
+  size_t available = 0;
+  if (current_block_ < blocks_.size()) {
+    available = blocks_[current_block_].size - offset_;
+    for (size_t i = current_block_ + 1; i < blocks_.size(); ++i) available += blocks_[i].size;
+  }
+  if (available >= bytes) return;
+  const size_t size = std::max(block_size_, bytes - available);
+  blocks_.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+}
+
+void Arena::Reset() {
+  for (Destructor* destructor = destructors_; destructor; destructor = destructor->next) {
+    destructor->destroy(destructor->object);
+  }
+  destructors_ = nullptr;
+  current_block_ = 0;
+  offset_ = 0;
+  bytes_used_ = 0;
+}
+
+size_t Arena::bytes_allocated() const {
+  size_t bytes = 0;
+  for (const Block& block : blocks_) bytes += block.size;
+  return bytes;
+}
+
+size_t Arena::AlignedOffset(const Block& block, size_t offset, size_t alignment) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(block.data.get()) + offset;
+  return offset + (alignment - address % alignment) % alignment;
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  // Later blocks are empty: they are only there from before a Reset() or from Reserve().
+  for (; current_block_ < blocks_.size(); ++current_block_, offset_ = 0) {
+    const Block& block = blocks_[current_block_];
+    const size_t begin = AlignedOffset(block, offset_, alignment);
+    if (begin + size <= block.size) {
+      bytes_used_ += begin + size - offset_;
+      offset_ = begin + size;
+      return block.data.get() + begin;
+    }
+  }
+  const size_t block_size = std::max(block_size_, size + alignment);
+  blocks_.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[block_size]), block_size});
+  const Block& block = blocks_.back();
+  const size_t begin = AlignedOffset(block, 0, alignment);
+  current_block_ = blocks_.size() - 1;
+  offset_ = begin + size;
+  bytes_used_ += offset_;
+  return block.data.get() + begin;
+}
+
+}  // namespace spa
+}  // namespace robot
@@ -0,0 +1,135 @@
+#include "background_optimizer.h"
+
+#include <chrono>
+
+namespace robot {
+namespace spa {
+namespace {
+
+constexpr std::chrono::milliseconds kWakePeriod(10);
+
+// Chains a check of `stop` in front of the user's iteration callback.
+PoseGraph2D::Options WithStopCheck(PoseGraph2D::Options options, const std::atomic<bool>* stop) {
+  auto callback = options.solver.iteration_callback;
+  options.solver.iteration_callback = [callback, stop](const ceres::IterationSummary& summary) {
+    return !stop->load(std::memory_order_relaxed) && (!callback || callback(summary));
+  };
+  return options;
+}
+
+}  // namespace
+
+BackgroundOptimizer::BackgroundOptimizer() : BackgroundOptimizer(Options()) {}
+
+BackgroundOptimizer::BackgroundOptimizer(const Options& options)
+    : graph_(WithStopCheck(options.pose_graph, &stop_)), worker_([this] { Run(); }) {}
+
+BackgroundOptimizer::~BackgroundOptimizer() {
+  stop_.store(true, std::memory_order_release);
+  wake_.notify_one();
+  worker_.join();
+}
+
+void BackgroundOptimizer::AddPose(int id, const Pose& pose) {
+  pose_queue_.Push({num_added_.fetch_add(1, std::memory_order_relaxed), {id, pose}});
+  wake_.notify_one();
+}
+
+void BackgroundOptimizer::AddConstraint(const Constraint& constraint) {
+  constraint_queue_.Push({num_added_.fetch_add(1, std::memory_order_relaxed), constraint});
+  wake_.notify_one();
+}
+
+// Counting pushes separately from the queue would let Flush() return early: another producer's
+// pose, popped and published, could stand in for the caller's own one still on its way into the
+// queue. Waiting for every sequence number below the count instead also covers the caller's.
+void BackgroundOptimizer::Flush() {
+  const uint64_t num_added = num_added_.load(std::memory_order_relaxed);
+  std::unique_lock<std::mutex> lock(flush_mutex_);
+  flushed_.wait(lock, [&] { return num_published_ >= num_added; });
+}
+
+bool BackgroundOptimizer::LookupPose(int id, Pose* pose) const {
+  return Read([&](const Snapshot& snapshot) {
+    const auto it = snapshot.pose_indices.find(id);
+    if (it == snapshot.pose_indices.end()) return false;
+    *pose = snapshot.poses[it->second];
+    return true;
+  });
+}
+
+int64_t BackgroundOptimizer::generation() const {
+  return Read([](const Snapshot& snapshot) { return snapshot.generation; });
+}
+
+void BackgroundOptimizer::Run() {
+  std::vector<Sequenced<std::pair<int, Pose>>> poses;
+  std::vector<Sequenced<Constraint>> constraints;
+  uint64_t num_applied = 0;
+  int64_t generation = 0;
+  SolveReport report;
+  while (!stop_.load(std::memory_order_acquire)) {
+    poses.clear();
+    constraints.clear();
+    // Poses first, so a constraint added after its poses finds them in the same round.
+    pose_queue_.PopAll(&poses);
+    constraint_queue_.PopAll(&constraints);
+    if (poses.empty() && constraints.empty()) {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_.wait_for(lock, kWakePeriod, [this] {
+        return stop_.load(std::memory_order_acquire) || !pose_queue_.empty() ||
+               !constraint_queue_.empty();
+      });
+      continue;
+    }
+    for (const auto& pose : poses) applied_out_of_order_.push(pose.sequence);
+    for (const auto& constraint : constraints) applied_out_of_order_.push(constraint.sequence);
+    while (!applied_out_of_order_.empty() && applied_out_of_order_.top() == num_applied) {
+      applied_out_of_order_.pop();
+      ++num_applied;
+    }
+    if (Apply(poses, constraints)) report = graph_.Solve();
+    Publish(++generation, report);
+    {
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      num_published_ = num_applied;
+    }
+    flushed_.notify_all();
+  }
+}
+
+bool BackgroundOptimizer::Apply(const std::vector<Sequenced<std::pair<int, Pose>>>& poses,
+                                const std::vector<Sequenced<Constraint>>& constraints) {
+  for (const auto& pose : poses) graph_.AddPose(pose.value.first, pose.value.second);
+  for (const auto& constraint : constraints) waiting_constraints_.push_back(constraint.value);
+  const size_t num_constraints = graph_.constraints().size();
+  size_t num_waiting = 0;
+  for (const Constraint& constraint : waiting_constraints_) {
+    if (graph_.HasPose(constraint.source) && graph_.HasPose(constraint.target)) {
+      graph_.AddConstraint(constraint);
+    } else {
+      waiting_constraints_[num_waiting++] = constraint;
+    }
+  }
+  waiting_constraints_.resize(num_waiting);
+  return graph_.constraints().size() > num_constraints;
+}
+
+void BackgroundOptimizer::Publish(int64_t generation, const SolveReport& report) {
+  snapshots_.Write([&](Snapshot* snapshot) {
+    // The buffer holds the snapshot before last; the graph only grows, so only the new ids
+    // need indexing.
+    const std::vector<int>& pose_ids = graph_.pose_ids();
+    for (size_t i = snapshot->pose_ids.size(); i < pose_ids.size(); ++i) {
+      snapshot->pose_ids.push_back(pose_ids[i]);
+      snapshot->pose_indices.emplace(pose_ids[i], i);
+    }
+    snapshot->poses.resize(pose_ids.size());
+    for (size_t i = 0; i < pose_ids.size(); ++i) snapshot->poses[i] = graph_.pose(pose_ids[i]);
+    snapshot->generation = generation;
+    snapshot->report = report;
+  });
+}
+
+}  // namespace spa
+}  // namespace robot
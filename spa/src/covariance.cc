@@ -0,0 +1,56 @@
+#include "covariance.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace robot {
+namespace spa {
+
+ceres::Covariance::Options ToCeresCovarianceOptions(const CovarianceOptions& options) {
+  ceres::Covariance::Options ceres_options;
+  ceres_options.algorithm_type = options.algorithm_type;
+  ceres_options.sparse_linear_algebra_library_type = options.sparse_linear_algebra_library;
+  ceres_options.num_threads =
+      options.num_threads > 0
+          ? options.num_threads
+          : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  ceres_options.min_reciprocal_condition_number = options.min_reciprocal_condition_number;
+  ceres_options.apply_loss_function = options.apply_loss_function;
+  return ceres_options;
+}
+
+bool ComputeCovarianceBlocks(const CovarianceOptions& options, int tangent_size,
+                             const std::vector<BlockPair>& block_pairs, ceres::Problem* problem,
+                             std::vector<Eigen::MatrixXd>* covariances) {
+  // Ceres rejects duplicate pairs and pairs requested in both orders, but serves either order
+  // of a pair it computed.
+  std::vector<BlockPair> unique_pairs;
+  unique_pairs.reserve(block_pairs.size());
+  for (const auto& pair : block_pairs) {
+    if (!problem->HasParameterBlock(pair.first) || !problem->HasParameterBlock(pair.second)) {
+      return false;
+    }
+    unique_pairs.push_back(std::minmax(pair.first, pair.second, std::less<const double*>()));
+  }
+  std::sort(unique_pairs.begin(), unique_pairs.end());
+  unique_pairs.erase(std::unique(unique_pairs.begin(), unique_pairs.end()), unique_pairs.end());
+
+  ceres::Covariance covariance(ToCeresCovarianceOptions(options));
+  if (!covariance.Compute(unique_pairs, problem)) return false;
+
+  covariances->clear();
+  covariances->reserve(block_pairs.size());
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> block(tangent_size,
+                                                                               tangent_size);
+  for (const auto& pair : block_pairs) {
+    if (!covariance.GetCovarianceBlockInTangentSpace(pair.first, pair.second, block.data())) {
+      return false;
+    }
+    covariances->push_back(block);
+  }
+  return true;
+}
+
+}  // namespace spa
+}  // namespace robot
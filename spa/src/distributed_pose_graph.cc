@@ -0,0 +1,127 @@
+#include "distributed_pose_graph.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "angle.h"
+#include "information.h"
+
+namespace robot {
+namespace spa {
+namespace {
+
+// Larger of the translation and rotation differences.
+double Distance(const Pose& a, const Pose& b) {
+  return std::max((a.translation - b.translation).norm(),
+                  std::abs(common::NormalizeAngle(a.rotation.angle() - b.rotation.angle())));
+}
+
+}  // namespace
+
+DistributedPoseGraph2D::DistributedPoseGraph2D(int robot_id, const Options& options,
+                                               Transport* transport)
+    : robot_id_(robot_id), options_(options), transport_(transport), graph_(options.pose_graph) {}
+
+bool DistributedPoseGraph2D::AddPose(int id, const Pose& pose) {
+  if (!graph_.AddPose(id, pose)) return false;
+  if (local_poses_.empty()) first_pose_id_ = id;
+  local_poses_.insert(id);
+  return true;
+}
+
+bool DistributedPoseGraph2D::AddConstraint(const Constraint& constraint) {
+  if (!IsLocalPose(constraint.source) || !IsLocalPose(constraint.target)) return false;
+  return graph_.AddConstraint(constraint);
+}
+
+bool DistributedPoseGraph2D::AddInterRobotConstraint(const Constraint& constraint,
+                                                     int remote_robot) {
+  const bool source_is_local = IsLocalPose(constraint.source);
+  if (source_is_local == IsLocalPose(constraint.target)) return false;
+  const int local = source_is_local ? constraint.source : constraint.target;
+  const int remote = source_is_local ? constraint.target : constraint.source;
+  // Checked up front, as a constraint AddConstraint rejects would leave behind the remote pose
+  // added for it.
+  if (!IsValidInformation(constraint.information)) return false;
+  if (!graph_.HasPose(remote)) {
+    const Pose local_pose = graph_.pose(local);
+    const Pose& relative = constraint.relative_pose;
+    Pose remote_pose;
+    if (source_is_local) {
+      remote_pose = {local_pose.translation + local_pose.rotation * relative.translation,
+                     local_pose.rotation * relative.rotation};
+    } else {
+      const Eigen::Rotation2Dd rotation = local_pose.rotation * relative.rotation.inverse();
+      remote_pose = {local_pose.translation - rotation * relative.translation, rotation};
+    }
+    graph_.AddPose(remote, remote_pose);
+    graph_.SetPoseConstant(remote, true);
+    remote_owners_[remote] = remote_robot;
+  } else if (remote_owners_.at(remote) != remote_robot) {
+    return false;
+  }
+  if (!graph_.AddConstraint(constraint)) return false;
+  neighbors_[remote_robot].separator_ids.insert(local);
+  return true;
+}
+
+DistributedPoseGraph2D::StepReport DistributedPoseGraph2D::Step() {
+  StepReport report;
+  for (const SeparatorMessage& message : transport_->Receive(robot_id_)) {
+    ++report.num_messages_received;
+    for (const auto& id_pose : message.poses) {
+      const auto it = remote_owners_.find(id_pose.first);
+      if (it == remote_owners_.end() || it->second != message.source_robot) continue;
+      graph_.SetPose(id_pose.first, id_pose.second);
+      heard_from_neighbor_ = true;
+    }
+  }
+  if (local_poses_.empty()) return report;
+
+  // Without the anchor or a neighbour's estimates, nothing fixes the partition's frame.
+  if (!options_.anchor) graph_.SetPoseConstant(first_pose_id_, !heard_from_neighbor_);
+  std::unordered_map<int, Pose> before;
+  for (const auto& robot_neighbor : neighbors_) {
+    for (int id : robot_neighbor.second.separator_ids) before.emplace(id, graph_.pose(id));
+  }
+  report.solve = graph_.Solve(PoseGraph2D::SolveMode::kBatch);
+  for (const auto& id_pose : before) {
+    report.max_separator_change = std::max(report.max_separator_change,
+                                           Distance(id_pose.second, graph_.pose(id_pose.first)));
+  }
+
+  for (auto& robot_neighbor : neighbors_) {
+    Neighbor& neighbor = robot_neighbor.second;
+    SeparatorMessage message{robot_id_, {}};
+    for (int id : neighbor.separator_ids) {
+      const Pose pose = graph_.pose(id);
+      const auto it = neighbor.last_sent.find(id);
+      if (it != neighbor.last_sent.end() && Distance(it->second, pose) < options_.send_tolerance) {
+        continue;
+      }
+      message.poses.emplace_back(id, pose);
+      neighbor.last_sent[id] = pose;
+    }
+    if (message.poses.empty()) continue;
+    report.num_poses_sent += message.poses.size();
+    transport_->Send(robot_neighbor.first, std::move(message));
+  }
+  return report;
+}
+
+int RunBlockGaussSeidel(const std::vector<DistributedPoseGraph2D*>& graphs, int max_rounds,
+                        double tolerance) {
+  int round = 0;
+  while (round < max_rounds) {
+    ++round;
+    double max_change = 0.;
+    for (DistributedPoseGraph2D* graph : graphs) {
+      max_change = std::max(max_change, graph->Step().max_separator_change);
+    }
+    if (max_change <= tolerance) break;
+  }
+  return round;
+}
+
+}  // namespace spa
+}  // namespace robot
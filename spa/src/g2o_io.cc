@@ -0,0 +1,313 @@
+#include "g2o_io.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+
+#include "mapped_file.h"
+
+namespace robot {
+namespace spa {
+namespace {
+
+// Splits one line into whitespace-separated fields.
+class LineParser {
+ public:
+  LineParser(const char* begin, const char* end) : position_(begin), end_(end) {}
+
+  bool Next(std::string_view* token) {
+    SkipSpaces();
+    const char* begin = position_;
+    while (position_ < end_ && *position_ != ' ' && *position_ != '\t') ++position_;
+    *token = std::string_view(begin, position_ - begin);
+    return !token->empty();
+  }
+
+  template <typename T>
+  bool Read(T* value) {
+    SkipSpaces();
+    const std::from_chars_result result = std::from_chars(position_, end_, *value);
+    position_ = result.ptr;
+    return result.ec == std::errc();
+  }
+
+  template <typename T>
+  bool Read(T* values, int count) {
+    for (int i = 0; i < count; ++i) {
+      if (!Read(&values[i])) return false;
+    }
+    return true;
+  }
+
+ private:
+  void SkipSpaces() {
+    while (position_ < end_ && (*position_ == ' ' || *position_ == '\t')) ++position_;
+  }
+
+  const char* position_;
+  const char* end_;
+};
+
+// Fills a symmetric matrix from its upper triangle, given row by row.
+template <int N>
+void FillSymmetric(const double* upper, Eigen::Matrix<double, N, N>* matrix) {
+  for (int row = 0; row < N; ++row) {
+    for (int col = row; col < N; ++col) {
+      (*matrix)(row, col) = (*matrix)(col, row) = *upper++;
+    }
+  }
+}
+
+enum class RecordStatus { kParsed, kSkipped, kMalformed, kWrongDimension };
+
+RecordStatus ParseRecord(std::string_view tag, LineParser* line, PoseGraphData2D* data) {
+  if (tag == "VERTEX_SE2" || tag == "VERTEX2") {
+    int id;
+    double values[3];
+    if (!line->Read(&id) || !line->Read(values, 3)) return RecordStatus::kMalformed;
+    data->pose_ids.push_back(id);
+    data->poses.push_back({Eigen::Vector2d(values[0], values[1]),
+                           Eigen::Rotation2Dd(values[2])});
+  } else if (tag == "EDGE_SE2" || tag == "EDGE2") {
+    Constraint constraint;
+    double values[9];
+    if (!line->Read(&constraint.source) || !line->Read(&constraint.target) ||
+        !line->Read(values, 9)) {
+      return RecordStatus::kMalformed;
+    }
+    constraint.relative_pose = {Eigen::Vector2d(values[0], values[1]),
+                                Eigen::Rotation2Dd(values[2])};
+    if (tag == "EDGE2") {
+      // TORO orders the upper triangle as xx, xy, yy, tt, xt, yt.
+      const double upper[6] = {values[3], values[4], values[7],
+                               values[5], values[8], values[6]};
+      FillSymmetric(upper, &constraint.information);
+    } else {
+      FillSymmetric(values + 3, &constraint.information);
+    }
+    data->constraints.push_back(constraint);
+  } else if (tag == "FIX") {
+    int id;
+    while (line->Read(&id)) data->fixed_pose_ids.push_back(id);
+  } else if (tag.substr(0, 10) == "VERTEX_SE3" || tag.substr(0, 8) == "EDGE_SE3" ||
+             tag == "VERTEX3" || tag == "EDGE3") {
+    return RecordStatus::kWrongDimension;
+  } else {
+    return RecordStatus::kSkipped;
+  }
+  return RecordStatus::kParsed;
+}
+
+RecordStatus ParseRecord(std::string_view tag, LineParser* line, PoseGraphData3D* data) {
+  if (tag == "VERTEX_SE3:QUAT") {
+    int id;
+    double values[7];
+    if (!line->Read(&id) || !line->Read(values, 7)) return RecordStatus::kMalformed;
+    data->pose_ids.push_back(id);
+    data->poses.push_back(
+        {Eigen::Vector3d(values[0], values[1], values[2]),
+         Eigen::Quaterniond(values[6], values[3], values[4], values[5]).normalized()});
+  } else if (tag == "EDGE_SE3:QUAT") {
+    Constraint3d constraint;
+    double values[28];
+    if (!line->Read(&constraint.source) || !line->Read(&constraint.target) ||
+        !line->Read(values, 28)) {
+      return RecordStatus::kMalformed;
+    }
+    constraint.relative_pose = {
+        Eigen::Vector3d(values[0], values[1], values[2]),
+        Eigen::Quaterniond(values[6], values[3], values[4], values[5]).normalized()};
+    FillSymmetric(values + 7, &constraint.information);
+    data->constraints.push_back(constraint);
+  } else if (tag == "FIX") {
+    int id;
+    while (line->Read(&id)) data->fixed_pose_ids.push_back(id);
+  } else if (tag == "VERTEX_SE2" || tag == "EDGE_SE2" || tag == "VERTEX2" || tag == "EDGE2") {
+    return RecordStatus::kWrongDimension;
+  } else {
+    return RecordStatus::kSkipped;
+  }
+  return RecordStatus::kParsed;
+}
+
+// Counts the lines starting with 'V' and with 'E', to size the arrays in one allocation.
+void CountRecords(const char* begin, const char* end, size_t* num_vertices, size_t* num_edges) {
+  *num_vertices = *num_edges = 0;
+  for (const char* line = begin; line < end;) {
+    if (*line == 'V') ++*num_vertices;
+    if (*line == 'E') ++*num_edges;
+    const void* newline = std::memchr(line, '\n', end - line);
+    line = newline ? static_cast<const char*>(newline) + 1 : end;
+  }
+}
+
+template <typename Data>
+bool Load(const std::string& path, Data* data, std::string* error) {
+  MappedFile file;
+  if (!file.Open(path, true, error)) return false;
+  const char* const begin = file.data();
+  const char* const end = begin + file.size();
+
+  *data = Data();
+  size_t num_vertices, num_edges;
+  CountRecords(begin, end, &num_vertices, &num_edges);
+  data->pose_ids.reserve(num_vertices);
+  data->poses.reserve(num_vertices);
+  data->constraints.reserve(num_edges);
+
+  int line_number = 0;
+  for (const char* line = begin; line < end;) {
+    ++line_number;
+    const void* newline = std::memchr(line, '\n', end - line);
+    const char* line_end = newline ? static_cast<const char*>(newline) : end;
+    const char* next_line = newline ? line_end + 1 : end;
+    if (line_end > line && line_end[-1] == '\r') --line_end;
+
+    LineParser parser(line, line_end);
+    std::string_view tag;
+    line = next_line;
+    if (!parser.Next(&tag) || tag[0] == '#') continue;
+    const RecordStatus status = ParseRecord(tag, &parser, data);
+    if (status == RecordStatus::kMalformed || status == RecordStatus::kWrongDimension) {
+      if (error) {
+        *error = path + ":" + std::to_string(line_number) +
+                 (status == RecordStatus::kMalformed ? ": malformed " : ": unexpected ") +
+                 std::string(tag) + " record";
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+// Buffers output and writes it to a FILE in large chunks.
+class Writer {
+ public:
+  explicit Writer(std::FILE* file) : file_(file) { buffer_.reserve(kFlushSize + 1024); }
+
+  // Starts a record.
+  void Tag(std::string_view tag) { buffer_.append(tag); }
+  template <typename T>
+  void Field(T value) {
+    char text[32];
+    const std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+    buffer_.push_back(' ');
+    buffer_.append(text, result.ptr);
+  }
+  void EndLine() {
+    buffer_.push_back('\n');
+    MaybeFlush();
+  }
+  bool Flush() {
+    const bool ok = std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+    buffer_.clear();
+    ok_ = ok_ && ok;
+    return ok_;
+  }
+
+ private:
+  static constexpr size_t kFlushSize = 1 << 20;
+
+  void MaybeFlush() {
+    if (buffer_.size() >= kFlushSize) Flush();
+  }
+
+  std::FILE* file_;
+  std::string buffer_;
+  bool ok_ = true;
+};
+
+void WriteRecords(const PoseGraphData2D& data, Writer* writer) {
+  for (size_t i = 0; i < data.poses.size(); ++i) {
+    const Pose& pose = data.poses[i];
+    writer->Tag("VERTEX_SE2");
+    writer->Field(data.pose_ids[i]);
+    writer->Field(pose.translation.x());
+    writer->Field(pose.translation.y());
+    writer->Field(pose.rotation.angle());
+    writer->EndLine();
+  }
+  for (const Constraint& constraint : data.constraints) {
+    writer->Tag("EDGE_SE2");
+    writer->Field(constraint.source);
+    writer->Field(constraint.target);
+    writer->Field(constraint.relative_pose.translation.x());
+    writer->Field(constraint.relative_pose.translation.y());
+    writer->Field(constraint.relative_pose.rotation.angle());
+    for (int row = 0; row < 3; ++row) {
+      for (int col = row; col < 3; ++col) writer->Field(constraint.information(row, col));
+    }
+    writer->EndLine();
+  }
+}
+
+void WriteRecords(const PoseGraphData3D& data, Writer* writer) {
+  for (size_t i = 0; i < data.poses.size(); ++i) {
+    const Pose3d& pose = data.poses[i];
+    writer->Tag("VERTEX_SE3:QUAT");
+    writer->Field(data.pose_ids[i]);
+    for (int j = 0; j < 3; ++j) writer->Field(pose.translation[j]);
+    for (int j = 0; j < 4; ++j) writer->Field(pose.rotation.coeffs()[j]);
+    writer->EndLine();
+  }
+  for (const Constraint3d& constraint : data.constraints) {
+    writer->Tag("EDGE_SE3:QUAT");
+    writer->Field(constraint.source);
+    writer->Field(constraint.target);
+    for (int j = 0; j < 3; ++j) writer->Field(constraint.relative_pose.translation[j]);
+    for (int j = 0; j < 4; ++j) writer->Field(constraint.relative_pose.rotation.coeffs()[j]);
+    for (int row = 0; row < 6; ++row) {
+      for (int col = row; col < 6; ++col) writer->Field(constraint.information(row, col));
+    }
+    writer->EndLine();
+  }
+}
+
+template <typename Data>
+bool Write(const std::string& path, const Data& data, std::string* error) {
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    if (error) *error = path + ": " + std::strerror(errno);
+    return false;
+  }
+  Writer writer(file);
+  WriteRecords(data, &writer);
+  if (!data.fixed_pose_ids.empty()) {
+    writer.Tag("FIX");
+    for (int id : data.fixed_pose_ids) writer.Field(id);
+    writer.EndLine();
+  }
+  const bool written = writer.Flush();
+  if (std::fclose(file) != 0 || !written) {
+    if (error) *error = path + ": write failed";
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool LoadG2o(const std::string& path, PoseGraphData2D* data, std::string* error) {
+  return Load(path, data, error);
+}
+
+bool LoadG2o(const std::string& path, PoseGraphData3D* data, std::string* error) {
+  return Load(path, data, error);
+}
+
+bool WriteG2o(const std::string& path, const PoseGraphData2D& data, std::string* error) {
+  return Write(path, data, error);
+}
+
+bool WriteG2o(const std::string& path, const PoseGraphData3D& data, std::string* error) {
+  return Write(path, data, error);
+}
+
+bool WriteG2o(const std::string& path, const PoseGraph2D& graph, std::string* error) {
+  return Write(path, ToPoseGraphData(graph), error);
+}
+
+}  // namespace spa
+}  // namespace robot
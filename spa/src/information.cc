@@ -0,0 +1,38 @@
+#include "information.h"
+
+namespace robot {
+namespace spa {
+
+Eigen::Matrix3d InformationFromCovariance(const Eigen::Matrix3d& covariance) {
+  return covariance.llt().solve(Eigen::Matrix3d::Identity());
+}
+
+bool IsValidInformation(const Eigen::Matrix3d& information) {
+  if (information.isDiagonal(0.)) return (information.diagonal().array() > 0.).all();
+  return Eigen::LLT<Eigen::Matrix3d>(information).info() == Eigen::Success;
+}
+
+int SqrtInformationTable::Add(const Eigen::Matrix3d& information) {
+  Eigen::Matrix3d sqrt_information;
+  const bool is_diagonal = information.isDiagonal(0.);
+  if (is_diagonal) {
+    if ((information.diagonal().array() <= 0.).any()) return -1;
+    sqrt_information = information.diagonal().cwiseSqrt().asDiagonal();
+  } else {
+    const Eigen::LLT<Eigen::Matrix3d> llt(information);
+    if (llt.info() != Eigen::Success) return -1;
+    sqrt_information = llt.matrixU();
+  }
+  entries_.insert(entries_.end(), sqrt_information.data(), sqrt_information.data() + 9);
+  if (!is_diagonal) {
+    structures_.push_back(InformationStructure::kFull);
+  } else if (information.diagonal().isOnes(0.)) {
+    structures_.push_back(InformationStructure::kIdentity);
+  } else {
+    structures_.push_back(InformationStructure::kDiagonal);
+  }
+  return structures_.size() - 1;
+}
+
+}  // namespace spa
+}  // namespace robot
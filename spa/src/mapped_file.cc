@@ -0,0 +1,53 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace robot {
+namespace spa {
+
+MappedFile::~MappedFile() { Close(); }
+
+bool MappedFile::Open(const std::string& path, bool sequential, std::string* error) {
+  Close();
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (error) *error = path + ": " + std::strerror(errno);
+    return false;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    if (error) *error = path + ": " + std::strerror(errno);
+    close(fd);
+    return false;
+  }
+  // mmap rejects empty ranges; an empty file maps to an empty buffer.
+  if (status.st_size == 0) {
+    close(fd);
+    return true;
+  }
+  void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    if (error) *error = path + ": " + std::strerror(errno);
+    return false;
+  }
+  if (sequential) madvise(data, status.st_size, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(data);
+  size_ = status.st_size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_) munmap(const_cast<char*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+}  // namespace spa
+}  // namespace robot
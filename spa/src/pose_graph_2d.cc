@@ -0,0 +1,456 @@
+#include "pose_graph_2d.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <unordered_set>
+
+#include "cost_functors.h"
+
+namespace robot {
+namespace spa {
+namespace {
+
+using AutoDiffCostFunction = ceres::AutoDiffCostFunction<SpaPoseBlockCostFunctor, 3, 3, 3>;
+
+// The analytic cost function for entry `index` of `sqrt_information`, specialized on its
+// structure.
+template <typename Scalar>
+ceres::CostFunction* CreateFixedCostFunction(const Pose& observed,
+                                             const SqrtInformationTable& sqrt_information,
+                                             int index, Arena* arena) {
+  switch (sqrt_information.structure(index)) {
+    case InformationStructure::kIdentity:
+      return arena->Create<SpaPoseBlockCostFunctorFixed<InformationStructure::kIdentity, Scalar>>(
+          observed, &sqrt_information, index);
+    case InformationStructure::kDiagonal:
+      return arena->Create<SpaPoseBlockCostFunctorFixed<InformationStructure::kDiagonal, Scalar>>(
+          observed, &sqrt_information, index);
+    case InformationStructure::kFull:
+      break;
+  }
+  return arena->Create<SpaPoseBlockCostFunctorFixed<InformationStructure::kFull, Scalar>>(
+      observed, &sqrt_information, index);
+}
+
+double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+SolveReport Optimize(PoseGraph2D::CostFunctorType cost_functor_type,
+                     const std::vector<Constraint>& constraints,
+                     std::map<int, Pose>* poses_ptr, const SolverOptions& solver_options) {
+  auto& poses = *poses_ptr;
+  PoseGraph2D::Options options;
+  options.cost_functor_type = cost_functor_type;
+  options.solver = solver_options;
+  PoseGraph2D graph(options);
+  // The graph holds its first pose constant.
+  auto anchor = poses.find(0);
+  if (anchor == poses.end()) anchor = poses.begin();
+  if (anchor != poses.end()) graph.AddPose(anchor->first, anchor->second);
+  for (const auto& id_pose : poses) graph.AddPose(id_pose.first, id_pose.second);
+  int num_invalid_constraints = 0;
+  for (const auto& constraint : constraints) {
+    if (!graph.AddConstraint(constraint)) ++num_invalid_constraints;
+  }
+  SolveReport report = graph.Solve();
+  report.num_invalid_constraints = num_invalid_constraints;
+  for (auto& id_pose : poses) id_pose.second = graph.pose(id_pose.first);
+  return report;
+}
+
+}  // namespace
+
+PoseGraph2D::PoseGraph2D() : PoseGraph2D(Options()) {}
+
+PoseGraph2D::PoseGraph2D(const Options& options)
+    : options_(options),
+      evaluation_precision_(options.evaluation_precision),
+      loss_function_(MakeLossFunction(options.loss)) {
+  RebuildProblem();
+}
+
+void PoseGraph2D::Reserve(int num_poses, int num_constraints) {
+  if (3 * static_cast<size_t>(num_poses) > pose_blocks_.capacity() &&
+      problem_->NumResidualBlocks() > 0) {
+    pose_blocks_moved_ = true;
+  }
+  pose_blocks_.reserve(3 * num_poses);
+  pose_ids_.reserve(num_poses);
+  constraints_.reserve(num_constraints);
+  sqrt_information_.reserve(num_constraints);
+  residual_blocks_.reserve(num_constraints);
+  if (static_cast<size_t>(num_constraints) <= residual_blocks_.size()) return;
+  const size_t bytes_per_constraint =
+      options_.cost_functor_type == CostFunctorType::kAutodiff
+          ? Arena::MaxBytesPerObject<AutoDiffCostFunction>() +
+                Arena::MaxBytesPerObject<SpaPoseBlockCostFunctor>()
+          : Arena::MaxBytesPerObject<SpaPoseBlockCostFunctorFixed<InformationStructure::kFull>>();
+  cost_functions_.Reserve((num_constraints - residual_blocks_.size()) * bytes_per_constraint);
+}
+
+bool PoseGraph2D::AddPose(int id, const Pose& pose) {
+  if (!pose_indices_.emplace(id, pose_ids_.size()).second) return false;
+  if (pose_blocks_.size() + 3 > pose_blocks_.capacity() && problem_->NumResidualBlocks() > 0) {
+    pose_blocks_moved_ = true;
+  }
+  pose_blocks_.push_back(pose.translation.x());
+  pose_blocks_.push_back(pose.translation.y());
+  pose_blocks_.push_back(pose.rotation.angle());
+  pose_ids_.push_back(id);
+  pose_constraints_.emplace_back();
+  if (pose_ids_.size() == 1) constant_poses_.insert(id);
+  return true;
+}
+
+Pose PoseGraph2D::pose(int id) const {
+  const double* block = &pose_blocks_[3 * pose_indices_.at(id)];
+  Pose pose;
+  pose.translation = Eigen::Vector2d(block[0], block[1]);
+  pose.rotation = Eigen::Rotation2Dd(block[2]);
+  return pose;
+}
+
+bool PoseGraph2D::SetPose(int id, const Pose& pose) {
+  if (!HasPose(id)) return false;
+  double* block = pose_block(id);
+  block[0] = pose.translation.x();
+  block[1] = pose.translation.y();
+  block[2] = pose.rotation.angle();
+  return true;
+}
+
+bool PoseGraph2D::AddConstraint(const Constraint& constraint) {
+  if (!HasPose(constraint.source) || !HasPose(constraint.target)) return false;
+  if (sqrt_information_.Add(constraint.information) < 0) return false;
+  pose_constraints_[pose_indices_.at(constraint.source)].push_back(constraints_.size());
+  pose_constraints_[pose_indices_.at(constraint.target)].push_back(constraints_.size());
+  constraints_.push_back(constraint);
+  switches_.push_back(1.);
+  rejected_.push_back(false);
+  return true;
+}
+
+bool PoseGraph2D::IsLoopClosure(int constraint_index) const {
+  const Constraint& constraint = constraints_[constraint_index];
+  return std::abs(pose_indices_.at(constraint.target) - pose_indices_.at(constraint.source)) != 1;
+}
+
+bool PoseGraph2D::SetPoseConstant(int id, bool constant) {
+  if (!HasPose(id)) return false;
+  if (constant) {
+    constant_poses_.insert(id);
+  } else {
+    constant_poses_.erase(id);
+  }
+  if (pose_blocks_moved_) return true;
+  double* block = pose_block(id);
+  if (!problem_->HasParameterBlock(block)) return true;
+  if (constant) {
+    problem_->SetParameterBlockConstant(block);
+  } else {
+    problem_->SetParameterBlockVariable(block);
+  }
+  return true;
+}
+
+void PoseGraph2D::RebuildProblem() {
+  ceres::Problem::Options problem_options;
+  problem_options.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_.reset(new ceres::Problem(problem_options));
+  pose_blocks_moved_ = false;
+  for (size_t i = 0; i < residual_blocks_.size(); ++i) {
+    AddToProblem(i, loss_function_.get(), problem_.get());
+  }
+}
+
+ceres::CostFunction* PoseGraph2D::MakeCostFunction(int constraint_index) {
+  const Constraint& constraint = constraints_[constraint_index];
+  if (options_.cost_functor_type == CostFunctorType::kAutodiff) {
+    return cost_functions_.Create<AutoDiffCostFunction>(
+        cost_functions_.Create<SpaPoseBlockCostFunctor>(constraint.relative_pose,
+                                                        &sqrt_information_, constraint_index),
+        ceres::DO_NOT_TAKE_OWNERSHIP);
+  }
+  if (evaluation_precision_ == EvaluationPrecision::kFloat) {
+    return CreateFixedCostFunction<float>(constraint.relative_pose, sqrt_information_,
+                                          constraint_index, &cost_functions_);
+  }
+  return CreateFixedCostFunction<double>(constraint.relative_pose, sqrt_information_,
+                                         constraint_index, &cost_functions_);
+}
+
+void PoseGraph2D::SetEvaluationPrecision(EvaluationPrecision precision) {
+  if (precision == evaluation_precision_) return;
+  evaluation_precision_ = precision;
+  if (options_.cost_functor_type == CostFunctorType::kAutodiff) return;
+  // Recreates every residual block in the rewound arena, which allocates nothing.
+  const size_t num_residual_blocks = residual_blocks_.size();
+  residual_blocks_.clear();
+  problem_.reset();
+  cost_functions_.Reset();
+  RebuildProblem();
+  while (residual_blocks_.size() < num_residual_blocks) {
+    AddResidualBlock(residual_blocks_.size());
+  }
+  ApplyConstantPoses();
+}
+
+void PoseGraph2D::AddResidualBlock(int constraint_index, ceres::CostFunction* cost_function) {
+  ResidualBlock residual_block = {nullptr, nullptr};
+  if (!rejected_[constraint_index]) {
+    residual_block.cost_function =
+        cost_function ? cost_function : MakeCostFunction(constraint_index);
+    if (options_.loss.type == RobustLossOptions::Type::kSwitchable &&
+        IsLoopClosure(constraint_index)) {
+      residual_block.cost_function = cost_functions_.Create<SwitchableCostFunction>(
+          residual_block.cost_function, ceres::DO_NOT_TAKE_OWNERSHIP);
+      residual_block.switch_prior =
+          cost_functions_.Create<SwitchPriorCostFunction>(options_.loss.switch_prior_stddev);
+    }
+  }
+  residual_blocks_.push_back(residual_block);
+  AddToProblem(constraint_index, loss_function_.get(), problem_.get());
+}
+
+void PoseGraph2D::AddToProblem(int constraint_index, ceres::LossFunction* loss_function,
+                               ceres::Problem* problem) {
+  const ResidualBlock& residual_block = residual_blocks_[constraint_index];
+  if (!residual_block.cost_function) return;
+  const Constraint& constraint = constraints_[constraint_index];
+  double* source = pose_block(constraint.source);
+  double* target = pose_block(constraint.target);
+  if (!residual_block.switch_prior) {
+    problem->AddResidualBlock(residual_block.cost_function, loss_function, source, target);
+    return;
+  }
+  double* switch_variable = &switches_[constraint_index];
+  problem->AddResidualBlock(residual_block.cost_function, nullptr, source, target,
+                            switch_variable);
+  problem->AddResidualBlock(residual_block.switch_prior, nullptr, switch_variable);
+  problem->SetParameterLowerBound(switch_variable, 0, 0.);
+  problem->SetParameterUpperBound(switch_variable, 0, 1.);
+}
+
+int PoseGraph2D::RejectOutliers() {
+  std::vector<int> candidates;
+  for (size_t i = vetted_up_to_; i < constraints_.size(); ++i) {
+    if (IsLoopClosure(i)) candidates.push_back(i);
+  }
+  vetted_up_to_ = constraints_.size();
+  if (candidates.empty()) return 0;
+
+  // Everything but the candidates is trusted and enters without a loss function. Candidates
+  // that a partial solve already added to problem_ enter over new cost functions, since
+  // switchable ones would bring their switches along.
+  GncOutlierRejection rejection(options_.outlier_rejection, options_.solver, 3);
+  ceres::Problem::Options problem_options;
+  problem_options.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  ceres::Problem problem(problem_options);
+  std::vector<ceres::CostFunction*> new_cost_functions;
+  std::vector<ceres::ResidualBlockId> candidate_blocks;
+  size_t next_candidate = 0;
+  for (size_t i = 0; i < constraints_.size(); ++i) {
+    const bool is_candidate =
+        next_candidate < candidates.size() && candidates[next_candidate] == static_cast<int>(i);
+    next_candidate += is_candidate;
+    if (i < residual_blocks_.size() && !is_candidate) {
+      AddToProblem(i, nullptr, &problem);
+      continue;
+    }
+    ceres::CostFunction* cost_function = MakeCostFunction(i);
+    if (i >= residual_blocks_.size()) new_cost_functions.push_back(cost_function);
+    const ceres::ResidualBlockId residual_block = problem.AddResidualBlock(
+        cost_function, is_candidate ? rejection.loss() : nullptr,
+        pose_block(constraints_[i].source), pose_block(constraints_[i].target));
+    if (is_candidate) candidate_blocks.push_back(residual_block);
+  }
+  for (int id : constant_poses_) {
+    double* block = pose_block(id);
+    if (problem.HasParameterBlock(block)) problem.SetParameterBlockConstant(block);
+  }
+
+  const std::vector<bool> inliers = rejection.Run(candidate_blocks, &problem);
+  int num_rejected = 0;
+  bool rebuild = false;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (inliers[i]) continue;
+    rejected_[candidates[i]] = true;
+    ++num_rejected;
+    if (static_cast<size_t>(candidates[i]) < residual_blocks_.size()) {
+      residual_blocks_[candidates[i]] = {nullptr, nullptr};
+      rebuild = true;
+    }
+  }
+  // problem_ keeps no residual block ids to remove the rejected ones by.
+  if (rebuild) RebuildProblem();
+  for (ceres::CostFunction* cost_function : new_cost_functions) {
+    AddResidualBlock(residual_blocks_.size(), cost_function);
+  }
+  return num_rejected;
+}
+
+void PoseGraph2D::ApplyConstantPoses() {
+  for (int id : constant_poses_) {
+    double* block = pose_block(id);
+    if (problem_->HasParameterBlock(block)) problem_->SetParameterBlockConstant(block);
+  }
+}
+
+std::vector<int> PoseGraph2D::IncrementalRegion() const {
+  std::unordered_set<int> visited;
+  std::vector<int> frontier;
+  auto visit = [&](int index, std::vector<int>* next) {
+    if (visited.insert(index).second) next->push_back(index);
+  };
+  for (size_t i = num_constraints_solved_; i < constraints_.size(); ++i) {
+    visit(pose_indices_.at(constraints_[i].source), &frontier);
+    visit(pose_indices_.at(constraints_[i].target), &frontier);
+  }
+  for (int hop = 0; hop < options_.incremental_hops && !frontier.empty(); ++hop) {
+    std::vector<int> next;
+    for (int index : frontier) {
+      for (int constraint_index : pose_constraints_[index]) {
+        const Constraint& constraint = constraints_[constraint_index];
+        visit(pose_indices_.at(constraint.source), &next);
+        visit(pose_indices_.at(constraint.target), &next);
+      }
+    }
+    frontier.swap(next);
+  }
+  return std::vector<int>(visited.begin(), visited.end());
+}
+
+std::vector<int> PoseGraph2D::SlidingWindowRegion() const {
+  const int end = pose_ids_.size();
+  std::vector<int> region;
+  for (int index = std::max(0, end - options_.sliding_window_size); index < end; ++index) {
+    region.push_back(index);
+  }
+  return region;
+}
+
+void PoseGraph2D::SolveRegion(const std::vector<int>& region,
+                              std::chrono::steady_clock::time_point start, SolveReport* report) {
+  std::vector<bool> in_region(pose_ids_.size(), false);
+  std::vector<int> constraint_indices;
+  for (int index : region) {
+    in_region[index] = true;
+    constraint_indices.insert(constraint_indices.end(), pose_constraints_[index].begin(),
+                              pose_constraints_[index].end());
+  }
+  std::sort(constraint_indices.begin(), constraint_indices.end());
+  constraint_indices.erase(std::unique(constraint_indices.begin(), constraint_indices.end()),
+                           constraint_indices.end());
+
+  // The cost functions stay owned by cost_functions_, the loss function by the graph.
+  ceres::Problem::Options problem_options;
+  problem_options.cost_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  ceres::Problem problem(problem_options);
+  for (int constraint_index : constraint_indices) {
+    if (!residual_blocks_[constraint_index].cost_function) continue;
+    const Constraint& constraint = constraints_[constraint_index];
+    AddToProblem(constraint_index, loss_function_.get(), &problem);
+    for (int id : {constraint.source, constraint.target}) {
+      if (!in_region[pose_indices_.at(id)] || constant_poses_.count(id) > 0) {
+        problem.SetParameterBlockConstant(pose_block(id));
+      }
+    }
+  }
+  SolveAndReport(options_.solver, start, &problem, report);
+}
+
+SolveReport PoseGraph2D::Solve() { return Solve(options_.solve_mode); }
+
+SolveReport PoseGraph2D::Solve(SolveMode mode) {
+  SolveReport report;
+  report.num_poses = pose_ids_.size();
+  report.num_constraints = constraints_.size();
+
+  const auto update_start = std::chrono::steady_clock::now();
+  if (pose_blocks_moved_) RebuildProblem();
+  if (mode == SolveMode::kBatch && options_.outlier_rejection.enabled) {
+    report.num_rejected_constraints = RejectOutliers();
+  }
+  while (residual_blocks_.size() < constraints_.size()) {
+    AddResidualBlock(residual_blocks_.size());
+  }
+  ApplyConstantPoses();
+  std::vector<int> region;
+  if (mode == SolveMode::kIncremental) {
+    region = IncrementalRegion();
+  } else if (mode == SolveMode::kSlidingWindow) {
+    region = SlidingWindowRegion();
+  }
+  report.problem_update_time_seconds = SecondsSince(update_start);
+
+  if (mode == SolveMode::kBatch) {
+    report.num_variable_poses = pose_ids_.size() - constant_poses_.size();
+    SolveAndReport(options_.solver, update_start, problem_.get(), &report);
+  } else {
+    report.num_variable_poses = region.size();
+    for (int index : region) report.num_variable_poses -= constant_poses_.count(pose_ids_[index]);
+    SolveRegion(region, update_start, &report);
+  }
+  num_constraints_solved_ = constraints_.size();
+  return report;
+}
+
+bool PoseGraph2D::ComputeCovariances(const std::vector<std::pair<int, int>>& id_pairs,
+                                     std::vector<Eigen::Matrix3d>* covariances) {
+  if (pose_blocks_moved_) {
+    // Re-adds the constraints of the last solve over the moved pose blocks.
+    RebuildProblem();
+    ApplyConstantPoses();
+  }
+  std::vector<BlockPair> block_pairs;
+  block_pairs.reserve(id_pairs.size());
+  for (const auto& id_pair : id_pairs) {
+    if (!HasPose(id_pair.first) || !HasPose(id_pair.second)) return false;
+    block_pairs.emplace_back(pose_block(id_pair.first), pose_block(id_pair.second));
+  }
+  std::vector<Eigen::MatrixXd> blocks;
+  if (!ComputeCovarianceBlocks(options_.covariance, 3, block_pairs, problem_.get(), &blocks)) {
+    return false;
+  }
+  covariances->assign(blocks.begin(), blocks.end());
+  return true;
+}
+
+bool PoseGraph2D::ComputeCovariance(int id, Eigen::Matrix3d* covariance) {
+  std::vector<Eigen::Matrix3d> covariances;
+  if (!ComputeCovariances({{id, id}}, &covariances)) return false;
+  *covariance = covariances[0];
+  return true;
+}
+
+PoseGraphData2D ToPoseGraphData(const PoseGraph2D& graph) {
+  PoseGraphData2D data;
+  data.pose_ids = graph.pose_ids();
+  data.poses.reserve(graph.num_poses());
+  for (int id : graph.pose_ids()) {
+    data.poses.push_back(graph.pose(id));
+    if (graph.IsPoseConstant(id)) data.fixed_pose_ids.push_back(id);
+  }
+  data.constraints = graph.constraints();
+  return data;
+}
+
+SolveReport OptimizeAutodiffCostFunctor(const std::vector<Constraint>& constraints,
+                                        std::map<int, Pose>* poses_ptr,
+                                        const SolverOptions& solver_options) {
+  return Optimize(PoseGraph2D::CostFunctorType::kAutodiff, constraints, poses_ptr, solver_options);
+}
+
+SolveReport OptimizeAnalyticCostFunctor(const std::vector<Constraint>& constraints,
+                                        std::map<int, Pose>* poses_ptr,
+                                        const SolverOptions& solver_options) {
+  return Optimize(PoseGraph2D::CostFunctorType::kAnalytic, constraints, poses_ptr, solver_options);
+}
+
+}  // namespace spa
+}  // namespace robot
@@ -0,0 +1,249 @@
+#include "pose_graph_3d.h"
+
+#include <chrono>
+#include <cstdlib>
+
+#include "cost_functors.h"
+
+namespace robot {
+namespace spa {
+namespace {
+
+double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+Eigen::Matrix<double, 6, 6> TangentInformation(const Eigen::Matrix<double, 6, 6>& information) {
+  Eigen::Matrix<double, 6, 1> scale;
+  scale << 1., 1., 1., 0.5, 0.5, 0.5;
+  return scale.asDiagonal() * information * scale.asDiagonal();
+}
+
+PoseGraph3D::PoseGraph3D() : PoseGraph3D(Options()) {}
+
+PoseGraph3D::PoseGraph3D(const Options& options)
+    : options_(options),
+      manifold_(new SE3Manifold),
+      loss_function_(MakeLossFunction(options.loss)) {
+  RebuildProblem();
+}
+
+void PoseGraph3D::Reserve(int num_poses, int num_constraints) {
+  if (kSE3BlockSize * static_cast<size_t>(num_poses) > pose_blocks_.capacity() &&
+      num_residual_blocks_ > 0) {
+    pose_blocks_moved_ = true;
+  }
+  pose_blocks_.reserve(kSE3BlockSize * num_poses);
+  pose_ids_.reserve(num_poses);
+  constraints_.reserve(num_constraints);
+  sqrt_information_.reserve(num_constraints);
+}
+
+bool PoseGraph3D::AddPose(int id, const common::SE3d& pose) {
+  if (!pose_indices_.emplace(id, pose_ids_.size()).second) return false;
+  if (pose_blocks_.size() + kSE3BlockSize > pose_blocks_.capacity() && num_residual_blocks_ > 0) {
+    pose_blocks_moved_ = true;
+  }
+  pose_blocks_.resize(pose_blocks_.size() + kSE3BlockSize);
+  common::SE3d normalized = pose;
+  normalized.rotation().normalize();
+  SE3ToBlock(normalized, &pose_blocks_[pose_blocks_.size() - kSE3BlockSize]);
+  pose_ids_.push_back(id);
+  if (pose_ids_.size() == 1) constant_poses_.insert(id);
+  return true;
+}
+
+common::SE3d PoseGraph3D::pose(int id) const {
+  return SE3FromBlock(&pose_blocks_[kSE3BlockSize * pose_indices_.at(id)]);
+}
+
+bool PoseGraph3D::AddConstraint(const Constraint3d& constraint) {
+  if (!HasPose(constraint.source) || !HasPose(constraint.target)) return false;
+  const Eigen::LLT<Eigen::Matrix<double, 6, 6>> llt(TangentInformation(constraint.information));
+  if (llt.info() != Eigen::Success) return false;
+  sqrt_information_.push_back(llt.matrixU());
+  constraints_.push_back(constraint);
+  switches_.push_back(1.);
+  rejected_.push_back(false);
+  return true;
+}
+
+bool PoseGraph3D::IsLoopClosure(int constraint_index) const {
+  const Constraint3d& constraint = constraints_[constraint_index];
+  return std::abs(pose_indices_.at(constraint.target) - pose_indices_.at(constraint.source)) != 1;
+}
+
+bool PoseGraph3D::SetPoseConstant(int id, bool constant) {
+  if (!HasPose(id)) return false;
+  if (constant) {
+    constant_poses_.insert(id);
+  } else {
+    constant_poses_.erase(id);
+  }
+  if (pose_blocks_moved_) return true;
+  double* block = pose_block(id);
+  if (!problem_->HasParameterBlock(block)) return true;
+  if (constant) {
+    problem_->SetParameterBlockConstant(block);
+  } else {
+    problem_->SetParameterBlockVariable(block);
+  }
+  return true;
+}
+
+void PoseGraph3D::RebuildProblem() {
+  ceres::Problem::Options problem_options;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.manifold_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_.reset(new ceres::Problem(problem_options));
+  num_residual_blocks_ = 0;
+  pose_blocks_moved_ = false;
+}
+
+ceres::ResidualBlockId PoseGraph3D::AddToProblem(int constraint_index,
+                                                 ceres::LossFunction* loss_function,
+                                                 ceres::Problem* problem,
+                                                 bool allow_switch) {
+  const Constraint3d& constraint = constraints_[constraint_index];
+  double* source = pose_block(constraint.source);
+  double* target = pose_block(constraint.target);
+  ceres::CostFunction* cost_function =
+      new SpaCostFunctorSE3(ToSE3(constraint.relative_pose), sqrt_information_[constraint_index]);
+  ceres::ResidualBlockId residual_block;
+  if (allow_switch && options_.loss.type == RobustLossOptions::Type::kSwitchable &&
+      IsLoopClosure(constraint_index)) {
+    double* switch_variable = &switches_[constraint_index];
+    residual_block = problem->AddResidualBlock(new SwitchableCostFunction(cost_function), nullptr,
+                                               source, target, switch_variable);
+    problem->AddResidualBlock(new SwitchPriorCostFunction(options_.loss.switch_prior_stddev),
+                              nullptr, switch_variable);
+    problem->SetParameterLowerBound(switch_variable, 0, 0.);
+    problem->SetParameterUpperBound(switch_variable, 0, 1.);
+  } else {
+    residual_block = problem->AddResidualBlock(cost_function, loss_function, source, target);
+  }
+  for (double* block : {source, target}) {
+    if (problem->GetManifold(block) == nullptr) problem->SetManifold(block, manifold_.get());
+  }
+  return residual_block;
+}
+
+void PoseGraph3D::AddResidualBlocks(size_t end) {
+  for (; num_residual_blocks_ < end; ++num_residual_blocks_) {
+    if (!rejected_[num_residual_blocks_]) {
+      AddToProblem(num_residual_blocks_, loss_function_.get(), problem_.get());
+    }
+  }
+}
+
+int PoseGraph3D::RejectOutliers() {
+  std::vector<int> candidates;
+  for (size_t i = vetted_up_to_; i < constraints_.size(); ++i) {
+    if (IsLoopClosure(i)) candidates.push_back(i);
+  }
+  vetted_up_to_ = constraints_.size();
+  if (candidates.empty()) return 0;
+
+  // Everything but the candidates is trusted and enters without a loss function. Candidates
+  // enter without switches, which would take their weight away from the GNC loss. Every solve
+  // vets first, so no candidate has a residual block in problem_ yet.
+  GncOutlierRejection rejection(options_.outlier_rejection, options_.solver, 6);
+  ceres::Problem::Options problem_options;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  problem_options.manifold_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  ceres::Problem problem(problem_options);
+  std::vector<ceres::ResidualBlockId> candidate_blocks;
+  size_t next_candidate = 0;
+  for (size_t i = 0; i < constraints_.size(); ++i) {
+    if (next_candidate < candidates.size() && candidates[next_candidate] == static_cast<int>(i)) {
+      candidate_blocks.push_back(AddToProblem(i, rejection.loss(), &problem, false));
+      ++next_candidate;
+    } else if (!rejected_[i]) {
+      AddToProblem(i, nullptr, &problem);
+    }
+  }
+  for (int id : constant_poses_) {
+    double* block = pose_block(id);
+    if (problem.HasParameterBlock(block)) problem.SetParameterBlockConstant(block);
+  }
+
+  const std::vector<bool> inliers = rejection.Run(candidate_blocks, &problem);
+  int num_rejected = 0;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (inliers[i]) continue;
+    rejected_[candidates[i]] = true;
+    ++num_rejected;
+  }
+  return num_rejected;
+}
+
+void PoseGraph3D::ApplyConstantPoses() {
+  for (int id : constant_poses_) {
+    double* block = pose_block(id);
+    if (problem_->HasParameterBlock(block)) problem_->SetParameterBlockConstant(block);
+  }
+}
+
+SolveReport PoseGraph3D::Solve() {
+  SolveReport report;
+  report.num_poses = pose_ids_.size();
+  report.num_constraints = constraints_.size();
+  report.num_variable_poses = pose_ids_.size() - constant_poses_.size();
+
+  const auto update_start = std::chrono::steady_clock::now();
+  if (pose_blocks_moved_) RebuildProblem();
+  if (options_.outlier_rejection.enabled) report.num_rejected_constraints = RejectOutliers();
+  AddResidualBlocks(constraints_.size());
+  ApplyConstantPoses();
+  report.problem_update_time_seconds = SecondsSince(update_start);
+
+  SolveAndReport(options_.solver, update_start, problem_.get(), &report);
+  return report;
+}
+
+bool PoseGraph3D::ComputeCovariances(const std::vector<std::pair<int, int>>& id_pairs,
+                                     std::vector<Eigen::Matrix<double, 6, 6>>* covariances) {
+  if (pose_blocks_moved_) {
+    // Re-adds the constraints of the last solve over the moved pose blocks.
+    const size_t num_residual_blocks = num_residual_blocks_;
+    RebuildProblem();
+    AddResidualBlocks(num_residual_blocks);
+    ApplyConstantPoses();
+  }
+  std::vector<BlockPair> block_pairs;
+  block_pairs.reserve(id_pairs.size());
+  for (const auto& id_pair : id_pairs) {
+    if (!HasPose(id_pair.first) || !HasPose(id_pair.second)) return false;
+    block_pairs.emplace_back(pose_block(id_pair.first), pose_block(id_pair.second));
+  }
+  std::vector<Eigen::MatrixXd> blocks;
+  if (!ComputeCovarianceBlocks(options_.covariance, 6, block_pairs, problem_.get(), &blocks)) {
+    return false;
+  }
+  covariances->assign(blocks.begin(), blocks.end());
+  return true;
+}
+
+bool PoseGraph3D::ComputeCovariance(int id, Eigen::Matrix<double, 6, 6>* covariance) {
+  std::vector<Eigen::Matrix<double, 6, 6>> covariances;
+  if (!ComputeCovariances({{id, id}}, &covariances)) return false;
+  *covariance = covariances[0];
+  return true;
+}
+
+PoseGraphData3D ToPoseGraphData(const PoseGraph3D& graph) {
+  PoseGraphData3D data;
+  data.pose_ids = graph.pose_ids();
+  data.poses.reserve(graph.num_poses());
+  for (int id : graph.pose_ids()) {
+    data.poses.push_back(ToPose3d(graph.pose(id)));
+    if (graph.IsPoseConstant(id)) data.fixed_pose_ids.push_back(id);
+  }
+  data.constraints = graph.constraints();
+  return data;
+}
+
+}  // namespace spa
+}  // namespace robot
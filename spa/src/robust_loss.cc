@@ -0,0 +1,137 @@
+#include "robust_loss.h"
+
+#include <algorithm>
+
+namespace robot {
+namespace spa {
+namespace {
+
+// 99% quantiles of the chi-square distribution.
+double ChiSquare99(int degrees_of_freedom) {
+  static const double kQuantiles[] = {6.635, 9.210, 11.345, 13.277, 15.086, 16.812};
+  return kQuantiles[std::min(std::max(degrees_of_freedom, 1), 6) - 1];
+}
+
+double SquaredError(const ceres::Problem& problem, ceres::ResidualBlockId residual_block) {
+  double cost = 0.;
+  problem.EvaluateResidualBlock(residual_block, false, &cost, nullptr, nullptr);
+  return 2. * cost;
+}
+
+}  // namespace
+
+std::unique_ptr<ceres::LossFunction> MakeLossFunction(const RobustLossOptions& options) {
+  using Type = RobustLossOptions::Type;
+  switch (options.type) {
+    case Type::kHuber:
+      return std::unique_ptr<ceres::LossFunction>(new ceres::HuberLoss(options.scale));
+    case Type::kCauchy:
+      return std::unique_ptr<ceres::LossFunction>(new ceres::CauchyLoss(options.scale));
+    case Type::kTukey:
+      return std::unique_ptr<ceres::LossFunction>(new ceres::TukeyLoss(options.scale));
+    case Type::kDcs:
+      return std::unique_ptr<ceres::LossFunction>(new DcsLoss(options.scale * options.scale));
+    case Type::kTrivial:
+    case Type::kSwitchable:
+      break;
+  }
+  return nullptr;
+}
+
+// The weight w(s) = 4 phi^2 / (phi + s)^2 past s = phi integrates to
+// rho(s) = 3 phi - 4 phi^2 / (phi + s), which meets rho(s) = s continuously at phi.
+void DcsLoss::Evaluate(double s, double rho[3]) const {
+  if (s <= phi_) {
+    rho[0] = s;
+    rho[1] = 1.;
+    rho[2] = 0.;
+    return;
+  }
+  const double inverse = 1. / (phi_ + s);
+  const double weight = 4. * phi_ * phi_ * inverse * inverse;
+  rho[0] = 3. * phi_ - 4. * phi_ * phi_ * inverse;
+  rho[1] = weight;
+  rho[2] = -2. * weight * inverse;
+}
+
+SwitchableCostFunction::SwitchableCostFunction(ceres::CostFunction* cost_function,
+                                               ceres::Ownership ownership)
+    : cost_function_(cost_function), ownership_(ownership) {
+  set_num_residuals(cost_function->num_residuals());
+  *mutable_parameter_block_sizes() = cost_function->parameter_block_sizes();
+  mutable_parameter_block_sizes()->push_back(1);
+}
+
+SwitchableCostFunction::~SwitchableCostFunction() {
+  if (ownership_ == ceres::TAKE_OWNERSHIP) delete cost_function_;
+}
+
+bool SwitchableCostFunction::Evaluate(const double* const* parameters, double* residuals,
+                                      double** jacobians) const {
+  const int num_blocks = cost_function_->parameter_block_sizes().size();
+  if (!cost_function_->Evaluate(parameters, residuals, jacobians)) return false;
+  const double weight = parameters[num_blocks][0];
+  const int num_residuals = cost_function_->num_residuals();
+  if (jacobians) {
+    for (int block = 0; block < num_blocks; ++block) {
+      if (!jacobians[block]) continue;
+      const int size = num_residuals * cost_function_->parameter_block_sizes()[block];
+      for (int i = 0; i < size; ++i) jacobians[block][i] *= weight;
+    }
+    if (jacobians[num_blocks]) {
+      std::copy(residuals, residuals + num_residuals, jacobians[num_blocks]);
+    }
+  }
+  for (int i = 0; i < num_residuals; ++i) residuals[i] *= weight;
+  return true;
+}
+
+GncOutlierRejection::GncOutlierRejection(const OutlierRejectionOptions& options,
+                                         const SolverOptions& solver, int residual_dimension)
+    : options_(options),
+      solver_(solver),
+      max_squared_error_(options.max_squared_error > 0. ? options.max_squared_error
+                                                        : ChiSquare99(residual_dimension)) {}
+
+void GncOutlierRejection::GemanMcClureLoss::Evaluate(double s, double rho[3]) const {
+  const double inverse = 1. / (mu_c_sq + s);
+  const double weight = mu_c_sq * mu_c_sq * inverse * inverse;
+  rho[0] = mu_c_sq * s * inverse;
+  rho[1] = weight;
+  rho[2] = -2. * weight * inverse;
+}
+
+std::vector<bool> GncOutlierRejection::Run(const std::vector<ceres::ResidualBlockId>& candidates,
+                                           ceres::Problem* problem) {
+  std::vector<bool> inliers(candidates.size(), true);
+  if (candidates.empty()) return inliers;
+
+  ceres::Solver::Options solver_options = ToCeresSolverOptions(solver_);
+  solver_options.max_num_iterations = options_.max_iterations_per_step;
+  ceres::Solver::Summary summary;
+  auto solve = [&](double mu) {
+    loss_.mu_c_sq = mu * max_squared_error_;
+    ceres::Solve(solver_options, problem, &summary);
+  };
+
+  // A nearly quadratic kernel first: the plain least-squares estimate.
+  solve(1e12);
+  double max_error = 0.;
+  for (ceres::ResidualBlockId candidate : candidates) {
+    max_error = std::max(max_error, SquaredError(*problem, candidate));
+  }
+  double mu = 2. * max_error / max_squared_error_;
+  for (int step = 0; step < options_.max_gnc_steps && mu > 1.; ++step) {
+    solve(mu);
+    mu /= options_.gnc_factor;
+  }
+  solve(1.);
+
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    inliers[i] = SquaredError(*problem, candidates[i]) <= max_squared_error_;
+  }
+  return inliers;
+}
+
+}  // namespace spa
+}  // namespace robot
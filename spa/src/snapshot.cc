@@ -0,0 +1,223 @@
+#include "snapshot.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+#include "version.h"
+
+namespace robot {
+namespace spa {
+namespace {
+
+constexpr char kMagic[8] = {'S', 'P', 'A', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t kByteOrder = 0x01020304;
+constexpr uint64_t kAlignment = 64;
+
+uint64_t Align(uint64_t offset) { return (offset + kAlignment - 1) / kAlignment * kAlignment; }
+
+SnapshotConstraint2D ToRecord(const Constraint& constraint) {
+  SnapshotConstraint2D record;
+  record.source = constraint.source;
+  record.target = constraint.target;
+  record.relative_pose[0] = constraint.relative_pose.translation.x();
+  record.relative_pose[1] = constraint.relative_pose.translation.y();
+  record.relative_pose[2] = constraint.relative_pose.rotation.angle();
+  std::memcpy(record.information, constraint.information.data(), sizeof(record.information));
+  return record;
+}
+
+SnapshotConstraint3D ToRecord(const Constraint3d& constraint) {
+  SnapshotConstraint3D record;
+  record.source = constraint.source;
+  record.target = constraint.target;
+  Eigen::Map<Eigen::Vector3d>(record.relative_pose) = constraint.relative_pose.translation;
+  Eigen::Map<Eigen::Vector4d>(record.relative_pose + 3) =
+      constraint.relative_pose.rotation.coeffs();
+  std::memcpy(record.information, constraint.information.data(), sizeof(record.information));
+  return record;
+}
+
+void AppendPose(const Pose& pose, std::vector<double>* values) {
+  values->insert(values->end(),
+                 {pose.translation.x(), pose.translation.y(), pose.rotation.angle()});
+}
+
+void AppendPose(const Pose3d& pose, std::vector<double>* values) {
+  values->insert(values->end(), pose.translation.data(), pose.translation.data() + 3);
+  values->insert(values->end(), pose.rotation.coeffs().data(),
+                 pose.rotation.coeffs().data() + 4);
+}
+
+// Writes sections at increasing offsets, zero-filling the gaps between them.
+class SectionWriter {
+ public:
+  explicit SectionWriter(std::FILE* file) : file_(file) {}
+
+  void Write(uint64_t offset, const void* data, size_t size) {
+    static const char kZeros[kAlignment] = {};
+    ok_ = ok_ && std::fwrite(kZeros, 1, offset - position_, file_) == offset - position_;
+    // Empty sections may have no data pointer at all, which fwrite does not accept.
+    if (size > 0) ok_ = ok_ && std::fwrite(data, 1, size, file_) == size;
+    position_ = offset + size;
+  }
+  bool ok() const { return ok_; }
+
+ private:
+  std::FILE* file_;
+  uint64_t position_ = 0;
+  bool ok_ = true;
+};
+
+template <typename Data>
+bool Write(const std::string& path, const Data& data, int dimension, std::string* error) {
+  using Record = decltype(ToRecord(data.constraints.front()));
+  const size_t pose_size = dimension == 2 ? 3 : 7;
+  std::vector<double> poses;
+  poses.reserve(pose_size * data.poses.size());
+  for (const auto& pose : data.poses) AppendPose(pose, &poses);
+  std::vector<Record> constraints;
+  constraints.reserve(data.constraints.size());
+  for (const auto& constraint : data.constraints) constraints.push_back(ToRecord(constraint));
+  const std::vector<int32_t> pose_ids(data.pose_ids.begin(), data.pose_ids.end());
+  const std::vector<int32_t> fixed_pose_ids(data.fixed_pose_ids.begin(),
+                                            data.fixed_pose_ids.end());
+
+  SnapshotHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.byte_order = kByteOrder;
+  header.version_major = VERSION_MAJOR;
+  header.version_minor = VERSION_MINOR;
+  header.dimension = dimension;
+  header.num_poses = pose_ids.size();
+  header.num_constraints = constraints.size();
+  header.num_fixed_poses = fixed_pose_ids.size();
+  header.pose_ids_offset = Align(sizeof(header));
+  header.poses_offset = Align(header.pose_ids_offset + pose_ids.size() * sizeof(int32_t));
+  header.constraints_offset = Align(header.poses_offset + poses.size() * sizeof(double));
+  header.fixed_pose_ids_offset =
+      Align(header.constraints_offset + constraints.size() * sizeof(Record));
+  header.file_size = header.fixed_pose_ids_offset + fixed_pose_ids.size() * sizeof(int32_t);
+
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    if (error) *error = path + ": " + std::strerror(errno);
+    return false;
+  }
+  SectionWriter writer(file);
+  writer.Write(0, &header, sizeof(header));
+  writer.Write(header.pose_ids_offset, pose_ids.data(), pose_ids.size() * sizeof(int32_t));
+  writer.Write(header.poses_offset, poses.data(), poses.size() * sizeof(double));
+  writer.Write(header.constraints_offset, constraints.data(),
+               constraints.size() * sizeof(Record));
+  writer.Write(header.fixed_pose_ids_offset, fixed_pose_ids.data(),
+               fixed_pose_ids.size() * sizeof(int32_t));
+  if (std::fclose(file) != 0 || !writer.ok()) {
+    if (error) *error = path + ": write failed";
+    return false;
+  }
+  return true;
+}
+
+// Whether `count` elements of `size` bytes at `offset` lie within a file of `file_size` bytes.
+bool InBounds(uint64_t offset, uint64_t count, uint64_t size, uint64_t file_size) {
+  return offset % alignof(double) == 0 && offset <= file_size &&
+         count <= (file_size - offset) / size;
+}
+
+}  // namespace
+
+bool WriteSnapshot(const std::string& path, const PoseGraphData2D& data, std::string* error) {
+  return Write(path, data, 2, error);
+}
+
+bool WriteSnapshot(const std::string& path, const PoseGraphData3D& data, std::string* error) {
+  return Write(path, data, 3, error);
+}
+
+bool WriteSnapshot(const std::string& path, const PoseGraph2D& graph, std::string* error) {
+  return Write(path, ToPoseGraphData(graph), 2, error);
+}
+
+bool PoseGraphSnapshot::Open(const std::string& path, std::string* error) {
+  header_ = nullptr;
+  if (!file_.Open(path, false, error)) return false;
+  auto fail = [&](const std::string& message) {
+    if (error) *error = path + ": " + message;
+    file_.Close();
+    return false;
+  };
+  if (file_.size() < sizeof(SnapshotHeader)) return fail("not a pose graph snapshot");
+  const SnapshotHeader* header = reinterpret_cast<const SnapshotHeader*>(file_.data());
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0) {
+    return fail("not a pose graph snapshot");
+  }
+  if (header->byte_order != kByteOrder) return fail("snapshot has foreign byte order");
+  if (header->version_major != VERSION_MAJOR || header->version_minor > VERSION_MINOR) {
+    return fail("snapshot version " + std::to_string(header->version_major) + "." +
+                std::to_string(header->version_minor) + " is not readable by version " +
+                std::to_string(VERSION_MAJOR) + "." + std::to_string(VERSION_MINOR));
+  }
+  if (header->dimension != 2 && header->dimension != 3) return fail("bad snapshot dimension");
+  const size_t size = file_.size();
+  const size_t pose_size = header->dimension == 2 ? 3 * sizeof(double) : 7 * sizeof(double);
+  const size_t constraint_size = header->dimension == 2 ? sizeof(SnapshotConstraint2D)
+                                                        : sizeof(SnapshotConstraint3D);
+  if (header->file_size != size ||
+      !InBounds(header->pose_ids_offset, header->num_poses, sizeof(int32_t), size) ||
+      !InBounds(header->poses_offset, header->num_poses, pose_size, size) ||
+      !InBounds(header->constraints_offset, header->num_constraints, constraint_size, size) ||
+      !InBounds(header->fixed_pose_ids_offset, header->num_fixed_poses, sizeof(int32_t),
+                size)) {
+    return fail("snapshot is truncated or corrupt");
+  }
+  header_ = header;
+  return true;
+}
+
+bool AddToPoseGraph(const PoseGraphSnapshot& snapshot, PoseGraph2D* graph, std::string* error) {
+  if (snapshot.dimension() != 2) {
+    if (error) *error = "snapshot is not 2D";
+    return false;
+  }
+  graph->Reserve(graph->num_poses() + snapshot.num_poses(),
+                 graph->constraints().size() + snapshot.num_constraints());
+  const int32_t* ids = snapshot.pose_ids();
+  const double* poses = snapshot.poses();
+  for (size_t i = 0; i < snapshot.num_poses(); ++i) {
+    const double* pose = poses + 3 * i;
+    if (!graph->AddPose(ids[i], {Eigen::Vector2d(pose[0], pose[1]),
+                                 Eigen::Rotation2Dd(pose[2])})) {
+      if (error) *error = "duplicate pose " + std::to_string(ids[i]);
+      return false;
+    }
+  }
+  const SnapshotConstraint2D* constraints = snapshot.constraints_2d();
+  for (size_t i = 0; i < snapshot.num_constraints(); ++i) {
+    const SnapshotConstraint2D& record = constraints[i];
+    Constraint constraint;
+    constraint.source = record.source;
+    constraint.target = record.target;
+    constraint.relative_pose = {
+        Eigen::Vector2d(record.relative_pose[0], record.relative_pose[1]),
+        Eigen::Rotation2Dd(record.relative_pose[2])};
+    constraint.information = Eigen::Map<const Eigen::Matrix3d>(record.information);
+    if (!graph->AddConstraint(constraint)) {
+      if (error) *error = "rejected constraint " + std::to_string(i);
+      return false;
+    }
+  }
+  if (snapshot.num_fixed_poses() > 0) {
+    const std::unordered_set<int> fixed(snapshot.fixed_pose_ids(),
+                                        snapshot.fixed_pose_ids() + snapshot.num_fixed_poses());
+    for (size_t i = 0; i < snapshot.num_poses(); ++i) {
+      graph->SetPoseConstant(ids[i], fixed.count(ids[i]) > 0);
+    }
+  }
+  return true;
+}
+
+}  // namespace spa
+}  // namespace robot
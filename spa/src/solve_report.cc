@@ -0,0 +1,92 @@
+#include "solve_report.h"
+
+#include <sys/resource.h>
+
+namespace robot {
+namespace spa {
+namespace {
+
+double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Forwards every iteration to the user callback and ends the solve once the time budget is
+// spent. Ceres keeps the estimate of the last iteration when a callback terminates it.
+class StoppingCallback : public ceres::IterationCallback {
+ public:
+  StoppingCallback(const SolverOptions& options, std::chrono::steady_clock::time_point start,
+                   SolveReport* report)
+      : options_(options), start_(start), report_(report) {}
+
+  ceres::CallbackReturnType operator()(const ceres::IterationSummary& summary) override {
+    if (options_.iteration_callback && !options_.iteration_callback(summary)) {
+      report_->stopped_by_callback = true;
+      return ceres::SOLVER_TERMINATE_SUCCESSFULLY;
+    }
+    if (options_.time_budget_seconds > 0. && SecondsSince(start_) >= options_.time_budget_seconds) {
+      report_->time_budget_exceeded = true;
+      return ceres::SOLVER_TERMINATE_SUCCESSFULLY;
+    }
+    return ceres::SOLVER_CONTINUE;
+  }
+
+ private:
+  const SolverOptions& options_;
+  const std::chrono::steady_clock::time_point start_;
+  SolveReport* report_;
+};
+
+int CountDownweightedResiduals(const ceres::Problem& problem) {
+  std::vector<ceres::ResidualBlockId> residual_blocks;
+  problem.GetResidualBlocks(&residual_blocks);
+  int count = 0;
+  for (ceres::ResidualBlockId residual_block : residual_blocks) {
+    const ceres::LossFunction* loss_function =
+        problem.GetLossFunctionForResidualBlock(residual_block);
+    double cost;
+    if (loss_function == nullptr ||
+        !problem.EvaluateResidualBlock(residual_block, false, &cost, nullptr, nullptr)) {
+      continue;
+    }
+    double rho[3];
+    loss_function->Evaluate(2. * cost, rho);
+    count += rho[1] < 1.;
+  }
+  return count;
+}
+
+long PeakRssBytes() {
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  // Linux reports kilobytes.
+  return usage.ru_maxrss * 1024L;
+}
+
+}  // namespace
+
+void SolveAndReport(const SolverOptions& options, std::chrono::steady_clock::time_point start,
+                    ceres::Problem* problem, SolveReport* report) {
+  ceres::Solver::Options ceres_options = ToCeresSolverOptions(options);
+  StoppingCallback callback(options, start, report);
+  if (options.iteration_callback || options.time_budget_seconds > 0.) {
+    ceres_options.callbacks.push_back(&callback);
+  }
+  const auto solve_start = std::chrono::steady_clock::now();
+  ceres::Solve(ceres_options, problem, &report->summary);
+  report->solve_time_seconds = SecondsSince(solve_start);
+
+  const ceres::Solver::Summary& summary = report->summary;
+  report->evaluation_time_seconds =
+      summary.residual_evaluation_time_in_seconds + summary.jacobian_evaluation_time_in_seconds;
+  report->linear_solver_time_seconds = summary.linear_solver_time_in_seconds;
+  report->iteration_costs.clear();
+  report->iteration_costs.reserve(summary.iterations.size());
+  for (const ceres::IterationSummary& iteration : summary.iterations) {
+    report->iteration_costs.push_back(iteration.cost);
+  }
+  report->num_downweighted_residuals = CountDownweightedResiduals(*problem);
+  report->peak_rss_bytes = PeakRssBytes();
+}
+
+}  // namespace spa
+}  // namespace robot
@@ -0,0 +1,25 @@
+#include "solver_options.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace robot {
+namespace spa {
+
+ceres::Solver::Options ToCeresSolverOptions(const SolverOptions& options) {
+  ceres::Solver::Options ceres_options;
+  ceres_options.num_threads =
+      options.num_threads > 0
+          ? options.num_threads
+          : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  ceres_options.max_num_iterations = options.max_num_iterations;
+  ceres_options.linear_solver_type = options.linear_solver_type;
+  ceres_options.preconditioner_type = options.preconditioner_type;
+  ceres_options.sparse_linear_algebra_library_type = options.sparse_linear_algebra_library;
+  ceres_options.linear_solver_ordering_type = options.ordering_type;
+  ceres_options.minimizer_progress_to_stdout = options.minimizer_progress_to_stdout;
+  return ceres_options;
+}
+
+}  // namespace spa
+}  // namespace robot
@@ -0,0 +1,155 @@
+#include "submap_pose_graph_2d.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "cost_functors.h"
+
+namespace robot {
+namespace spa {
+namespace {
+
+double SecondsSince(const std::chrono::steady_clock::time_point& start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+Pose Compose(const Pose& lhs, const Pose& rhs) {
+  return {lhs.translation + lhs.rotation * rhs.translation, lhs.rotation * rhs.rotation};
+}
+
+// lhs^-1 * rhs.
+Pose Between(const Pose& lhs, const Pose& rhs) {
+  const Eigen::Rotation2Dd inverse = lhs.rotation.inverse();
+  return {inverse * (rhs.translation - lhs.translation), inverse * rhs.rotation};
+}
+
+}  // namespace
+
+SubmapPoseGraph2D::SubmapPoseGraph2D() : SubmapPoseGraph2D(Options()) {}
+
+SubmapPoseGraph2D::SubmapPoseGraph2D(const Options& options)
+    : options_(options), coarse_loss_function_(MakeLossFunction(options.coarse_loss)) {}
+
+bool SubmapPoseGraph2D::AddPose(int id, const Pose& pose) {
+  const int index = pose_ids_.size();
+  if (!pose_indices_.emplace(id, index).second) return false;
+  pose_ids_.push_back(id);
+  if (submap_index(index) == static_cast<int>(submaps_.size())) {
+    submaps_.emplace_back();
+    submaps_.back().origin = pose;
+  }
+  Submap& submap = submaps_.back();
+  submap.local_poses.push_back(Between(submap.origin, pose));
+  submap.dirty = true;
+  return true;
+}
+
+bool SubmapPoseGraph2D::AddConstraint(const Constraint& constraint) {
+  if (!HasPose(constraint.source) || !HasPose(constraint.target)) return false;
+  if (sqrt_information_.Add(constraint.information) < 0) return false;
+  const int source_submap = submap_index(pose_indices_.at(constraint.source));
+  const int target_submap = submap_index(pose_indices_.at(constraint.target));
+  if (source_submap == target_submap) {
+    submaps_[source_submap].constraints.push_back(constraints_.size());
+    submaps_[source_submap].dirty = true;
+  } else {
+    coarse_constraints_.push_back(constraints_.size());
+  }
+  constraints_.push_back(constraint);
+  return true;
+}
+
+Pose SubmapPoseGraph2D::pose(int id) const {
+  const int index = pose_indices_.at(id);
+  const Submap& submap = submaps_[submap_index(index)];
+  return Compose(submap.origin, submap.local_poses[index % options_.submap_size]);
+}
+
+void SubmapPoseGraph2D::SolveSubmap(int index) {
+  Submap* submap = &submaps_[index];
+  PoseGraph2D::Options options = options_.submap;
+  options.solver.num_threads = 1;
+  PoseGraph2D graph(options);
+  // Members are numbered by their position in the submap; the first anchors it.
+  graph.Reserve(submap->local_poses.size(), submap->constraints.size());
+  for (size_t i = 0; i < submap->local_poses.size(); ++i) graph.AddPose(i, submap->local_poses[i]);
+  const int first_index = options_.submap_size * index;
+  for (int constraint_index : submap->constraints) {
+    Constraint constraint = constraints_[constraint_index];
+    constraint.source = pose_indices_.at(constraint.source) - first_index;
+    constraint.target = pose_indices_.at(constraint.target) - first_index;
+    graph.AddConstraint(constraint);
+  }
+  if (!submap->constraints.empty()) graph.Solve();
+  for (size_t i = 0; i < submap->local_poses.size(); ++i) submap->local_poses[i] = graph.pose(i);
+  submap->dirty = false;
+}
+
+void SubmapPoseGraph2D::SolveCoarse(Report* report) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<double> origins(3 * submaps_.size());
+  for (size_t i = 0; i < submaps_.size(); ++i) {
+    origins[3 * i] = submaps_[i].origin.translation.x();
+    origins[3 * i + 1] = submaps_[i].origin.translation.y();
+    origins[3 * i + 2] = submaps_[i].origin.rotation.angle();
+  }
+
+  ceres::Problem::Options problem_options;
+  problem_options.loss_function_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+  ceres::Problem problem(problem_options);
+  for (int constraint_index : coarse_constraints_) {
+    const Constraint& constraint = constraints_[constraint_index];
+    const int source_index = pose_indices_.at(constraint.source);
+    const int target_index = pose_indices_.at(constraint.target);
+    const int source_submap = submap_index(source_index);
+    const int target_submap = submap_index(target_index);
+    problem.AddResidualBlock(
+        new ceres::AutoDiffCostFunction<SubmapConstraintCostFunctor, 3, 3, 3>(
+            new SubmapConstraintCostFunctor(
+                submaps_[source_submap].local_poses[source_index % options_.submap_size],
+                submaps_[target_submap].local_poses[target_index % options_.submap_size],
+                constraint.relative_pose, &sqrt_information_, constraint_index)),
+        coarse_loss_function_.get(), &origins[3 * source_submap], &origins[3 * target_submap]);
+  }
+  if (problem.HasParameterBlock(origins.data())) problem.SetParameterBlockConstant(origins.data());
+  SolveAndReport(options_.coarse_solver, start, &problem, &report->coarse);
+
+  for (size_t i = 0; i < submaps_.size(); ++i) {
+    submaps_[i].origin.translation = Eigen::Vector2d(origins[3 * i], origins[3 * i + 1]);
+    submaps_[i].origin.rotation = Eigen::Rotation2Dd(origins[3 * i + 2]);
+  }
+}
+
+SubmapPoseGraph2D::Report SubmapPoseGraph2D::Solve() {
+  const auto start = std::chrono::steady_clock::now();
+  Report report;
+  report.num_submaps = submaps_.size();
+
+  std::vector<int> dirty;
+  for (size_t i = 0; i < submaps_.size(); ++i) {
+    if (submaps_[i].dirty) dirty.push_back(i);
+  }
+  report.num_solved_submaps = dirty.size();
+  const int num_threads = std::min<int>(
+      dirty.size(), options_.num_threads > 0 ? options_.num_threads
+                                             : std::max(1u, std::thread::hardware_concurrency()));
+  std::atomic<size_t> next{0};
+  // Every thread solves different submaps and only reads the shared state.
+  auto solve_submaps = [&] {
+    for (size_t i = next++; i < dirty.size(); i = next++) SolveSubmap(dirty[i]);
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) threads.emplace_back(solve_submaps);
+  solve_submaps();
+  for (std::thread& thread : threads) thread.join();
+  report.submap_time_seconds = SecondsSince(start);
+
+  if (!coarse_constraints_.empty()) SolveCoarse(&report);
+  report.total_time_seconds = SecondsSince(start);
+  return report;
+}
+
+}  // namespace spa
+}  // namespace robot
@@ -0,0 +1,275 @@
+#include "synthetic_graph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+
+#include "so3.h"
+
+namespace robot {
+namespace spa {
+namespace {
+
+// Information of a measurement with noise `stddev`, floored so noise-free graphs stay
+// well conditioned.
+double Information(double stddev) {
+  const double floored = std::max(stddev, 1e-3);
+  return 1. / (floored * floored);
+}
+
+struct Traits2D {
+  using PoseType = Pose;
+  using ConstraintType = Constraint;
+  using Graph = SyntheticGraph2D;
+  static constexpr int kDimension = 2;
+
+  static Pose Identity() { return {Eigen::Vector2d::Zero(), Eigen::Rotation2Dd(0.)}; }
+  static Pose Compose(const Pose& a, const Pose& b) {
+    return {a.translation + a.rotation * b.translation, a.rotation * b.rotation};
+  }
+  static Pose Between(const Pose& a, const Pose& b) {
+    const Eigen::Rotation2Dd inverse = a.rotation.inverse();
+    return {inverse * (b.translation - a.translation), inverse * b.rotation};
+  }
+  static Eigen::Vector3d Position(const Pose& pose) {
+    return Eigen::Vector3d(pose.translation.x(), pose.translation.y(), 0.);
+  }
+
+  static Pose Step(const SyntheticGraphOptions& options, std::mt19937* rng) {
+    Pose step = {Eigen::Vector2d(options.step_length, 0.), Eigen::Rotation2Dd(0.)};
+    if (options.topology == SyntheticGraphOptions::Topology::kManhattan) {
+      std::uniform_real_distribution<double> uniform(0., 1.);
+      const double u = uniform(*rng);
+      if (u < options.turn_probability) {
+        step.rotation = Eigen::Rotation2Dd(u < options.turn_probability / 2 ? M_PI / 2
+                                                                            : -M_PI / 2);
+      }
+    } else {
+      step.rotation =
+          Eigen::Rotation2Dd(std::normal_distribution<double>(0., options.turn_stddev)(*rng));
+    }
+    return step;
+  }
+
+  static Pose Perturb(const Pose& pose, const SyntheticGraphOptions& options, std::mt19937* rng) {
+    std::normal_distribution<double> translation_noise(0., options.translation_noise);
+    std::normal_distribution<double> rotation_noise(0., options.rotation_noise);
+    Pose noisy = pose;
+    if (options.translation_noise > 0.) {
+      noisy.translation += Eigen::Vector2d(translation_noise(*rng), translation_noise(*rng));
+    }
+    if (options.rotation_noise > 0.) {
+      noisy.rotation = Eigen::Rotation2Dd(noisy.rotation.angle() + rotation_noise(*rng));
+    }
+    return noisy;
+  }
+
+  static Pose RandomPose(std::mt19937* rng) {
+    std::uniform_real_distribution<double> translation(-10., 10.);
+    std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+    return {Eigen::Vector2d(translation(*rng), translation(*rng)), Eigen::Rotation2Dd(angle(*rng))};
+  }
+
+  static Eigen::Matrix3d InformationMatrix(const SyntheticGraphOptions& options) {
+    return Eigen::Vector3d(Information(options.translation_noise),
+                           Information(options.translation_noise),
+                           Information(options.rotation_noise))
+        .asDiagonal();
+  }
+};
+
+struct Traits3D {
+  using PoseType = Pose3d;
+  using ConstraintType = Constraint3d;
+  using Graph = SyntheticGraph3D;
+  static constexpr int kDimension = 3;
+
+  static Pose3d Identity() { return {Eigen::Vector3d::Zero(), Eigen::Quaterniond::Identity()}; }
+  static Pose3d Compose(const Pose3d& a, const Pose3d& b) {
+    return {a.translation + a.rotation * b.translation, (a.rotation * b.rotation).normalized()};
+  }
+  static Pose3d Between(const Pose3d& a, const Pose3d& b) {
+    const Eigen::Quaterniond inverse = a.rotation.conjugate();
+    return {inverse * (b.translation - a.translation), (inverse * b.rotation).normalized()};
+  }
+  static Eigen::Vector3d Position(const Pose3d& pose) { return pose.translation; }
+
+  // Manhattan steps either move forward and maybe turn about z, or, with a quarter of the
+  // turn probability, climb or descend one level.
+  static Pose3d Step(const SyntheticGraphOptions& options, std::mt19937* rng) {
+    Pose3d step = {Eigen::Vector3d(options.step_length, 0., 0.), Eigen::Quaterniond::Identity()};
+    if (options.topology == SyntheticGraphOptions::Topology::kManhattan) {
+      std::uniform_real_distribution<double> uniform(0., 1.);
+      const double u = uniform(*rng);
+      if (u < options.turn_probability / 4) {
+        step.translation = Eigen::Vector3d(0., 0., uniform(*rng) < 0.5 ? options.step_length
+                                                                          : -options.step_length);
+      } else if (u < options.turn_probability) {
+        const double yaw = uniform(*rng) < 0.5 ? M_PI / 2 : -M_PI / 2;
+        step.rotation = Eigen::Quaterniond(Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()));
+      }
+    } else {
+      // Mostly yaw, with a little pitch and roll.
+      std::normal_distribution<double> yaw(0., options.turn_stddev);
+      std::normal_distribution<double> tilt(0., options.turn_stddev / 4);
+      step.rotation = common::SO3Exp(Eigen::Vector3d(tilt(*rng), tilt(*rng), yaw(*rng)));
+    }
+    return step;
+  }
+
+  static Pose3d Perturb(const Pose3d& pose, const SyntheticGraphOptions& options,
+                        std::mt19937* rng) {
+    std::normal_distribution<double> translation_noise(0., options.translation_noise);
+    std::normal_distribution<double> rotation_noise(0., options.rotation_noise);
+    Pose3d noisy = pose;
+    if (options.translation_noise > 0.) {
+      noisy.translation += Eigen::Vector3d(translation_noise(*rng), translation_noise(*rng),
+                                           translation_noise(*rng));
+    }
+    if (options.rotation_noise > 0.) {
+      noisy.rotation = (noisy.rotation * common::SO3Exp(Eigen::Vector3d(
+                                             rotation_noise(*rng), rotation_noise(*rng),
+                                             rotation_noise(*rng))))
+                           .normalized();
+    }
+    return noisy;
+  }
+
+  static Pose3d RandomPose(std::mt19937* rng) {
+    std::uniform_real_distribution<double> translation(-10., 10.);
+    return {Eigen::Vector3d(translation(*rng), translation(*rng), translation(*rng)),
+            Eigen::Quaterniond::UnitRandom()};
+  }
+
+  // The quaternion vector part moves by half the rotation angle, so its standard deviation is
+  // half the rotation noise.
+  static Eigen::Matrix<double, 6, 6> InformationMatrix(const SyntheticGraphOptions& options) {
+    Eigen::Matrix<double, 6, 1> diagonal;
+    diagonal.head<3>().setConstant(Information(options.translation_noise));
+    diagonal.tail<3>().setConstant(Information(options.rotation_noise / 2));
+    return diagonal.asDiagonal();
+  }
+};
+
+// Buckets pose indices by position on a grid of `cell_size` cells.
+class SpatialHash {
+ public:
+  explicit SpatialHash(double cell_size) : cell_size_(cell_size) {}
+
+  void Insert(const Eigen::Vector3d& position, int index) {
+    cells_[Key(Cell(position))].push_back(index);
+  }
+
+  // Indices up to `max_index` within `radius` (at most cell_size) of `position`.
+  template <typename GetPosition>
+  void Query(const Eigen::Vector3d& position, double radius, int max_index,
+             GetPosition get_position, std::vector<int>* found) const {
+    found->clear();
+    const Eigen::Vector3i center = Cell(position);
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dz = -1; dz <= 1; ++dz) {
+          const auto it = cells_.find(Key(center + Eigen::Vector3i(dx, dy, dz)));
+          if (it == cells_.end()) continue;
+          for (int index : it->second) {
+            if (index <= max_index && (get_position(index) - position).norm() <= radius) {
+              found->push_back(index);
+            }
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  Eigen::Vector3i Cell(const Eigen::Vector3d& position) const {
+    return (position / cell_size_).array().floor().cast<int>();
+  }
+  static uint64_t Key(const Eigen::Vector3i& cell) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell.x())) * 73856093u) ^
+           (static_cast<uint64_t>(static_cast<uint32_t>(cell.y())) << 21) ^
+           (static_cast<uint64_t>(static_cast<uint32_t>(cell.z())) << 42);
+  }
+
+  const double cell_size_;
+  std::unordered_map<uint64_t, std::vector<int>> cells_;
+};
+
+template <typename Traits>
+typename Traits::Graph Generate(const SyntheticGraphOptions& options) {
+  using PoseType = typename Traits::PoseType;
+  using ConstraintType = typename Traits::ConstraintType;
+  typename Traits::Graph graph;
+  const int num_poses = std::max(options.num_poses, 1);
+  std::mt19937 rng(options.seed);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  const auto information = Traits::InformationMatrix(options);
+
+  graph.ground_truth.reserve(num_poses);
+  graph.data.pose_ids.reserve(num_poses);
+  graph.data.poses.reserve(num_poses);
+  graph.data.constraints.reserve(
+      num_poses * (1. + std::min(1., options.loop_closure_probability)));
+  graph.ground_truth.push_back(Traits::Identity());
+  graph.data.pose_ids.push_back(0);
+  graph.data.poses.push_back(Traits::Identity());
+  graph.data.fixed_pose_ids.push_back(0);
+
+  auto add_constraint = [&](int source, int target, const PoseType& measurement,
+                            bool is_outlier) {
+    ConstraintType constraint;
+    constraint.source = source;
+    constraint.target = target;
+    constraint.relative_pose = measurement;
+    constraint.information = information;
+    graph.data.constraints.push_back(constraint);
+    graph.is_outlier.push_back(is_outlier);
+  };
+
+  const double radius = options.loop_closure_radius;
+  SpatialHash hash(std::max(radius, 1e-6));
+  hash.Insert(Traits::Position(graph.ground_truth[0]), 0);
+  std::vector<int> candidates;
+  for (int i = 1; i < num_poses; ++i) {
+    const PoseType step = Traits::Step(options, &rng);
+    graph.ground_truth.push_back(Traits::Compose(graph.ground_truth[i - 1], step));
+    const PoseType odometry = Traits::Perturb(step, options, &rng);
+    add_constraint(i - 1, i, odometry, false);
+    graph.data.pose_ids.push_back(i);
+    graph.data.poses.push_back(Traits::Compose(graph.data.poses[i - 1], odometry));
+
+    const Eigen::Vector3d position = Traits::Position(graph.ground_truth[i]);
+    if (uniform(rng) < options.loop_closure_probability) {
+      hash.Query(position, radius, i - options.min_loop_closure_gap,
+                 [&](int index) { return Traits::Position(graph.ground_truth[index]); },
+                 &candidates);
+      if (!candidates.empty()) {
+        const int source =
+            candidates[std::uniform_int_distribution<int>(0, candidates.size() - 1)(rng)];
+        if (uniform(rng) < options.outlier_rate) {
+          add_constraint(source, i, Traits::RandomPose(&rng), true);
+        } else {
+          const PoseType truth = Traits::Between(graph.ground_truth[source], graph.ground_truth[i]);
+          add_constraint(source, i, Traits::Perturb(truth, options, &rng), false);
+        }
+      }
+    }
+    hash.Insert(position, i);
+  }
+  return graph;
+}
+
+}  // namespace
+
+SyntheticGraph2D GenerateGraph2D(const SyntheticGraphOptions& options) {
+  return Generate<Traits2D>(options);
+}
+
+SyntheticGraph3D GenerateGraph3D(const SyntheticGraphOptions& options) {
+  return Generate<Traits3D>(options);
+}
+
+}  // namespace spa
+}  // namespace robot
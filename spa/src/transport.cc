@@ -0,0 +1,32 @@
+#include "transport.h"
+
+namespace robot {
+namespace spa {
+
+void InMemoryTransport::Send(int target_robot, SeparatorMessage message) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++num_messages_sent_;
+  num_poses_sent_ += message.poses.size();
+  inboxes_[target_robot].push_back(std::move(message));
+}
+
+std::vector<SeparatorMessage> InMemoryTransport::Receive(int robot) {
+  std::vector<SeparatorMessage> messages;
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = inboxes_.find(robot);
+  if (it != inboxes_.end()) messages.swap(it->second);
+  return messages;
+}
+
+int64_t InMemoryTransport::num_messages_sent() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_messages_sent_;
+}
+
+int64_t InMemoryTransport::num_poses_sent() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_poses_sent_;
+}
+
+}  // namespace spa
+}  // namespace robot
@@ -0,0 +1,126 @@
+#include "submap_pose_graph_2d.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "pose_graph_2d.h"
+#include "synthetic_graph.h"
+
+using robot::spa::Constraint;
+using robot::spa::Pose;
+using robot::spa::SubmapPoseGraph2D;
+using robot::spa::SyntheticGraph2D;
+using robot::spa::SyntheticGraphOptions;
+
+namespace {
+
+SyntheticGraph2D MakeGraph(double noise, int num_poses = 600) {
+  SyntheticGraphOptions options;
+  options.num_poses = num_poses;
+  options.loop_closure_probability = 0.3;
+  options.translation_noise = noise;
+  options.rotation_noise = noise / 2.;
+  return robot::spa::GenerateGraph2D(options);
+}
+
+template <typename Graph>
+double MeanPositionError(const Graph& pose_graph, const SyntheticGraph2D& graph) {
+  double error = 0.;
+  for (size_t i = 0; i < graph.ground_truth.size(); ++i) {
+    error += (pose_graph.pose(graph.data.pose_ids[i]).translation -
+              graph.ground_truth[i].translation)
+                 .norm();
+  }
+  return error / graph.ground_truth.size();
+}
+
+template <typename Graph>
+void AddGraph(const SyntheticGraph2D& graph, Graph* pose_graph) {
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+    ASSERT_TRUE(pose_graph->AddPose(graph.data.pose_ids[i], graph.data.poses[i]));
+  }
+  for (const Constraint& constraint : graph.data.constraints) {
+    ASSERT_TRUE(pose_graph->AddConstraint(constraint));
+  }
+}
+
+}  // namespace
+
+TEST(SubmapPoseGraph2DTest, RecoversNoiseFreeGraphFromPerturbedStart) {
+  SyntheticGraph2D graph = MakeGraph(0.);
+  std::mt19937 rng(5);
+  std::normal_distribution<double> noise(0., 0.05);
+  for (size_t i = 1; i < graph.data.poses.size(); ++i) {
+    graph.data.poses[i].translation += Eigen::Vector2d(noise(rng), noise(rng));
+  }
+  SubmapPoseGraph2D::Options options;
+  options.submap_size = 50;
+  SubmapPoseGraph2D pose_graph(options);
+  AddGraph(graph, &pose_graph);
+  EXPECT_EQ(pose_graph.num_submaps(), 12);
+
+  const SubmapPoseGraph2D::Report report = pose_graph.Solve();
+  EXPECT_EQ(report.num_submaps, 12);
+  EXPECT_EQ(report.num_solved_submaps, 12);
+  EXPECT_TRUE(report.coarse.summary.IsSolutionUsable());
+  EXPECT_LT(MeanPositionError(pose_graph, graph), 1e-4);
+}
+
+TEST(SubmapPoseGraph2DTest, ApproachesFullSolutionOnNoisyGraph) {
+  const SyntheticGraph2D graph = MakeGraph(0.02, 300);
+  robot::spa::PoseGraph2D full;
+  AddGraph(graph, &full);
+  const int full_iterations = full.Solve().summary.iterations.size();
+  SubmapPoseGraph2D::Options options;
+  options.submap_size = 25;
+  SubmapPoseGraph2D submaps(options);
+  AddGraph(graph, &submaps);
+
+  // Mean distance to the full solution.
+  auto distance = [&] {
+    double distance = 0.;
+    for (int id : graph.data.pose_ids) {
+      distance += (submaps.pose(id).translation - full.pose(id).translation).norm();
+    }
+    return distance / graph.data.pose_ids.size();
+  };
+  const double initial_distance = distance();
+  submaps.Solve();
+  EXPECT_LT(distance(), 0.2 * initial_distance);
+
+  // It is also a better start for a full solve than the dead-reckoned odometry.
+  robot::spa::PoseGraph2D refined;
+  for (int id : graph.data.pose_ids) refined.AddPose(id, submaps.pose(id));
+  for (const Constraint& constraint : graph.data.constraints) refined.AddConstraint(constraint);
+  const int refined_iterations = refined.Solve().summary.iterations.size();
+  EXPECT_LT(refined_iterations, full_iterations);
+}
+
+TEST(SubmapPoseGraph2DTest, ResolvesOnlySubmapsWithNewData) {
+  SyntheticGraph2D graph = MakeGraph(0.);
+  SubmapPoseGraph2D::Options options;
+  options.submap_size = 100;
+  SubmapPoseGraph2D pose_graph(options);
+  AddGraph(graph, &pose_graph);
+  EXPECT_EQ(pose_graph.Solve().num_solved_submaps, 6);
+  EXPECT_EQ(pose_graph.Solve().num_solved_submaps, 0);
+
+  // A constraint between submaps only changes the coarse graph.
+  Constraint constraint = graph.data.constraints.front();
+  constraint.source = 0;
+  constraint.target = 150;
+  constraint.relative_pose = {
+      graph.ground_truth[0].rotation.inverse() *
+          (graph.ground_truth[150].translation - graph.ground_truth[0].translation),
+      graph.ground_truth[0].rotation.inverse() * graph.ground_truth[150].rotation};
+  ASSERT_TRUE(pose_graph.AddConstraint(constraint));
+  EXPECT_EQ(pose_graph.Solve().num_solved_submaps, 0);
+  constraint.target = 50;
+  ASSERT_TRUE(pose_graph.AddConstraint(constraint));
+  EXPECT_EQ(pose_graph.Solve().num_solved_submaps, 1);
+
+  constraint.target = 1000;
+  EXPECT_FALSE(pose_graph.AddConstraint(constraint));
+  EXPECT_FALSE(pose_graph.AddPose(0, graph.data.poses[0]));
+}
@@ -0,0 +1,166 @@
+#include "synthetic_graph.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "angle.h"
+#include "pose_graph_2d.h"
+
+using robot::spa::GenerateGraph2D;
+using robot::spa::GenerateGraph3D;
+using robot::spa::Pose;
+using robot::spa::Pose3d;
+using robot::spa::SyntheticGraphOptions;
+
+namespace {
+
+Pose Between(const Pose& a, const Pose& b) {
+  return {a.rotation.inverse() * (b.translation - a.translation),
+          a.rotation.inverse() * b.rotation};
+}
+
+// Mean distance between the estimated and true positions.
+double MeanPositionError(const std::vector<Pose>& estimate, const std::vector<Pose>& truth) {
+  double error = 0.;
+  for (size_t i = 0; i < truth.size(); ++i) {
+    error += (estimate[i].translation - truth[i].translation).norm();
+  }
+  return error / truth.size();
+}
+
+SyntheticGraphOptions NoiseFreeOptions(SyntheticGraphOptions::Topology topology) {
+  SyntheticGraphOptions options;
+  options.topology = topology;
+  options.num_poses = 500;
+  options.turn_stddev = 1.;
+  options.loop_closure_probability = 0.5;
+  options.translation_noise = 0.;
+  options.rotation_noise = 0.;
+  return options;
+}
+
+}  // namespace
+
+TEST(SyntheticGraphTest, NoiseFreeMeasurementsMatchGroundTruth) {
+  for (auto topology : {SyntheticGraphOptions::Topology::kManhattan,
+                        SyntheticGraphOptions::Topology::kRandomWalk}) {
+    const SyntheticGraphOptions options = NoiseFreeOptions(topology);
+    const robot::spa::SyntheticGraph2D graph = GenerateGraph2D(options);
+    ASSERT_EQ(graph.data.poses.size(), 500u);
+    ASSERT_EQ(graph.ground_truth.size(), 500u);
+    ASSERT_EQ(graph.is_outlier.size(), graph.data.constraints.size());
+    EXPECT_EQ(graph.data.fixed_pose_ids, std::vector<int>{0});
+    EXPECT_GT(graph.data.constraints.size(), 499u);
+    for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+      EXPECT_EQ(graph.data.pose_ids[i], static_cast<int>(i));
+      EXPECT_LT((graph.data.poses[i].translation - graph.ground_truth[i].translation).norm(),
+                1e-9);
+    }
+    for (const robot::spa::Constraint& constraint : graph.data.constraints) {
+      EXPECT_LT(constraint.source, constraint.target);
+      const Pose truth =
+          Between(graph.ground_truth[constraint.source], graph.ground_truth[constraint.target]);
+      EXPECT_LT((constraint.relative_pose.translation - truth.translation).norm(), 1e-9);
+      EXPECT_NEAR(robot::common::NormalizeAngle(constraint.relative_pose.rotation.angle() -
+                                                truth.rotation.angle()),
+                  0., 1e-9);
+      if (constraint.target != constraint.source + 1) {
+        EXPECT_LE(truth.translation.norm(), options.loop_closure_radius + 1e-9);
+        EXPECT_GE(constraint.target - constraint.source, options.min_loop_closure_gap);
+      }
+    }
+  }
+}
+
+TEST(SyntheticGraphTest, ManhattanWorldClosesLoops) {
+  SyntheticGraphOptions options;
+  options.num_poses = 2000;
+  options.loop_closure_probability = 1.;
+  const robot::spa::SyntheticGraph2D graph = GenerateGraph2D(options);
+  // A walk on a grid keeps revisiting cells, so most poses find a loop closure candidate.
+  EXPECT_GT(graph.data.constraints.size(), 2000u + 500u);
+}
+
+TEST(SyntheticGraphTest, MarksOutliers) {
+  SyntheticGraphOptions options;
+  options.num_poses = 5000;
+  options.loop_closure_probability = 1.;
+  options.outlier_rate = 0.2;
+  const robot::spa::SyntheticGraph2D graph = GenerateGraph2D(options);
+  const int num_loop_closures = graph.data.constraints.size() - (options.num_poses - 1);
+  const int num_outliers = std::count(graph.is_outlier.begin(), graph.is_outlier.end(), true);
+  ASSERT_GT(num_loop_closures, 0);
+  EXPECT_NEAR(static_cast<double>(num_outliers) / num_loop_closures, 0.2, 0.03);
+  for (size_t i = 0; i < graph.data.constraints.size(); ++i) {
+    const robot::spa::Constraint& constraint = graph.data.constraints[i];
+    if (constraint.target == constraint.source + 1) {
+      EXPECT_FALSE(graph.is_outlier[i]);
+    }
+  }
+}
+
+TEST(SyntheticGraphTest, IsDeterministicForASeed) {
+  SyntheticGraphOptions options;
+  options.num_poses = 200;
+  const robot::spa::SyntheticGraph2D a = GenerateGraph2D(options);
+  const robot::spa::SyntheticGraph2D b = GenerateGraph2D(options);
+  ASSERT_EQ(a.data.constraints.size(), b.data.constraints.size());
+  for (size_t i = 0; i < a.data.poses.size(); ++i) {
+    EXPECT_EQ(a.data.poses[i].translation, b.data.poses[i].translation);
+  }
+  options.seed = 7;
+  const robot::spa::SyntheticGraph2D c = GenerateGraph2D(options);
+  EXPECT_NE(a.data.poses.back().translation, c.data.poses.back().translation);
+}
+
+TEST(SyntheticGraphTest, SolvingReducesErrorToGroundTruth) {
+  SyntheticGraphOptions options;
+  options.num_poses = 100;
+  options.loop_closure_probability = 0.5;
+  options.min_loop_closure_gap = 5;
+  options.translation_noise = 0.05;
+  options.rotation_noise = 0.05;
+  const robot::spa::SyntheticGraph2D graph = GenerateGraph2D(options);
+
+  robot::spa::PoseGraph2D pose_graph;
+  for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+    pose_graph.AddPose(graph.data.pose_ids[i], graph.data.poses[i]);
+  }
+  for (const robot::spa::Constraint& constraint : graph.data.constraints) {
+    ASSERT_TRUE(pose_graph.AddConstraint(constraint));
+  }
+  pose_graph.Solve();
+  std::vector<Pose> solved;
+  for (int id : pose_graph.pose_ids()) solved.push_back(pose_graph.pose(id));
+
+  EXPECT_LT(MeanPositionError(solved, graph.ground_truth),
+            0.5 * MeanPositionError(graph.data.poses, graph.ground_truth));
+}
+
+TEST(SyntheticGraphTest, NoiseFree3DMeasurementsMatchGroundTruth) {
+  for (auto topology : {SyntheticGraphOptions::Topology::kManhattan,
+                        SyntheticGraphOptions::Topology::kRandomWalk}) {
+    const SyntheticGraphOptions options = NoiseFreeOptions(topology);
+    const robot::spa::SyntheticGraph3D graph = GenerateGraph3D(options);
+    ASSERT_EQ(graph.data.poses.size(), 500u);
+    ASSERT_EQ(graph.is_outlier.size(), graph.data.constraints.size());
+    for (size_t i = 0; i < graph.data.poses.size(); ++i) {
+      EXPECT_LT((graph.data.poses[i].translation - graph.ground_truth[i].translation).norm(),
+                1e-9);
+      EXPECT_NEAR(graph.data.poses[i].rotation.angularDistance(graph.ground_truth[i].rotation),
+                  0., 1e-9);
+    }
+    for (const robot::spa::Constraint3d& constraint : graph.data.constraints) {
+      const Pose3d& source = graph.ground_truth[constraint.source];
+      const Pose3d& target = graph.ground_truth[constraint.target];
+      const Eigen::Vector3d translation =
+          source.rotation.conjugate() * (target.translation - source.translation);
+      EXPECT_LT((constraint.relative_pose.translation - translation).norm(), 1e-9);
+      EXPECT_NEAR(constraint.relative_pose.rotation.angularDistance(source.rotation.conjugate() *
+                                                                    target.rotation),
+                  0., 1e-9);
+    }
+  }
+}